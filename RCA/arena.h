@@ -0,0 +1,243 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Arena (bump) allocator.  The map geometry of a level (walls, sectors
+ * and BSP nodes) is allocated from the level arena, so unloading a level
+ * is a single reset instead of one free per object.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#ifndef RCA_ARENA_H_
+#define RCA_ARENA_H_
+
+#define RCA_ARENA_TYPE (1<<4)			/* dynamic type checking */
+#define RCA_ARENA_ALLOCATED (1u<<31)	/* object lives in an arena, never free it */
+#define RCA_ARENA_ALIGNMENT 16
+#define RCA_ARENA_HEADER ((sizeof(ArenaBlock) + RCA_ARENA_ALIGNMENT - 1) & ~(size_t)(RCA_ARENA_ALIGNMENT - 1))
+
+typedef struct block {
+  struct block *next;
+  size_t size;
+  size_t used;
+} ArenaBlock;
+
+/**
+ * Arena class.
+ */
+typedef struct {
+  unsigned int type;
+  size_t block_size;
+  ArenaBlock *first;
+  ArenaBlock *current;
+} Arena;
+
+__thread Arena *RCA_ARENA__LEVEL = NULL;	/* one per thread loading a level */
+
+/**
+ * Allocate a new block for the arena.
+ * 
+ * @param size Usable size of the block.
+ * @return     A block (data follows the header).
+ */
+ArenaBlock *RCA_NewArenaBlock(size_t size)
+{
+  ArenaBlock *block = malloc(RCA_ARENA_HEADER + size);
+
+  block->next = NULL;
+  block->size = size;
+  block->used = 0;
+
+  return block;
+}
+
+/**
+ * Constructor.
+ * 
+ * @param arena      Pointer to an Arena object.
+ * @param block_size Size of each block of the arena.
+ */
+void RCA_ConstructArena(Arena *arena, size_t block_size)
+{
+  /* here OR the RCA_ARENA_TYPE constant into the type */
+  arena->type |= RCA_ARENA_TYPE;
+
+  arena->block_size = block_size;
+  arena->first = RCA_NewArenaBlock(block_size);
+  arena->current = arena->first;
+}
+
+/**
+ * New.
+ * 
+ * @param block_size Size of each block of the arena.
+ * @return           An object Arena.
+ */
+Arena *RCA_NewArena(size_t block_size)
+{
+  Arena *arena = malloc(sizeof(Arena));
+  arena->type = RCA_ARENA_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructArena(arena, block_size);
+
+  return arena;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param arena Pointer to an Arena object.
+ */
+void RCA_CheckArena(Arena *arena)
+{
+  /* check if we have a valid Arena object */
+  if (arena == NULL ||
+	  !(arena->type & RCA_ARENA_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * Every object allocated from the arena goes away with it.
+ * 
+ * @param arena Pointer to an Arena object.
+ */
+void RCA_DestroyArena(Arena *arena)
+{
+  /* check if we have a valid Arena object */
+  RCA_CheckArena(arena);
+
+  /* set type to 0 indicate this is no longer an Arena object */
+  arena->type = 0;
+
+  if (RCA_ARENA__LEVEL == arena)
+  {
+	RCA_ARENA__LEVEL = NULL;
+  }
+
+  /* free the memory allocated for the object */
+  ArenaBlock *cur = arena->first;
+  ArenaBlock *bkup = NULL;
+  for (; cur != NULL; cur = bkup)
+  {
+	bkup = cur->next;
+	free(cur);
+  }
+  free(arena);
+}
+
+/**
+ * Reset arena.
+ * 
+ * Release every object at once, the blocks are kept for the next
+ * level.
+ * 
+ * @param arena Pointer to an Arena object.
+ */
+void RCA_ResetArena(Arena *arena)
+{
+  /* check if we have a valid Arena object */
+  RCA_CheckArena(arena);
+
+  /* the following blocks are rewound when we get to them */
+  arena->current = arena->first;
+  arena->current->used = 0;
+}
+
+/**
+ * Allocate from arena.
+ * 
+ * @param arena Pointer to an Arena object.
+ * @param size  Size of the memory to allocate.
+ * @return      Pointer to the memory (aligned).
+ */
+void *RCA_AllocateFromArena(Arena *arena, size_t size)
+{
+  /* check if we have a valid Arena object */
+  RCA_CheckArena(arena);
+
+  size = (size + RCA_ARENA_ALIGNMENT - 1) & ~(size_t)(RCA_ARENA_ALIGNMENT - 1);
+
+  while (arena->current->used + size > arena->current->size)
+  {
+	if (arena->current->next == NULL)
+	{
+	  /* oversized objects get a block of their own */
+	  arena->current->next = RCA_NewArenaBlock((size > arena->block_size) ? size : arena->block_size);
+	}
+	arena->current = arena->current->next;
+	arena->current->used = 0;
+  }
+
+  void *memory = (unsigned char *)arena->current + RCA_ARENA_HEADER + arena->current->used;
+  arena->current->used += size;
+
+  return memory;
+}
+
+/**
+ * Set level arena.
+ * 
+ * Map geometry created afterward by the calling thread is allocated
+ * from that arena, NULL goes back to malloc.  Every thread has its own,
+ * so levels can be loaded by several threads at once (an arena itself
+ * is used by one thread at a time).
+ * 
+ * @param arena Pointer to an Arena object (or NULL).
+ */
+void RCA_SetLevelArena(Arena *arena)
+{
+  RCA_ARENA__LEVEL = arena;
+}
+
+/**
+ * Allocate map geometry.
+ * 
+ * @param size Size of the object.
+ * @return     Pointer to the memory.
+ */
+void *RCA_AllocateLevel(size_t size)
+{
+  if (RCA_ARENA__LEVEL != NULL)
+	return RCA_AllocateFromArena(RCA_ARENA__LEVEL, size);
+
+  return malloc(size);
+}
+
+/**
+ * Type bits of newly allocated map geometry.
+ * 
+ * @return RCA_ARENA_ALLOCATED if the object comes from the level arena.
+ */
+unsigned int RCA_LevelAllocationType(void)
+{
+  return (RCA_ARENA__LEVEL != NULL) ? RCA_ARENA_ALLOCATED : 0;
+}
+
+/**
+ * Free map geometry.
+ * 
+ * Objects from an arena are left alone, they go away with the arena.
+ * 
+ * @param object Pointer to the object.
+ * @param type   Type of the object (before it was cleared).
+ */
+void RCA_FreeLevel(void *object, unsigned int type)
+{
+  if (!(type & RCA_ARENA_ALLOCATED))
+  {
+	free(object);
+  }
+}
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Binary angles.  A full turn is 2^32 units, so an angle is a 32-bit
+ * unsigned integer and wraps around by itself (no check against 0 and
+ * 360 anywhere).  Sine, cosine and tangent come from tables indexed by
+ * the top RCA_BAM_FINE_BITS bits of the angle, computed once.
+ */
+
+#include <math.h>
+
+#ifndef RCA_BAM_H_
+#define RCA_BAM_H_
+
+#define RCA_BAM_FINE_BITS 13
+#define RCA_BAM_FINE_ANGLES (1<<RCA_BAM_FINE_BITS)	/* entries in the tables (8192) */
+#define RCA_BAM_FINE_SHIFT (32 - RCA_BAM_FINE_BITS)
+#define RCA_BAM_DEGREE (4294967296.0 / 360)			/* units in a degree */
+#define RCA_BAM_ANGLE_90 0x40000000u
+#define RCA_BAM_ANGLE_180 0x80000000u
+#define RCA_BAM_ANGLE_270 0xc0000000u
+
+typedef unsigned int Angle;
+
+/* the cosine is the sine a quarter turn later, hence the extra quarter */
+double RCA_BAM__SINE[RCA_BAM_FINE_ANGLES + RCA_BAM_FINE_ANGLES / 4];
+double RCA_BAM__TANGENT[RCA_BAM_FINE_ANGLES];
+
+/**
+ * Initialize tables.
+ * 
+ * Must be called once before any angle is used.
+ */
+void RCA_InitBAM(void)
+{
+  int i;
+  double radian;
+
+  for (i = 0; i < RCA_BAM_FINE_ANGLES + RCA_BAM_FINE_ANGLES / 4; i++)
+  {
+	radian = 2 * M_PI * i / RCA_BAM_FINE_ANGLES;
+	RCA_BAM__SINE[i] = sin(radian);
+	if (i < RCA_BAM_FINE_ANGLES)
+	  RCA_BAM__TANGENT[i] = tan(radian);
+  }
+
+  /* exact where it matters (axis-aligned rays) */
+  RCA_BAM__SINE[0] = RCA_BAM__SINE[RCA_BAM_FINE_ANGLES / 2] = RCA_BAM__SINE[RCA_BAM_FINE_ANGLES] = 0;
+  RCA_BAM__SINE[RCA_BAM_FINE_ANGLES / 4] = 1;
+  RCA_BAM__SINE[RCA_BAM_FINE_ANGLES * 3 / 4] = -1;
+  RCA_BAM__TANGENT[0] = RCA_BAM__TANGENT[RCA_BAM_FINE_ANGLES / 2] = 0;
+  RCA_BAM__TANGENT[RCA_BAM_FINE_ANGLES / 4] = RCA_BAM__TANGENT[RCA_BAM_FINE_ANGLES * 3 / 4] = HUGE_VAL;
+}
+
+/**
+ * Convert degrees to a binary angle.
+ * 
+ * @param degrees Angle in degree (any value).
+ * @return        Binary angle.
+ */
+Angle RCA_DegreesToBAM(double degrees)
+{
+  return (Angle)(long long)floor(fmod(degrees, 360) * RCA_BAM_DEGREE + 0.5);
+}
+
+/**
+ * Convert a binary angle to degrees.
+ * 
+ * @param angle Binary angle.
+ * @return      Angle in degree (0 to 360).
+ */
+double RCA_BAMToDegrees(Angle angle)
+{
+  return angle / RCA_BAM_DEGREE;
+}
+
+/**
+ * Sine.
+ * 
+ * @param angle Binary angle.
+ * @return      Sine of the angle.
+ */
+double RCA_FineSine(Angle angle)
+{
+  return RCA_BAM__SINE[angle >> RCA_BAM_FINE_SHIFT];
+}
+
+/**
+ * Cosine.
+ * 
+ * @param angle Binary angle.
+ * @return      Cosine of the angle.
+ */
+double RCA_FineCosine(Angle angle)
+{
+  return RCA_BAM__SINE[(angle >> RCA_BAM_FINE_SHIFT) + RCA_BAM_FINE_ANGLES / 4];
+}
+
+/**
+ * Tangent.
+ * 
+ * @param angle Binary angle.
+ * @return      Tangent of the angle (HUGE_VAL straight up or down).
+ */
+double RCA_FineTangent(Angle angle)
+{
+  return RCA_BAM__TANGENT[angle >> RCA_BAM_FINE_SHIFT];
+}
+
+#endif
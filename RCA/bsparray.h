@@ -0,0 +1,439 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Compiled BSP tree.  The nodes of a BSPtree are copied, depth first
+ * (the front child right after its parent), into one array where the
+ * children are 32-bit indexes.  Every separating line is kept as a
+ * normalized equation nx * x + ny * y = d, so the side of a point is a
+ * single dot product instead of a slope and an intercept divided out at
+ * every visit.  The tree is walked with an explicit stack, no recursion.
+ * 
+ * The BSPtree stays the way a level is built, it is compiled once
+ * loaded.
+ */
+
+#include <assert.h>
+#include <math.h>
+
+#include "arena.h"
+#include "bsptree.h"
+#include "element.h"
+#include "raycaster.h"
+#include "sector.h"
+
+#ifndef RCA_BSPARRAY_H_
+#define RCA_BSPARRAY_H_
+
+#define RCA_BSPARRAY_TYPE (1<<10)		/* dynamic type checking */
+#define RCA_BSPARRAY_NONE 0				/* no child (the root is nobody's child) */
+
+/**
+ * Node of a compiled tree.
+ */
+typedef struct {
+  double nx;					/* normal of the separating line (unit length) */
+  double ny;
+  double d;						/* nx * x + ny * y of any point of the line */
+  unsigned int front;			/* index of the child or RCA_BSPARRAY_NONE */
+  unsigned int back;
+  Sector *sector;				/* leaf if not NULL */
+} BSPnode;
+
+/**
+ * BSParray class.
+ */
+typedef struct {
+  unsigned int type;
+  BSPnode *nodes;				/* root first */
+  unsigned int count;
+  int depth;					/* deepest leaf (the root is 1) */
+} BSParray;
+
+/**
+ * Count nodes of a tree.
+ * 
+ * @param bsptree Pointer to a BSPtree object.
+ * @param depth   Depth of the deepest node (output).
+ * @param level   Depth of bsptree.
+ * @return        Number of nodes.
+ */
+unsigned int RCA_CountBSPtreeNodes(BSPtree *bsptree, int *depth, int level)
+{
+  if (bsptree == NULL)
+	return 0;
+
+  /* check if we have a valid BSPtree object */
+  RCA_CheckBSPtree(bsptree);
+
+  if (level > *depth)
+	*depth = level;
+
+  return 1 + RCA_CountBSPtreeNodes(bsptree->front, depth, level + 1) +
+	RCA_CountBSPtreeNodes(bsptree->back, depth, level + 1);
+}
+
+/**
+ * Compile a node and its children.
+ * 
+ * The sign of the equation is the one of RCA_FindLocationInBSPtree:
+ * positive in front, negative behind.
+ * 
+ * @param bsparray Pointer to a BSParray object.
+ * @param bsptree  Pointer to a BSPtree object.
+ * @return         Index of the node.
+ */
+unsigned int RCA_CompileBSPtreeNode(BSParray *bsparray, BSPtree *bsptree)
+{
+  if (bsptree == NULL)
+	return RCA_BSPARRAY_NONE;
+
+  unsigned int index = bsparray->count++;
+  BSPnode *node = &bsparray->nodes[index];
+  double dx = bsptree->x2 - bsptree->x1;
+  double dy = bsptree->y2 - bsptree->y1;
+  double length;
+
+  if (dx == 0)
+  {
+	/* vertical, in front is to the right (a leaf ends up here too) */
+	node->nx = 1;
+	node->ny = 0;
+  }
+  else
+  {
+	/* in front is above the line, whichever way it goes */
+	length = sqrt(dx * dx + dy * dy) * ((dx > 0) ? 1 : -1);
+	node->nx = -dy / length;
+	node->ny = dx / length;
+  }
+  node->d = node->nx * bsptree->x1 + node->ny * bsptree->y1;
+  node->sector = bsptree->sector;
+
+  /* the front child is laid out right after its parent */
+  node->front = RCA_CompileBSPtreeNode(bsparray, bsptree->front);
+  node->back = RCA_CompileBSPtreeNode(bsparray, bsptree->back);
+
+  return index;
+}
+
+/**
+ * Compile a tree.
+ * 
+ * Like the tree, the array is map geometry: it comes from the level
+ * arena when there is one.
+ * 
+ * @param bsptree Pointer to a BSPtree object.
+ * @return        An object BSParray.
+ */
+BSParray *RCA_CompileBSPtree(BSPtree *bsptree)
+{
+  int depth = 0;
+  unsigned int count = RCA_CountBSPtreeNodes(bsptree, &depth, 1);
+  BSParray *bsparray = RCA_AllocateLevel(sizeof(BSParray));
+  bsparray->type = RCA_BSPARRAY_TYPE | RCA_LevelAllocationType();
+
+  bsparray->nodes = RCA_AllocateLevel((count > 0 ? count : 1) * sizeof(BSPnode));
+  bsparray->count = 0;
+  bsparray->depth = depth;
+  RCA_CompileBSPtreeNode(bsparray, bsptree);
+
+  return bsparray;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param bsparray Pointer to a BSParray object.
+ */
+void RCA_CheckBSParray(BSParray *bsparray)
+{
+  /* check if we have a valid BSParray object */
+  if (bsparray == NULL ||
+	  !(bsparray->type & RCA_BSPARRAY_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param bsparray Pointer to a BSParray object.
+ */
+void RCA_DestroyBSParray(BSParray *bsparray)
+{
+  /* check if we have a valid BSParray object */
+  RCA_CheckBSParray(bsparray);
+
+  /* set type to 0 indicate this is no longer a BSParray object */
+  unsigned int type = bsparray->type;
+  bsparray->type = 0;
+
+  /* free the memory allocated for the object (nothing to do if from the level arena) */
+  RCA_FreeLevel(bsparray->nodes, type);
+  RCA_FreeLevel(bsparray, type);
+}
+
+/**
+ * Find value of the separating line at a point.
+ * 
+ * @param node Pointer to a BSPnode.
+ * @param x    Point.
+ * @param y    Point.
+ * @return     Distance to the line, positive in front and negative behind.
+ */
+double RCA_FindLineValueInBSPnode(BSPnode *node, double x, double y)
+{
+  return node->nx * x + node->ny * y - node->d;
+}
+
+/**
+ * Find location.
+ * 
+ * @param node    Pointer to a BSPnode.
+ * @param element Pointer to an Element object.
+ * @return        If we are on (0), back (-1) or in front (1) of the separating line.
+ */
+int RCA_FindLocationInBSPnode(BSPnode *node, Element *element)
+{
+  double value = RCA_FindLineValueInBSPnode(node, element->x, element->y);
+
+  return (value > 0) - (value < 0);
+}
+
+/**
+ * Find the sector of a point.
+ * 
+ * @param bsparray Pointer to a BSParray object.
+ * @param x        Point.
+ * @param y        Point.
+ * @return         Leaf the point is in, or NULL if it is in no leaf.
+ */
+Sector *RCA_FindSectorInBSParray(BSParray *bsparray, double x, double y)
+{
+  unsigned int index = 0;
+  BSPnode *node;
+
+  /* check if we have a valid BSParray object */
+  RCA_CheckBSParray(bsparray);
+
+  while (1)
+  {
+	node = &bsparray->nodes[index];
+	if (node->sector != NULL)
+	  return node->sector;
+
+	index = (RCA_FindLineValueInBSPnode(node, x, y) > 0) ? node->front : node->back;
+	if (index == RCA_BSPARRAY_NONE)
+	  return NULL;
+  }
+}
+
+/**
+ * Traverse compiled tree.
+ * 
+ * Same order as RCA_TraverseBSPtree (back to front), the children still
+ * to be walked are on the stack.
+ * 
+ * @param screen   A copy of the current SDL surface.
+ * @param bsparray Pointer to a BSParray object.
+ * @param element  Pointer to an Element object.
+ */
+void RCA_TraverseBSParray(SDL_Surface *screen, BSParray *bsparray, Element *element)
+{
+  /* check if we have a valid BSParray object */
+  RCA_CheckBSParray(bsparray);
+
+  if (bsparray->count == 0)
+	return;
+
+  unsigned int stack[bsparray->depth + 1];
+  int top = 0, stage = RCA_EnterPerfStage(RCA_PERFCOUNTER_TRAVERSAL);
+  BSPnode *node;
+
+  stack[top++] = 0;
+  while (top > 0)
+  {
+	node = &bsparray->nodes[stack[--top]];
+
+	if (node->sector != NULL)
+	{
+	  RCA_WallCasting(screen, element, node->sector);
+	  continue;
+	}
+
+	/* the child walked first is pushed last */
+	if (RCA_FindLocationInBSPnode(node, element) > 0)
+	{
+	  if (node->front != RCA_BSPARRAY_NONE) stack[top++] = node->front;
+	  if (node->back != RCA_BSPARRAY_NONE) stack[top++] = node->back;
+	}
+	else
+	{
+	  if (node->back != RCA_BSPARRAY_NONE) stack[top++] = node->back;
+	  if (node->front != RCA_BSPARRAY_NONE) stack[top++] = node->front;
+	}
+  }
+  RCA_EnterPerfStage(stage);
+}
+
+/**
+ * Part of a ray in a node, still to be traced.
+ */
+typedef struct {
+  unsigned int index;
+  double t_min;					/* distance where the ray enters the node */
+  double t_max;					/* distance where the ray leaves the node */
+} BSPspan;
+
+/**
+ * Push a span on the stack.
+ * 
+ * @param stack Stack of spans.
+ * @param top   Number of spans on the stack (updated).
+ * @param index Index of the node (nothing is pushed if RCA_BSPARRAY_NONE).
+ * @param t_min Distance where the ray enters the node.
+ * @param t_max Distance where the ray leaves the node.
+ */
+void RCA_PushBSPspan(BSPspan *stack, int *top, unsigned int index, double t_min, double t_max)
+{
+  if (index == RCA_BSPARRAY_NONE)
+	return;
+
+  stack[*top].index = index;
+  stack[*top].t_min = t_min;
+  stack[*top].t_max = t_max;
+  (*top)++;
+}
+
+/**
+ * Trace a ray in the compiled tree.
+ * 
+ * Same walk as RCA_TraceRayInBSPtree, nearest leaf first, with the
+ * spans still to be traced on a stack (the nearest on top).
+ * 
+ * @param bsparray      Pointer to a BSParray object.
+ * @param element       Pointer to an Element object.
+ * @param hits          Hits of the column (every wall hit is added).
+ * @param angle_of_ray  Angle of the ray casted.
+ * @param rays_gradient Slope (gradient) of the ray casted.
+ * @param correction    Fish-eye correction of the column.
+ * @return              True (1) once an opaque wall stops the ray, false (0) otherwise.
+ */
+int RCA_TraceRayInBSParray(BSParray *bsparray, Element *element, HitList *hits, Angle angle_of_ray, double rays_gradient,
+						   double correction)
+{
+  if (bsparray->count == 0)
+	return 0;
+
+  BSPspan stack[bsparray->depth + 1];
+  BSPspan span;
+  int top = 0;
+  double cosine = RCA_FineCosine(angle_of_ray);
+  double sine = RCA_FineSine(angle_of_ray);
+  double origin, step, t_split;
+  unsigned int near, far;
+  BSPnode *node;
+
+  /* the root is index 0, like RCA_BSPARRAY_NONE */
+  stack[top].index = 0; stack[top].t_min = 0; stack[top].t_max = HUGE_VAL; top++;
+  while (top > 0)
+  {
+	span = stack[--top];
+	node = &bsparray->nodes[span.index];
+
+	/* leaf, farther leaves are hidden behind an opaque wall */
+	if (node->sector != NULL)
+	{
+	  int stage = RCA_EnterPerfStage(RCA_PERFCOUNTER_INTERSECTION);
+	  RCA_CastRayOnSector(hits, element, node->sector, angle_of_ray, rays_gradient, correction);
+	  RCA_EnterPerfStage(stage);
+	  if (RCA_FindNearestOpaqueHit(hits) <= span.t_max)
+		return 1;
+	  continue;
+	}
+
+	origin = RCA_FindLineValueInBSPnode(node, element->x, element->y);
+	step = node->nx * cosine + node->ny * sine;
+
+	/* ray along the separating line, both sides are walked (front first) */
+	if (origin == 0 && step == 0)
+	{
+	  RCA_PushBSPspan(stack, &top, node->back, span.t_min, span.t_max);
+	  RCA_PushBSPspan(stack, &top, node->front, span.t_min, span.t_max);
+	  continue;
+	}
+
+	if (origin > 0 || (origin == 0 && step > 0))
+	{
+	  near = node->front;
+	  far = node->back;
+	}
+	else
+	{
+	  near = node->back;
+	  far = node->front;
+	}
+
+	t_split = (step != 0) ? -origin / step : HUGE_VAL;
+
+	/* parallel to or going away from the separating line */
+	if (t_split <= 0 || t_split >= span.t_max)
+	  RCA_PushBSPspan(stack, &top, near, span.t_min, span.t_max);
+	/* already across */
+	else if (t_split <= span.t_min)
+	  RCA_PushBSPspan(stack, &top, far, span.t_min, span.t_max);
+	else
+	{
+	  RCA_PushBSPspan(stack, &top, far, t_split, span.t_max);
+	  RCA_PushBSPspan(stack, &top, near, span.t_min, t_split);
+	}
+  }
+
+  return 0;
+}
+
+/**
+ * Trace compiled tree.
+ * 
+ * Same as RCA_TraceBSPtree.
+ * 
+ * @param screen   A copy of the current SDL surface.
+ * @param bsparray Pointer to a BSParray object.
+ * @param element  Pointer to an Element object.
+ */
+void RCA_TraceBSParray(SDL_Surface *screen, BSParray *bsparray, Element *element)
+{
+  int i;
+  Angle ray_angle = element->direction + RCA_RAYCASTER_HALF_FOV;
+  int slice_position = (RCA_RAYCASTER_COLUMNS - 1) * RCA_RAYCASTER_SLICE_WIDTH;
+  HitList hits;
+
+  /* check if we have a valid BSParray object */
+  RCA_CheckBSParray(bsparray);
+
+  /* the walls of every leaf walked are intersection */
+  int stage = RCA_EnterPerfStage(RCA_PERFCOUNTER_TRAVERSAL);
+
+  for (i = 0; i < RCA_RAYCASTER_COLUMNS; i++)
+  {
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_TRAVERSAL);
+	RCA_ClearHitList(&hits);
+	RCA_TraceRayInBSParray(bsparray, element, &hits, ray_angle, RCA_FindRaysGradient(ray_angle),
+						   fabs(RCA_FineCosine(ray_angle - element->direction)));
+
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_RASTERIZATION);
+	RCA_RAYCASTER__DEPTH_BUFFER[i] = RCA_ResolveHitList(screen, &hits, slice_position);
+
+	ray_angle -= RCA_RAYCASTER_COLUMN_ANGLE;
+	slice_position -= RCA_RAYCASTER_SLICE_WIDTH;
+  }
+  RCA_EnterPerfStage(stage);
+}
+
+#endif
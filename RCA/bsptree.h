@@ -6,6 +6,7 @@
  
 #include <assert.h>
 
+#include "arena.h"
 #include "element.h"
 #include "raycaster.h"
 #include "sector.h"
@@ -61,8 +62,8 @@ void RCA_ConstructBSPtree(BSPtree *bsptree, double x1, double y1, double x2, dou
  */
 BSPtree *RCA_NewBSPtree(double x1, double y1, double x2, double y2) 
 {	
-  BSPtree *bsptree = malloc(sizeof(BSPtree));
-  bsptree->type = RCA_BSPTREE_TYPE;
+  BSPtree *bsptree = RCA_AllocateLevel(sizeof(BSPtree));
+  bsptree->type = RCA_BSPTREE_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   RCA_ConstructBSPtree(bsptree, x1, y1, x2, y2);
@@ -99,15 +100,16 @@ void RCA_DestroyBSPtree(BSPtree *bsptree)
   RCA_CheckBSPtree(bsptree);
 
   /* set type to 0 indicate this is no longer a BSPtree object */
+  unsigned int type = bsptree->type;
   bsptree->type = 0;
 
-  /* free the memory allocated for the object */
+  /* free the memory allocated for the object (nodes from the level arena go away with it) */
   if (bsptree->front != NULL)
 	RCA_DestroyBSPtree(bsptree->front);
   if (bsptree->back != NULL)
 	RCA_DestroyBSPtree(bsptree->back);
 
-  free(bsptree);
+  RCA_FreeLevel(bsptree, type);
 }
 
 /**
@@ -120,8 +122,8 @@ void RCA_AddNodeToBSPtreeFront(BSPtree *current_node, double x1, double y1, doub
   /* check if we have a valid BSPtree object */
   RCA_CheckBSPtree(current_node);
 	
-  BSPtree *new_node = malloc(sizeof(BSPtree));
-  new_node->type = RCA_BSPTREE_TYPE;
+  BSPtree *new_node = RCA_AllocateLevel(sizeof(BSPtree));
+  new_node->type = RCA_BSPTREE_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   RCA_ConstructBSPtree(new_node, x1, y1, x2, y2);
@@ -140,8 +142,8 @@ void RCA_AddNodeToBSPtreeBack(BSPtree *current_node, double x1, double y1, doubl
   /* check if we have a valid BSPtree object */
   RCA_CheckBSPtree(current_node);
 	
-  BSPtree *new_node = malloc(sizeof(BSPtree));
-  new_node->type = RCA_BSPTREE_TYPE;
+  BSPtree *new_node = RCA_AllocateLevel(sizeof(BSPtree));
+  new_node->type = RCA_BSPTREE_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   RCA_ConstructBSPtree(new_node, x1, y1, x2, y2);
@@ -161,8 +163,8 @@ void RCA_AddLeafToBSPtreeFront(BSPtree *current_node, Sector *sector)
   /* check if we have a valid BSPtree object */
   RCA_CheckBSPtree(current_node);
 	
-  BSPtree *new_leaf = malloc(sizeof(BSPtree));
-  new_leaf->type = RCA_BSPTREE_TYPE;
+  BSPtree *new_leaf = RCA_AllocateLevel(sizeof(BSPtree));
+  new_leaf->type = RCA_BSPTREE_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   RCA_ConstructBSPtree(new_leaf, 0, 0, 0, 0);
@@ -185,8 +187,8 @@ void RCA_AddLeafToBSPtreeBack(BSPtree *current_node, Sector *sector)
   /* check if we have a valid BSPtree object */
   RCA_CheckBSPtree(current_node);
 	
-  BSPtree *new_leaf = malloc(sizeof(BSPtree));
-  new_leaf->type = RCA_BSPTREE_TYPE;
+  BSPtree *new_leaf = RCA_AllocateLevel(sizeof(BSPtree));
+  new_leaf->type = RCA_BSPTREE_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   RCA_ConstructBSPtree(new_leaf, 0, 0, 0, 0);
@@ -282,4 +284,162 @@ void RCA_TraverseBSPtree(SDL_Surface *screen, BSPtree *bsptree, Element *element
   }
 }
 
+/**
+ * Find value of the separating line at a point.
+ * 
+ * Same sign as RCA_FindLocationInBSPtree, and linear along a ray.
+ * 
+ * @param node Pointer to a BSPtree object.
+ * @param x    Point.
+ * @param y    Point.
+ * @return     Positive in front, negative behind and 0 on the separating line.
+ */
+double RCA_FindLineValueInBSPtree(BSPtree *node, double x, double y)
+{
+  double m, b;
+
+  if ((node->x1 - node->x2) == 0)
+	return x - node->x1;
+  else if ((node->y1 - node->y2) == 0)
+	return y - node->y1;
+
+  m = (node->y2 - node->y1) / (node->x2 - node->x1);
+  b = node->y1 - (node->x1 * m);
+
+  return y - ((x * m) + b);
+}
+
+/**
+ * Trace a ray in the tree.
+ * 
+ * The child on the element's side is walked first, the other one only
+ * if the ray crosses the separating line within [t_min, t_max] (the
+ * distances along the ray still to be covered).  Only the leaves the ray
+ * goes through have their walls tested.
+ * 
+ * @param bsptree       Pointer to a BSPtree object.
+ * @param element       Pointer to an Element object.
+ * @param hits          Hits of the column (every wall hit is added).
+ * @param angle_of_ray  Angle of the ray casted.
+ * @param rays_gradient Slope (gradient) of the ray casted.
+ * @param correction    Fish-eye correction of the column.
+ * @param t_min         Distance where the ray enters the node.
+ * @param t_max         Distance where the ray leaves the node.
+ * @return              True (1) once an opaque wall stops the ray, false (0) otherwise.
+ */
+int RCA_TraceRayInBSPtree(BSPtree *bsptree, Element *element, HitList *hits, Angle angle_of_ray, double rays_gradient,
+						  double correction, double t_min, double t_max)
+{
+  if (bsptree == NULL)
+	return 0;
+
+  /* check if we have a valid BSPtree object */
+  RCA_CheckBSPtree(bsptree);
+
+  /* leaf, farther leaves are hidden behind an opaque wall */
+  if (bsptree->sector != NULL)
+  {
+	RCA_CastRayOnSector(hits, element, bsptree->sector, angle_of_ray, rays_gradient, correction);
+	return RCA_FindNearestOpaqueHit(hits) <= t_max;
+  }
+
+  int location = RCA_FindLocationInBSPtree(bsptree, element);
+  double origin = RCA_FindLineValueInBSPtree(bsptree, element->x, element->y);
+  double step = RCA_FindLineValueInBSPtree(bsptree, element->x + RCA_FineCosine(angle_of_ray),
+										   element->y + RCA_FineSine(angle_of_ray)) - origin;
+  double t_split;
+  BSPtree *near, *far;
+
+  /* ray along the separating line, both sides are walked */
+  if (location == 0 && step == 0)
+  {
+	if (RCA_TraceRayInBSPtree(bsptree->front, element, hits, angle_of_ray, rays_gradient, correction, t_min, t_max))
+	  return 1;
+	return RCA_TraceRayInBSPtree(bsptree->back, element, hits, angle_of_ray, rays_gradient, correction, t_min, t_max);
+  }
+
+  if (location > 0 || (location == 0 && step > 0))
+  {
+	near = bsptree->front;
+	far = bsptree->back;
+  }
+  else
+  {
+	near = bsptree->back;
+	far = bsptree->front;
+  }
+
+  /* parallel to or going away from the separating line */
+  t_split = (step != 0) ? -origin / step : HUGE_VAL;
+  if (t_split <= 0 || t_split >= t_max)
+	return RCA_TraceRayInBSPtree(near, element, hits, angle_of_ray, rays_gradient, correction, t_min, t_max);
+
+  /* already across */
+  if (t_split <= t_min)
+	return RCA_TraceRayInBSPtree(far, element, hits, angle_of_ray, rays_gradient, correction, t_min, t_max);
+
+  if (RCA_TraceRayInBSPtree(near, element, hits, angle_of_ray, rays_gradient, correction, t_min, t_split))
+	return 1;
+  return RCA_TraceRayInBSPtree(far, element, hits, angle_of_ray, rays_gradient, correction, t_split, t_max);
+}
+
+/**
+ * Trace tree.
+ * 
+ * Every column walks the tree along its ray, from the nearest leaf to
+ * the farthest, and stops at the first opaque wall (a cost logarithmic
+ * in the number of leaves instead of linear as with the traversal).
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param bsptree Pointer to a BSPtree object.
+ * @param element Pointer to an Element object.
+ */
+void RCA_TraceBSPtree(SDL_Surface *screen, BSPtree *bsptree, Element *element)
+{
+  int i;
+  Angle ray_angle = element->direction + RCA_RAYCASTER_HALF_FOV;
+  int slice_position = (RCA_RAYCASTER_COLUMNS - 1) * RCA_RAYCASTER_SLICE_WIDTH;
+  HitList hits;
+
+  for (i = 0; i < RCA_RAYCASTER_COLUMNS; i++)
+  {
+	RCA_ClearHitList(&hits);
+	RCA_TraceRayInBSPtree(bsptree, element, &hits, ray_angle, RCA_FindRaysGradient(ray_angle),
+						  fabs(RCA_FineCosine(ray_angle - element->direction)), 0, HUGE_VAL);
+
+	RCA_RAYCASTER__DEPTH_BUFFER[i] = RCA_ResolveHitList(screen, &hits, slice_position);
+
+	ray_angle -= RCA_RAYCASTER_COLUMN_ANGLE;
+	slice_position -= RCA_RAYCASTER_SLICE_WIDTH;
+  }
+}
+
+/**
+ * Find sectors of the tree.
+ * 
+ * @param bsptree  Pointer to a BSPtree object.
+ * @param sectors  Sectors found (output).
+ * @param count    Number of sectors already found.
+ * @param capacity Maximum number of sectors.
+ * @return         Number of sectors found.
+ */
+int RCA_FindBSPtreeSectors(BSPtree *bsptree, Sector **sectors, int count, int capacity)
+{
+  if (bsptree == NULL)
+	return count;
+  
+  /* check if we have a valid BSPtree object */
+  RCA_CheckBSPtree(bsptree);
+  
+  if (bsptree->sector != NULL && count < capacity)
+  {
+	sectors[count++] = bsptree->sector;
+  }
+  
+  count = RCA_FindBSPtreeSectors(bsptree->front, sectors, count, capacity);
+  count = RCA_FindBSPtreeSectors(bsptree->back, sectors, count, capacity);
+  
+  return count;
+}
+
 #endif
\ No newline at end of file
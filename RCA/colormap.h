@@ -0,0 +1,89 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Colormap.  Shading is done with a table computed once, indexed by
+ * light level and source colour (one channel), so a shaded colour
+ * costs a table load per channel instead of a multiply.
+ * 
+ * A sector's light goes from 0 (dark) to 255 (full bright) and is
+ * lowered with the distance, the result is one of RCA_COLORMAP_LEVELS
+ * light levels (RCA_COLORMAP_LEVELS - 1 leaving the colour untouched).
+ */
+
+#ifndef RCA_COLORMAP_H_
+#define RCA_COLORMAP_H_
+
+#define RCA_COLORMAP_LEVELS 32
+#define RCA_COLORMAP_FULL_BRIGHT 255	/* light of a new sector */
+#define RCA_COLORMAP_FALLOFF 40			/* distance to lose a light level */
+
+unsigned char RCA_COLORMAP__TABLE[RCA_COLORMAP_LEVELS][256];
+
+/**
+ * Initialize colormap.
+ * 
+ * Must be called once before anything is drawn.
+ */
+void RCA_InitColormap(void)
+{
+  int level, color;
+
+  for (level = 0; level < RCA_COLORMAP_LEVELS; level++)
+  {
+	for (color = 0; color < 256; color++)
+	{
+	  RCA_COLORMAP__TABLE[level][color] = (unsigned char)(color * (level + 1) / RCA_COLORMAP_LEVELS);
+	}
+  }
+}
+
+/**
+ * Clamp light level.
+ * 
+ * @param level Light level (may be out of range).
+ * @return      Light level between 0 and RCA_COLORMAP_LEVELS - 1.
+ */
+int RCA_ClampLightLevel(int level)
+{
+  if (level < 0)
+	return 0;
+  if (level >= RCA_COLORMAP_LEVELS)
+	return RCA_COLORMAP_LEVELS - 1;
+
+  return level;
+}
+
+/**
+ * Get light level.
+ * 
+ * @param light    Light of the sector (0 to 255).
+ * @param distance Distance to what is lit (corrected).
+ * @return         Light level (row of the colormap).
+ */
+int RCA_GetLightLevel(int light, double distance)
+{
+  return RCA_ClampLightLevel(light * RCA_COLORMAP_LEVELS / 256 - (int)(distance / RCA_COLORMAP_FALLOFF));
+}
+
+/**
+ * Shade a colour.
+ * 
+ * The alpha is left alone.
+ * 
+ * @param color  Colour to shade.
+ * @param level  Light level.
+ * @param shaded Shaded colour (output).
+ */
+void RCA_ShadeColor(int color[4], int level, int shaded[4])
+{
+  unsigned char *colormap = RCA_COLORMAP__TABLE[level];
+
+  shaded[0] = colormap[color[0]];
+  shaded[1] = colormap[color[1]];
+  shaded[2] = colormap[color[2]];
+  shaded[3] = color[3];
+}
+
+#endif
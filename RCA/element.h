@@ -9,6 +9,8 @@
 #include "SDL.h"
 #include "SDL_gfxPrimitives.h"
 
+#include "bam.h"
+
 #ifndef RCA_ELEMENT_H_
 #define RCA_ELEMENT_H_
 
@@ -21,7 +23,7 @@ typedef struct {
   unsigned int type;
   double x;
   double y;
-  double direction;				/* in degree */ 
+  Angle direction;				/* binary angle */ 
 } Element;
 
 /**
@@ -32,7 +34,7 @@ typedef struct {
  * @param y         Coordinate of Element.
  * @param direction Direction of Element.
  */
-void RCA_ConstructElement(Element *element, double x, double y, double direction)
+void RCA_ConstructElement(Element *element, double x, double y, Angle direction)
 {
   /* here OR the RCA_ELEMENT_TYPE constant into the type */
   element->type |= RCA_ELEMENT_TYPE;
@@ -50,7 +52,7 @@ void RCA_ConstructElement(Element *element, double x, double y, double direction
  * @param direction Direction of Element.
  * @return          An object Element.
  */
-Element *RCA_NewElement(double x, double y, double direction)
+Element *RCA_NewElement(double x, double y, Angle direction)
 {	
   Element *element = malloc(sizeof(Element));
   element->type = RCA_ELEMENT_TYPE;
@@ -107,9 +109,8 @@ void RCA_MoveElementForward(Element *element, double speed)
   /* check if we have a valid Element object */
   RCA_CheckElement(element);	
 	
-  /* don't forget to convert degree to rad */
-  element->x += (cos(element->direction * M_PI / 180) * speed);
-  element->y += (sin(element->direction * M_PI / 180) * speed);
+  element->x += (RCA_FineCosine(element->direction) * speed);
+  element->y += (RCA_FineSine(element->direction) * speed);
 }
 
 /**
@@ -123,9 +124,8 @@ void RCA_MoveElementBackward(Element *element, double speed)
   /* check if we have a valid Element object */
   RCA_CheckElement(element);	
 
-  /* don't forget to convert degree to rad */
-  element->x -= (cos(element->direction * M_PI / 180) * speed);
-  element->y -= (sin(element->direction * M_PI / 180) * speed);
+  element->x -= (RCA_FineCosine(element->direction) * speed);
+  element->y -= (RCA_FineSine(element->direction) * speed);
 }
 
 /**
@@ -139,9 +139,8 @@ void RCA_MoveElementLeft(Element *element, double speed)
   /* check if we have a valid Element object */
   RCA_CheckElement(element);	
 	
-  /* don't forget to convert degree to rad */
-  element->x += (cos((element->direction - 90) * M_PI / 180) * speed);
-  element->y += (sin((element->direction - 90) * M_PI / 180) * speed);
+  element->x += (RCA_FineCosine(element->direction - RCA_BAM_ANGLE_90) * speed);
+  element->y += (RCA_FineSine(element->direction - RCA_BAM_ANGLE_90) * speed);
 }
 
 /**
@@ -155,33 +154,23 @@ void RCA_MoveElementRight(Element *element, double speed)
   /* check if we have a valid Element object */
   RCA_CheckElement(element);
 	
-  /* don't forget to convert degree to rad */
-  element->x += (cos((element->direction + 90) * M_PI / 180) * speed);
-  element->y += (sin((element->direction + 90) * M_PI / 180) * speed);
+  element->x += (RCA_FineCosine(element->direction + RCA_BAM_ANGLE_90) * speed);
+  element->y += (RCA_FineSine(element->direction + RCA_BAM_ANGLE_90) * speed);
 }
 
 /**
  * Rotate direction of Element.
  * 0
  * @param element Pointer to an Element object.
- * @param speed   How much to rotate Element.
+ * @param speed   How much to rotate Element (binary angle).
  */
-void RCA_RotateElement(Element *element, double speed)
+void RCA_RotateElement(Element *element, Angle speed)
 {
   /* check if we have a valid Element object */
   RCA_CheckElement(element);
   
+  /* wraps around by itself */
   element->direction += speed;
-  
-  /* check angle limits */
-  if (element->direction < 0)
-  {
-	element->direction += 360;
-  }
-  if (element->direction >= 360)
-  {
-	element->direction -= 360;
-  }
 }
 
 /**
@@ -196,12 +185,13 @@ void RCA_DrawElement(SDL_Surface *screen, Element *element)
   RCA_CheckElement(element);
   
   filledEllipseRGBA(screen, (int)element->x, (int)element->y, 10, 10, 255, 0, 0, 255);
-  int lineX = element->x + (cos(element->direction * M_PI / 180) * 20);
-  int lineY = element->y + (sin(element->direction * M_PI / 180) * 20);
-  int arrow1X = element->x + (cos((element->direction + 30) * M_PI / 180) * 14);
-  int arrow1Y = element->y + (sin((element->direction + 30) * M_PI / 180) * 14);
-  int arrow2X = element->x + (cos((element->direction - 30) * M_PI / 180) * 14);
-  int arrow2Y = element->y + (sin((element->direction - 30) * M_PI / 180) * 14); 
+  Angle arrow = RCA_DegreesToBAM(30);
+  int lineX = element->x + (RCA_FineCosine(element->direction) * 20);
+  int lineY = element->y + (RCA_FineSine(element->direction) * 20);
+  int arrow1X = element->x + (RCA_FineCosine(element->direction + arrow) * 14);
+  int arrow1Y = element->y + (RCA_FineSine(element->direction + arrow) * 14);
+  int arrow2X = element->x + (RCA_FineCosine(element->direction - arrow) * 14);
+  int arrow2Y = element->y + (RCA_FineSine(element->direction - arrow) * 14); 
   lineRGBA(screen, (int)element->x, (int)element->y, (int)lineX, (int)lineY, 0, 255, 0, 255);
   lineRGBA(screen, (int)arrow1X, (int)arrow1Y, (int)lineX, (int)lineY, 0, 255, 0, 255);
   lineRGBA(screen, (int)arrow2X, (int)arrow2Y, (int)lineX, (int)lineY, 0, 255, 0, 255);
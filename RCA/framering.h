@@ -0,0 +1,465 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Frame ring.  Frames are rendered straight into the slots of a POSIX
+ * shared memory object, so other processes (encoder, analytics) read
+ * them without any copy.  The renderer owns the ring, consumers attach
+ * to it by name and may come and go at any time.
+ * 
+ * Every slot is guarded by a sequence number (a seqlock): odd while the
+ * slot is being written, even once the frame is complete.  A consumer
+ * notes the sequence before reading a frame and checks it did not change
+ * afterwards, nothing is ever locked.  When the ring is full the oldest
+ * frame is overwritten (RCA_FRAMERING_DROP_OLDEST) or the renderer waits
+ * for the consumer (RCA_FRAMERING_BLOCK, one consumer, and never longer
+ * than RCA_FRAMERING_BLOCK_TIMEOUT so a dead consumer can't stall it).
+ * 
+ * Link with -lrt on older C libraries (shm_open).
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SDL.h"
+
+#ifndef RCA_FRAMERING_H_
+#define RCA_FRAMERING_H_
+
+#define RCA_FRAMERING_TYPE (1<<9)		/* dynamic type checking */
+#define RCA_FRAMERING_MAGIC 0x46414352	/* "RCAF" */
+#define RCA_FRAMERING_VERSION 1
+#define RCA_FRAMERING_DROP_OLDEST 0
+#define RCA_FRAMERING_BLOCK 1
+#define RCA_FRAMERING_BLOCK_TIMEOUT 100	/* in millisecond */
+#define RCA_FRAMERING_ALIGNMENT 64		/* slots start on a cache line */
+
+/**
+ * Header of the shared memory object.
+ */
+typedef struct {
+  unsigned int magic;
+  unsigned int version;
+  unsigned int slot_count;
+  unsigned int slot_size;		/* in byte, metadata and pixels */
+  unsigned int width;
+  unsigned int height;
+  unsigned int pitch;			/* 32-bit pixels, 0x00RRGGBB */
+  unsigned int policy;
+  unsigned int consumers;		/* attached */
+  unsigned int reserved;
+  unsigned long long write_index;	/* frames published */
+  unsigned long long read_index;	/* frames released by the consumer (block only) */
+} FrameRingHeader;
+
+/**
+ * Metadata of a frame, at the start of its slot (the pixels follow).
+ */
+typedef struct {
+  unsigned int sequence;		/* odd while written */
+  unsigned int reserved;
+  unsigned long long frame;		/* frame number */
+  double x;						/* pose of the element */
+  double y;
+  double direction;
+  double timestamp;				/* in second */
+} FrameInfo;
+
+/**
+ * FrameRing class.
+ */
+typedef struct {
+  unsigned int type;
+  char name[256];
+  int owner;					/* the renderer (unlinks the object) */
+  size_t size;
+  FrameRingHeader *header;		/* mapping */
+  SDL_Surface **surfaces;		/* one per slot, renderer only */
+  unsigned long long cursor;	/* next frame, consumer only */
+  unsigned int sequence;		/* of the frame acquired, consumer only */
+} FrameRing;
+
+/**
+ * Round a size to the alignment of the slots.
+ * 
+ * @param size Size in byte.
+ * @return     Size rounded up.
+ */
+size_t RCA_AlignFrameRingSize(size_t size)
+{
+  return (size + RCA_FRAMERING_ALIGNMENT - 1) / RCA_FRAMERING_ALIGNMENT * RCA_FRAMERING_ALIGNMENT;
+}
+
+/**
+ * Get metadata of a slot.
+ * 
+ * @param ring Pointer to a FrameRing object.
+ * @param slot Index of the slot.
+ * @return     Metadata of the slot (its pixels follow).
+ */
+FrameInfo *RCA_GetFrameRingSlot(FrameRing *ring, unsigned int slot)
+{
+  return (FrameInfo *)((char *)ring->header + RCA_AlignFrameRingSize(sizeof(FrameRingHeader)) + (size_t)slot * ring->header->slot_size);
+}
+
+/**
+ * Get pixels of a slot.
+ * 
+ * @param ring Pointer to a FrameRing object.
+ * @param slot Index of the slot.
+ * @return     First pixel of the slot.
+ */
+void *RCA_GetFrameRingPixels(FrameRing *ring, unsigned int slot)
+{
+  return (char *)RCA_GetFrameRingSlot(ring, slot) + RCA_AlignFrameRingSize(sizeof(FrameInfo));
+}
+
+/**
+ * Constructor.
+ * 
+ * @param ring   Pointer to a FrameRing object.
+ * @param name   Name of the shared memory object ("/something").
+ * @param owner  True (1) for the renderer, false (0) for a consumer.
+ * @param size   Size of the mapping.
+ * @param header Mapping.
+ */
+void RCA_ConstructFrameRing(FrameRing *ring, const char *name, int owner, size_t size, FrameRingHeader *header)
+{
+  /* here OR the RCA_FRAMERING_TYPE constant into the type */
+  ring->type |= RCA_FRAMERING_TYPE;
+
+  snprintf(ring->name, sizeof(ring->name), "%s", name);
+  ring->owner = owner;
+  ring->size = size;
+  ring->header = header;
+  ring->surfaces = NULL;
+  ring->cursor = 0;
+  ring->sequence = 0;
+}
+
+/**
+ * New (renderer).
+ * 
+ * Creates the shared memory object, replacing any left by a previous run.
+ * 
+ * @param name       Name of the shared memory object ("/something").
+ * @param slot_count Number of frames in the ring (at least 2).
+ * @param width      Width of the frames.
+ * @param height     Height of the frames.
+ * @param policy     RCA_FRAMERING_DROP_OLDEST or RCA_FRAMERING_BLOCK.
+ * @return           An object FrameRing or NULL.
+ */
+FrameRing *RCA_NewFrameRing(const char *name, int slot_count, int width, int height, int policy)
+{
+  unsigned int i;
+  unsigned int pitch = width * 4;
+  size_t slot_size = RCA_AlignFrameRingSize(sizeof(FrameInfo)) + RCA_AlignFrameRingSize((size_t)pitch * height);
+  size_t size = RCA_AlignFrameRingSize(sizeof(FrameRingHeader)) + slot_count * slot_size;
+  FrameRingHeader *header;
+  int fd;
+
+  assert(slot_count >= 2);
+
+  shm_unlink(name);
+  fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0)
+	return NULL;
+  if (ftruncate(fd, size) != 0)
+  {
+	close(fd);
+	shm_unlink(name);
+	return NULL;
+  }
+
+  header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (header == MAP_FAILED)
+  {
+	shm_unlink(name);
+	return NULL;
+  }
+
+  header->version = RCA_FRAMERING_VERSION;
+  header->slot_count = slot_count;
+  header->slot_size = slot_size;
+  header->width = width;
+  header->height = height;
+  header->pitch = pitch;
+  header->policy = policy;
+  header->consumers = 0;
+  header->write_index = 0;
+  header->read_index = 0;
+
+  /* the magic goes last, a consumer attaching early sees a complete header or none */
+  __atomic_store_n(&header->magic, RCA_FRAMERING_MAGIC, __ATOMIC_RELEASE);
+
+  FrameRing *ring = malloc(sizeof(FrameRing));
+  ring->type = RCA_FRAMERING_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructFrameRing(ring, name, 1, size, header);
+
+  /* the renderer draws straight into the slots */
+  ring->surfaces = malloc(slot_count * sizeof(SDL_Surface *));
+  for (i = 0; i < header->slot_count; i++)
+  {
+	RCA_GetFrameRingSlot(ring, i)->sequence = 0;
+	ring->surfaces[i] = SDL_CreateRGBSurfaceFrom(RCA_GetFrameRingPixels(ring, i), width, height, 32, pitch,
+												 0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+  }
+
+  return ring;
+}
+
+/**
+ * Attach to a ring (consumer).
+ * 
+ * Reading starts with the next frame published.
+ * 
+ * @param name Name of the shared memory object ("/something").
+ * @return     An object FrameRing or NULL (no ring of that name yet).
+ */
+FrameRing *RCA_AttachFrameRing(const char *name)
+{
+  FrameRingHeader *header;
+  struct stat info;
+  int fd = shm_open(name, O_RDWR, 0);
+
+  if (fd < 0)
+	return NULL;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(FrameRingHeader))
+  {
+	close(fd);
+	return NULL;
+  }
+
+  header = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (header == MAP_FAILED)
+	return NULL;
+
+  /* the slots must fit in the mapping, and the frames in the slots */
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != RCA_FRAMERING_MAGIC ||
+	  header->version != RCA_FRAMERING_VERSION ||
+	  header->slot_size < RCA_AlignFrameRingSize(sizeof(FrameInfo)) + (size_t)header->pitch * header->height ||
+	  (size_t)info.st_size < RCA_AlignFrameRingSize(sizeof(FrameRingHeader)) + (size_t)header->slot_count * header->slot_size)
+  {
+	munmap(header, info.st_size);
+	return NULL;
+  }
+
+  FrameRing *ring = malloc(sizeof(FrameRing));
+  ring->type = RCA_FRAMERING_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructFrameRing(ring, name, 0, info.st_size, header);
+
+  ring->cursor = __atomic_load_n(&header->write_index, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&header->read_index, ring->cursor, __ATOMIC_RELEASE);
+  __atomic_fetch_add(&header->consumers, 1, __ATOMIC_ACQ_REL);
+
+  return ring;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param ring Pointer to a FrameRing object.
+ */
+void RCA_CheckFrameRing(FrameRing *ring)
+{
+  /* check if we have a valid FrameRing object */
+  if (ring == NULL ||
+	  !(ring->type & RCA_FRAMERING_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * A consumer detaches, the renderer removes the shared memory object
+ * (consumers still attached keep their mapping until they detach).
+ * 
+ * @param ring Pointer to a FrameRing object.
+ */
+void RCA_DestroyFrameRing(FrameRing *ring)
+{
+  unsigned int i;
+
+  /* check if we have a valid FrameRing object */
+  RCA_CheckFrameRing(ring);
+
+  /* set type to 0 indicate this is no longer a FrameRing object */
+  ring->type = 0;
+
+  /* free the memory allocated for the object */
+  if (ring->owner)
+  {
+	for (i = 0; i < ring->header->slot_count; i++)
+	{
+	  SDL_FreeSurface(ring->surfaces[i]);
+	}
+	free(ring->surfaces);
+	shm_unlink(ring->name);
+  }
+  else
+  {
+	__atomic_fetch_sub(&ring->header->consumers, 1, __ATOMIC_ACQ_REL);
+  }
+
+  munmap(ring->header, ring->size);
+  free(ring);
+}
+
+/**
+ * Begin a frame (renderer).
+ * 
+ * With the block policy, waits for the consumer while the ring is full.
+ * 
+ * @param ring Pointer to a FrameRing object.
+ * @return     Surface of the slot to draw the frame into.
+ */
+SDL_Surface *RCA_BeginFrame(FrameRing *ring)
+{
+  /* check if we have a valid FrameRing object */
+  RCA_CheckFrameRing(ring);
+
+  FrameRingHeader *header = ring->header;
+  unsigned long long index = header->write_index;		/* only the renderer writes it */
+  unsigned int slot = index % header->slot_count;
+  FrameInfo *info = RCA_GetFrameRingSlot(ring, slot);
+  Uint32 start = SDL_GetTicks();
+
+  while (header->policy == RCA_FRAMERING_BLOCK &&
+		 __atomic_load_n(&header->consumers, __ATOMIC_ACQUIRE) > 0 &&
+		 index - __atomic_load_n(&header->read_index, __ATOMIC_ACQUIRE) >= header->slot_count &&
+		 SDL_GetTicks() - start < RCA_FRAMERING_BLOCK_TIMEOUT)
+  {
+	SDL_Delay(0);
+  }
+
+  /* odd, the slot is being written */
+  __atomic_store_n(&info->sequence, info->sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  return ring->surfaces[slot];
+}
+
+/**
+ * End a frame (renderer).
+ * 
+ * Publishes the frame begun with RCA_BeginFrame.
+ * 
+ * @param ring      Pointer to a FrameRing object.
+ * @param x         Pose of the element.
+ * @param y         Pose of the element.
+ * @param direction Pose of the element.
+ * @param timestamp Time of the frame (in second).
+ */
+void RCA_EndFrame(FrameRing *ring, double x, double y, double direction, double timestamp)
+{
+  /* check if we have a valid FrameRing object */
+  RCA_CheckFrameRing(ring);
+
+  FrameRingHeader *header = ring->header;
+  unsigned long long index = header->write_index;
+  FrameInfo *info = RCA_GetFrameRingSlot(ring, index % header->slot_count);
+
+  info->frame = index;
+  info->x = x;
+  info->y = y;
+  info->direction = direction;
+  info->timestamp = timestamp;
+
+  /* even again, then visible to the consumers */
+  __atomic_store_n(&info->sequence, info->sequence + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&header->write_index, index + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Acquire the next frame (consumer).
+ * 
+ * Frames overwritten before they could be read are skipped.  The pixels
+ * are read in place, then the frame is given back with RCA_ReleaseFrame
+ * which tells if it was overwritten meanwhile.
+ * 
+ * @param ring Pointer to a FrameRing object.
+ * @param info Metadata of the frame (output).
+ * @return     First pixel of the frame or NULL (no new frame yet).
+ */
+void *RCA_AcquireFrame(FrameRing *ring, FrameInfo *info)
+{
+  /* check if we have a valid FrameRing object */
+  RCA_CheckFrameRing(ring);
+
+  FrameRingHeader *header = ring->header;
+  unsigned long long written;
+  unsigned int slot, sequence;
+  FrameInfo *current;
+
+  while (1)
+  {
+	written = __atomic_load_n(&header->write_index, __ATOMIC_ACQUIRE);
+	if (ring->cursor >= written)
+	  return NULL;
+
+	/* fell behind, the oldest slot may be written again right now */
+	if (written - ring->cursor >= header->slot_count)
+	  ring->cursor = written - header->slot_count + 1;
+
+	slot = ring->cursor % header->slot_count;
+	current = RCA_GetFrameRingSlot(ring, slot);
+	sequence = __atomic_load_n(&current->sequence, __ATOMIC_ACQUIRE);
+
+	if (!(sequence & 1))
+	{
+	  memcpy(info, current, sizeof(FrameInfo));
+	  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	  if (__atomic_load_n(&current->sequence, __ATOMIC_RELAXED) == sequence && info->frame == ring->cursor)
+	  {
+		ring->sequence = sequence;
+		return RCA_GetFrameRingPixels(ring, slot);
+	  }
+	}
+
+	/* overwritten, try the next one */
+	ring->cursor++;
+  }
+}
+
+/**
+ * Release the frame acquired (consumer).
+ * 
+ * @param ring Pointer to a FrameRing object.
+ * @return     True (1) if the frame was intact all along, false (0) if it was overwritten.
+ */
+int RCA_ReleaseFrame(FrameRing *ring)
+{
+  /* check if we have a valid FrameRing object */
+  RCA_CheckFrameRing(ring);
+
+  FrameInfo *current = RCA_GetFrameRingSlot(ring, ring->cursor % ring->header->slot_count);
+  int intact;
+
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  intact = (__atomic_load_n(&current->sequence, __ATOMIC_RELAXED) == ring->sequence);
+
+  ring->cursor++;
+  __atomic_store_n(&ring->header->read_index, ring->cursor, __ATOMIC_RELEASE);
+
+  return intact;
+}
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Hit list.  Every wall hit by a ray is recorded, sorted from the nearest
+ * to the farthest, so a column can be resolved front to back whatever
+ * the number of sectors stacked along the ray.  The list has a fixed
+ * capacity and lives on the stack, nothing is allocated per column.
+ */
+
+#include "sector.h"
+
+#ifndef RCA_HITLIST_H_
+#define RCA_HITLIST_H_
+
+#define RCA_HITLIST_CAPACITY 32			/* farther hits are dropped once full */
+
+/**
+ * Wall hit by a ray.
+ */
+typedef struct {
+  Sector *wall;
+  Sector *sector;				/* master of the wall */
+  double distance;
+  double corrected_distance;	/* fish-eye corrected */
+  double x;						/* intersection */
+  double y;
+  int inside;					/* the ray is in the sector just before the hit */
+} Hit;
+
+/**
+ * Hit list (one per column).
+ */
+typedef struct {
+  int count;
+  Hit hits[RCA_HITLIST_CAPACITY];
+} HitList;
+
+/**
+ * Clear hit list.
+ * 
+ * @param hits Pointer to a HitList.
+ */
+void RCA_ClearHitList(HitList *hits)
+{
+  hits->count = 0;
+}
+
+/**
+ * Add a hit to the list.
+ * 
+ * Insertion sort, the lists are short.
+ * 
+ * @param hits               Pointer to a HitList.
+ * @param wall               Wall hit.
+ * @param sector             Master of the wall.
+ * @param distance           Distance to the intersection.
+ * @param corrected_distance Distance corrected for the fish-eye.
+ * @param x                  Intersection.
+ * @param y                  Intersection.
+ */
+void RCA_AddHitToList(HitList *hits, Sector *wall, Sector *sector, double distance, double corrected_distance, double x, double y)
+{
+  int i = hits->count;
+
+  if (i == RCA_HITLIST_CAPACITY)
+  {
+	/* full, the farthest hit goes away */
+	if (distance >= hits->hits[i - 1].distance)
+	  return;
+	i--;
+  }
+  else
+  {
+	hits->count++;
+  }
+
+  for (; i > 0 && hits->hits[i - 1].distance > distance; i--)
+  {
+	hits->hits[i] = hits->hits[i - 1];
+  }
+
+  hits->hits[i].wall = wall;
+  hits->hits[i].sector = sector;
+  hits->hits[i].distance = distance;
+  hits->hits[i].corrected_distance = corrected_distance;
+  hits->hits[i].x = x;
+  hits->hits[i].y = y;
+}
+
+/**
+ * Find on which side of its sector every hit is seen.
+ * 
+ * The ray ends outside of every sector, so with n hits of a sector along
+ * the ray it is inside that sector before the hit k (counted from the
+ * nearest, starting at 0) when n - k is odd.
+ * 
+ * @param hits Pointer to a HitList.
+ */
+void RCA_FindHitParity(HitList *hits)
+{
+  int k, j, remaining;
+
+  for (k = hits->count - 1; k >= 0; k--)
+  {
+	remaining = 1;
+	for (j = k + 1; j < hits->count; j++)
+	{
+	  if (hits->hits[j].sector == hits->hits[k].sector)
+		remaining++;
+	}
+	hits->hits[k].inside = remaining & 1;
+  }
+}
+
+/**
+ * Order the hits at the same distance.
+ * 
+ * Where the ray leaves a sector for the next one both are hit at the
+ * same distance, the sector left is the nearest (the traversal draws it
+ * last), so its hit comes first.  Parity found.
+ * 
+ * @param hits Pointer to a HitList.
+ */
+void RCA_OrderHitTies(HitList *hits)
+{
+  int k, j;
+  Hit hit;
+
+  for (k = 1; k < hits->count; k++)
+  {
+	hit = hits->hits[k];
+	for (j = k; j > 0 && hits->hits[j - 1].distance == hit.distance && !hits->hits[j - 1].inside && hit.inside; j--)
+	{
+	  hits->hits[j] = hits->hits[j - 1];
+	}
+	hits->hits[j] = hit;
+  }
+}
+
+/**
+ * Check if two lists hit the same walls.
+ * 
+ * @param hits  Pointer to a HitList.
+ * @param other Pointer to a HitList.
+ * @return      True (1) if the same walls are hit in the same order, false (0) otherwise.
+ */
+int RCA_CompareHitLists(HitList *hits, HitList *other)
+{
+  int k;
+
+  if (hits->count != other->count)
+	return 0;
+
+  for (k = 0; k < hits->count; k++)
+  {
+	if (hits->hits[k].wall != other->hits[k].wall)
+	  return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * Find the nearest opaque hit.
+ * 
+ * Nothing behind it can be seen (its middle wall is visible).
+ * 
+ * @param hits Pointer to a HitList.
+ * @return     Distance to the nearest opaque hit or HUGE_VAL.
+ */
+double RCA_FindNearestOpaqueHit(HitList *hits)
+{
+  int k;
+
+  for (k = 0; k < hits->count; k++)
+  {
+	if (hits->hits[k].wall->middle_color[3] != 0)
+	  return hits->hits[k].distance;
+  }
+
+  return HUGE_VAL;
+}
+
+#endif
@@ -0,0 +1,714 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Hot reload of a map.  The directory of the map is watched with inotify
+ * (editors often write a new file and rename it over the old one), and
+ * once the file changed it is read again without being loaded again.
+ * 
+ * The text of the map as loaded is kept.  The new text is only split in
+ * records of sectors and of the tree, which is compared to the old one:
+ * only the sectors whose records changed are parsed, and their new walls
+ * are swapped into the sectors of the map, so the tree, the minimap and
+ * anything else pointing to a sector still do, and the cached constants
+ * of the other walls are kept.  The tree is compared subtree by subtree
+ * and only the subtrees that differ are parsed and swapped in, then
+ * compiled again in place in the BSParray when they have as many nodes
+ * as before (the whole tree is compiled again otherwise).
+ * 
+ * Everything is read and parsed before the map is touched: a file that
+ * can't be read (half written, wrong record) leaves the map as it was.
+ * The reload is meant to be done between two frames.  Sectors added or
+ * removed can't be reloaded this way, the map must be loaded again.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "bsparray.h"
+#include "bsptree.h"
+#include "map.h"
+#include "minimap.h"
+#include "sector.h"
+
+#ifndef RCA_HOTRELOAD_H_
+#define RCA_HOTRELOAD_H_
+
+#define RCA_HOTRELOAD_TYPE (1<<14)		/* dynamic type checking */
+#define RCA_HOTRELOAD_EVENTS 4096		/* bytes of events read at once */
+
+#define RCA_HOTRELOAD_FAILED -1			/* the file can't be read, the map is as it was */
+#define RCA_HOTRELOAD_NONE 0			/* nothing changed */
+#define RCA_HOTRELOAD_DONE 1
+#define RCA_HOTRELOAD_FULL 2			/* sectors added or removed, the map must be loaded again */
+
+/**
+ * Text of a map, split in records of sectors and of the tree.
+ */
+typedef struct {
+  char *text;					/* ends with a null character */
+  size_t length;
+  size_t capacity;
+  size_t (*sectors)[2];			/* start and end of the records of every sector */
+  int count;
+  int sector_capacity;
+  size_t *records;				/* start of every record of the tree, in preorder */
+  int *sizes;					/* records in the subtree of every record */
+  int record_count;
+  int record_capacity;
+  size_t tree_end;
+} MapText;
+
+/**
+ * Subtree read again, to be swapped into the tree of the map.
+ */
+typedef struct {
+  BSPtree **slot;				/* where it goes in the tree */
+  BSPtree *subtree;
+  unsigned int index;			/* of the subtree it replaces in the BSParray */
+} MapSubtree;
+
+/**
+ * MapWatch class.
+ */
+typedef struct {
+  unsigned int type;
+  char *directory;				/* watched */
+  char *name;					/* of the map in the directory */
+  int fd;
+  MapText loaded;				/* as the map was loaded */
+  MapText read;					/* as read again */
+  int *changed;					/* sectors staged */
+  Sector **staged;				/* their new walls */
+  int changed_count;
+  int changed_capacity;
+  MapSubtree *subtrees;			/* staged */
+  int subtree_count;
+  int subtree_capacity;
+  int sectors_rebuilt;			/* by the last reload */
+  int nodes_rebuilt;
+} MapWatch;
+
+/**
+ * Find if a line starts with a word.
+ * 
+ * @param line Line (leading spaces skipped).
+ * @param end  End of the line.
+ * @param word Word.
+ * @return     True (1) if it does, false (0) otherwise.
+ */
+int RCA_IsMapWord(const char *line, const char *end, const char *word)
+{
+  size_t length = strlen(word);
+
+  return (size_t)(end - line) >= length && memcmp(line, word, length) == 0 &&
+	(line + length == end || strchr(" \t\r#", line[length]) != NULL);
+}
+
+/**
+ * Read the text of a map and split it.
+ * 
+ * Only the start of every line is looked at, nothing is parsed.
+ * 
+ * @param text Pointer to a MapText.
+ * @param file File of the map.
+ * @return     True (1) if it looks like a map, false (0) otherwise.
+ */
+int RCA_ReadMapText(MapText *text, FILE *file)
+{
+  size_t start, end, line;
+  int pending = 0, in_sector = 0, i, top, *stack;
+  char *next;
+
+  /* the whole file at once */
+  text->length = 0;
+  for (;;)
+  {
+	if (text->length == text->capacity)
+	{
+	  text->capacity *= 2;
+	  text->text = realloc(text->text, text->capacity);
+	}
+	start = fread(text->text + text->length, 1, text->capacity - text->length, file);
+	text->length += start;
+	if (start == 0)
+	  break;
+  }
+  text->text[text->length] = '\0';
+
+  text->count = 0;
+  text->record_count = 0;
+  text->tree_end = 0;
+  for (start = 0; start < text->length; start = end + 1)
+  {
+	next = memchr(text->text + start, '\n', text->length - start);
+	end = (next != NULL) ? (size_t)(next - text->text) : text->length;
+	line = start + strspn(text->text + start, " \t");
+	if (line >= end || text->text[line] == '#' || text->text[line] == '\r')
+	  continue;
+
+	/* the tree goes on until every node has its two children */
+	if (pending > 0)
+	{
+	  if (text->record_count == text->record_capacity)
+	  {
+		text->record_capacity *= 2;
+		text->records = realloc(text->records, text->record_capacity * sizeof(size_t));
+		text->sizes = realloc(text->sizes, text->record_capacity * sizeof(int));
+	  }
+	  text->records[text->record_count++] = start;
+	  pending += RCA_IsMapWord(text->text + line, text->text + end, "node") ? 1 : -1;
+	  if (pending == 0)
+		text->tree_end = (end < text->length) ? end + 1 : end;
+	  continue;
+	}
+
+	if (RCA_IsMapWord(text->text + line, text->text + end, "sector") ||
+		RCA_IsMapWord(text->text + line, text->text + end, "tree"))
+	{
+	  if (in_sector)
+		text->sectors[text->count++][1] = start;
+	  in_sector = (text->text[line] == 's');
+
+	  if (in_sector)
+	  {
+		if (text->count == text->sector_capacity)
+		{
+		  text->sector_capacity *= 2;
+		  text->sectors = realloc(text->sectors, text->sector_capacity * sizeof(size_t[2]));
+		}
+		text->sectors[text->count][0] = (end < text->length) ? end + 1 : end;
+	  }
+	  else if (text->record_count > 0)
+	  {
+		return 0;
+	  }
+	  else
+	  {
+		pending = 1;
+	  }
+	}
+  }
+  if (in_sector)
+	text->sectors[text->count++][1] = text->length;
+
+  if (text->record_count == 0 || pending > 0)
+	return 0;
+
+  /* sizes of the subtrees, from the last record: the children of a node are on the stack */
+  stack = malloc(text->record_count * sizeof(int));
+  top = 0;
+  for (i = text->record_count - 1; i >= 0; i--)
+  {
+	line = text->records[i] + strspn(text->text + text->records[i], " \t");
+	text->sizes[i] = 1;
+	if (RCA_IsMapWord(text->text + line, text->text + text->length, "node"))
+	{
+	  text->sizes[i] += text->sizes[stack[top - 1]] + text->sizes[stack[top - 2]];
+	  top -= 2;
+	}
+	stack[top++] = i;
+  }
+  free(stack);
+
+  return 1;
+}
+
+/**
+ * Find the end of a subtree in the text.
+ * 
+ * @param text   Pointer to a MapText.
+ * @param record Record of the root of the subtree.
+ * @return       End of its last record.
+ */
+size_t RCA_FindMapSubtreeEnd(MapText *text, int record)
+{
+  int next = record + text->sizes[record];
+
+  return (next < text->record_count) ? text->records[next] : text->tree_end;
+}
+
+/**
+ * Find if a part of two texts is the same.
+ * 
+ * @param a       Pointer to a MapText.
+ * @param a_start Start of the part of a.
+ * @param a_end   End of the part of a.
+ * @param b       Pointer to a MapText.
+ * @param b_start Start of the part of b.
+ * @param b_end   End of the part of b.
+ * @return        True (1) if it is, false (0) otherwise.
+ */
+int RCA_IsSameMapText(MapText *a, size_t a_start, size_t a_end, MapText *b, size_t b_start, size_t b_end)
+{
+  return a_end - a_start == b_end - b_start && memcmp(a->text + a_start, b->text + b_start, a_end - a_start) == 0;
+}
+
+/**
+ * Allocate the text of a map.
+ * 
+ * @param text Pointer to a MapText.
+ */
+void RCA_InitMapText(MapText *text)
+{
+  text->capacity = 1 << 16;
+  text->text = malloc(text->capacity);
+  text->length = 0;
+  text->sector_capacity = 64;
+  text->sectors = malloc(text->sector_capacity * sizeof(size_t[2]));
+  text->count = 0;
+  text->record_capacity = 64;
+  text->records = malloc(text->record_capacity * sizeof(size_t));
+  text->sizes = malloc(text->record_capacity * sizeof(int));
+  text->record_count = 0;
+  text->tree_end = 0;
+}
+
+/**
+ * Free the text of a map.
+ * 
+ * @param text Pointer to a MapText.
+ */
+void RCA_FreeMapText(MapText *text)
+{
+  free(text->text);
+  free(text->sectors);
+  free(text->records);
+  free(text->sizes);
+}
+
+/**
+ * Constructor.
+ * 
+ * @param watch     Pointer to a MapWatch object.
+ * @param directory Directory watched.
+ * @param name      Name of the map in the directory.
+ * @param fd        Inotify instance watching the directory.
+ */
+void RCA_ConstructMapWatch(MapWatch *watch, const char *directory, const char *name, int fd)
+{
+  /* here OR the RCA_HOTRELOAD_TYPE constant into the type */
+  watch->type |= RCA_HOTRELOAD_TYPE;
+
+  watch->directory = strdup(directory);
+  watch->name = strdup(name);
+  watch->fd = fd;
+  RCA_InitMapText(&watch->loaded);
+  RCA_InitMapText(&watch->read);
+  watch->changed_count = 0;
+  watch->changed_capacity = 16;
+  watch->changed = malloc(watch->changed_capacity * sizeof(int));
+  watch->staged = malloc(watch->changed_capacity * sizeof(Sector *));
+  watch->subtree_count = 0;
+  watch->subtree_capacity = 16;
+  watch->subtrees = malloc(watch->subtree_capacity * sizeof(MapSubtree));
+  watch->sectors_rebuilt = 0;
+  watch->nodes_rebuilt = 0;
+}
+
+/**
+ * New.
+ * 
+ * The text of the map is kept as it is on disk, so it should be the
+ * one just loaded.
+ * 
+ * @param path Path of the map.
+ * @return     An object MapWatch (NULL if the map can't be read or watched).
+ */
+MapWatch *RCA_NewMapWatch(const char *path)
+{
+  const char *slash = strrchr(path, '/');
+  char *directory;
+  FILE *file = fopen(path, "r");
+  int fd;
+
+  if (file == NULL)
+	return NULL;
+
+  /* the directory, with the slash of the root kept */
+  directory = strdup(path);
+  if (slash == NULL)
+	strcpy(directory, ".");
+  else
+	directory[(slash == path) ? 1 : slash - path] = '\0';
+
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0 || inotify_add_watch(fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+  {
+	if (fd >= 0)
+	  close(fd);
+	fclose(file);
+	free(directory);
+	return NULL;
+  }
+
+  MapWatch *watch = malloc(sizeof(MapWatch));
+  watch->type = RCA_HOTRELOAD_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructMapWatch(watch, directory, (slash == NULL) ? path : slash + 1, fd);
+  free(directory);
+
+  /* the map as it is now (it was just loaded, so it can be read) */
+  RCA_ReadMapText(&watch->loaded, file);
+  fclose(file);
+
+  return watch;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param watch Pointer to a MapWatch object.
+ */
+void RCA_CheckMapWatch(MapWatch *watch)
+{
+  /* check if we have a valid MapWatch object */
+  if (watch == NULL ||
+	  !(watch->type & RCA_HOTRELOAD_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Drop what a reload staged.
+ * 
+ * @param watch Pointer to a MapWatch object.
+ */
+void RCA_ClearMapWatch(MapWatch *watch)
+{
+  int i;
+
+  for (i = 0; i < watch->changed_count; i++)
+  {
+	RCA_DestroySector(watch->staged[i]);
+  }
+  watch->changed_count = 0;
+
+  for (i = 0; i < watch->subtree_count; i++)
+  {
+	if (watch->subtrees[i].subtree != NULL)
+	  RCA_DestroyBSPtree(watch->subtrees[i].subtree);
+  }
+  watch->subtree_count = 0;
+}
+
+/**
+ * Destructor.
+ * 
+ * @param watch Pointer to a MapWatch object.
+ */
+void RCA_DestroyMapWatch(MapWatch *watch)
+{
+  /* check if we have a valid MapWatch object */
+  RCA_CheckMapWatch(watch);
+
+  /* set type to 0 indicate this is no longer a MapWatch object */
+  watch->type = 0;
+
+  /* free the memory allocated for the object */
+  RCA_ClearMapWatch(watch);
+  close(watch->fd);
+  free(watch->directory);
+  free(watch->name);
+  RCA_FreeMapText(&watch->loaded);
+  RCA_FreeMapText(&watch->read);
+  free(watch->changed);
+  free(watch->staged);
+  free(watch->subtrees);
+  free(watch);
+}
+
+/**
+ * Find if the map changed on disk.
+ * 
+ * Never waits, every event since the last time is read.
+ * 
+ * @param watch Pointer to a MapWatch object.
+ * @return      True (1) if the map was written or replaced, false (0) otherwise.
+ */
+int RCA_PollMapWatch(MapWatch *watch)
+{
+  char events[RCA_HOTRELOAD_EVENTS] __attribute__((aligned(__alignof__(struct inotify_event))));
+  struct inotify_event *event;
+  ssize_t length;
+  char *next;
+  int changed = 0;
+
+  /* check if we have a valid MapWatch object */
+  RCA_CheckMapWatch(watch);
+
+  while ((length = read(watch->fd, events, sizeof(events))) > 0)
+  {
+	for (next = events; next < events + length; next += sizeof(struct inotify_event) + event->len)
+	{
+	  event = (struct inotify_event *)next;
+	  if (event->len > 0 && strcmp(event->name, watch->name) == 0)
+		changed = 1;
+	}
+  }
+
+  return changed;
+}
+
+/**
+ * Parse the records of a sector read again.
+ * 
+ * The player and the lamps are left out, they only matter when the map
+ * is loaded.
+ * 
+ * @param watch Pointer to a MapWatch object.
+ * @param index Of the sector.
+ * @return      True (1) if the sector could be read, false (0) otherwise.
+ */
+int RCA_StageMapSector(MapWatch *watch, int index)
+{
+  char line[RCA_MAP_LINE];
+  const char *record;
+  size_t start = watch->read.sectors[index][0], end = watch->read.sectors[index][1];
+  Sector *sector = RCA_NewSector();
+  FILE *file;
+  int valid = 1;
+
+  if (watch->changed_count == watch->changed_capacity)
+  {
+	watch->changed_capacity *= 2;
+	watch->changed = realloc(watch->changed, watch->changed_capacity * sizeof(int));
+	watch->staged = realloc(watch->staged, watch->changed_capacity * sizeof(Sector *));
+  }
+  watch->changed[watch->changed_count] = index;
+  watch->staged[watch->changed_count++] = sector;
+
+  /* a sector without walls */
+  if (end == start)
+	return 1;
+
+  file = fmemopen(watch->read.text + start, end - start, "r");
+  if (file == NULL)
+	return 0;
+  while (valid && RCA_ReadMapRecord(file, line))
+  {
+	record = line + strspn(line, " \t");
+	valid = RCA_IsMapWord(record, record + strlen(record), "lamp") ||
+	  RCA_IsMapWord(record, record + strlen(record), "player") || RCA_ReadMapSectorRecord(sector, line);
+  }
+  fclose(file);
+
+  return valid;
+}
+
+/**
+ * Compare a subtree of the map with the one read again.
+ * 
+ * The subtrees that differ are parsed and staged, nothing is changed
+ * in the map.
+ * 
+ * @param watch    Pointer to a MapWatch object.
+ * @param map      Pointer to a Map object.
+ * @param bsparray Pointer to a BSParray object (the map compiled).
+ * @param slot     Subtree of the map.
+ * @param loaded   Record of the subtree when the map was loaded.
+ * @param read     Record of the subtree read again.
+ * @param index    Of the subtree in the BSParray.
+ * @return         True (1) if the subtree could be read, false (0) otherwise.
+ */
+int RCA_StageMapSubtree(MapWatch *watch, Map *map, BSParray *bsparray, BSPtree **slot, int loaded, int read, unsigned int index)
+{
+  MapText *a = &watch->loaded, *b = &watch->read;
+  size_t a_line, b_line;
+  Map staging;
+  FILE *file;
+  int valid;
+
+  if (RCA_IsSameMapText(a, a->records[loaded], RCA_FindMapSubtreeEnd(a, loaded), b, b->records[read], RCA_FindMapSubtreeEnd(b, read)))
+	return 1;
+
+  /* the same node, one of its children changed (a node always has records after it) */
+  a_line = a->records[loaded] + strspn(a->text + a->records[loaded], " \t");
+  b_line = b->records[read] + strspn(b->text + b->records[read], " \t");
+  if (*slot != NULL && RCA_IsMapWord(a->text + a_line, a->text + a->length, "node") &&
+	  RCA_IsSameMapText(a, a->records[loaded], strchr(a->text + a_line, '\n') - a->text,
+						b, b->records[read], strchr(b->text + b_line, '\n') - b->text))
+  {
+	return RCA_StageMapSubtree(watch, map, bsparray, &(*slot)->front, loaded + 1, read + 1, bsparray->nodes[index].front) &&
+	  RCA_StageMapSubtree(watch, map, bsparray, &(*slot)->back, loaded + 1 + a->sizes[loaded + 1],
+						  read + 1 + b->sizes[read + 1], bsparray->nodes[index].back);
+  }
+
+  if (watch->subtree_count == watch->subtree_capacity)
+  {
+	watch->subtree_capacity *= 2;
+	watch->subtrees = realloc(watch->subtrees, watch->subtree_capacity * sizeof(MapSubtree));
+  }
+  watch->subtrees[watch->subtree_count].slot = slot;
+  watch->subtrees[watch->subtree_count].subtree = NULL;
+  watch->subtrees[watch->subtree_count++].index = index;
+
+  /* an empty child stays NULL (the root can't be empty) */
+  if (RCA_IsMapWord(b->text + b_line, b->text + b->length, "empty"))
+	return slot != &map->bsptree;
+
+  staging = *map;
+  staging.bsptree = NULL;
+  file = fmemopen(b->text + b->records[read], RCA_FindMapSubtreeEnd(b, read) - b->records[read], "r");
+  if (file == NULL)
+	return 0;
+  valid = RCA_ReadMapNode(&staging, file, NULL, 0);
+  fclose(file);
+  watch->subtrees[watch->subtree_count - 1].subtree = staging.bsptree;
+
+  return valid;
+}
+
+/**
+ * Swap what a reload staged into the map.
+ * 
+ * @param watch    Pointer to a MapWatch object.
+ * @param map      Pointer to a Map object.
+ * @param bsparray Map compiled (updated, compiled again if needed).
+ * @param minimap  Pointer to a Minimap object holding the sectors of the map in order, or NULL.
+ */
+void RCA_ApplyMapWatch(MapWatch *watch, Map *map, BSParray **bsparray, Minimap *minimap)
+{
+  MapSubtree *staged;
+  Sector *sector, *wall;
+  BSPtree *swap;
+  unsigned int count, saved;
+  int i, resized = 0, depth = 0;
+
+  for (i = 0; i < watch->changed_count; i++)
+  {
+	/* the staged sector gets the old walls and goes away with them */
+	sector = map->sectors[watch->changed[i]];
+	RCA_SwapSectorWalls(sector, watch->staged[i]);
+	if (minimap != NULL)
+	  RCA_UpdateMinimapSector(minimap, watch->changed[i]);
+
+	/* the bounds only grow, like the sectors of the minimap they are only used to skip what is away */
+	for (wall = sector->first->next; wall != NULL; wall = wall->next)
+	{
+	  map->walls++;
+	  map->bounds[0] = fmin(map->bounds[0], fmin(wall->x1, wall->x2));
+	  map->bounds[1] = fmin(map->bounds[1], fmin(wall->y1, wall->y2));
+	  map->bounds[2] = fmax(map->bounds[2], fmax(wall->x1, wall->x2));
+	  map->bounds[3] = fmax(map->bounds[3], fmax(wall->y1, wall->y2));
+	}
+	for (wall = watch->staged[i]->first->next; wall != NULL; wall = wall->next)
+	{
+	  map->walls--;
+	}
+  }
+  watch->sectors_rebuilt = watch->changed_count;
+
+  for (i = 0; i < watch->subtree_count; i++)
+  {
+	staged = &watch->subtrees[i];
+	count = RCA_CountBSPtreeNodes(staged->subtree, &depth, 1);
+	if (!resized && *staged->slot != NULL && count == RCA_CountBSPtreeNodes(*staged->slot, &depth, 1))
+	{
+	  /* the children of the subtree get the same indexes */
+	  saved = (*bsparray)->count;
+	  (*bsparray)->count = staged->index;
+	  RCA_CompileBSPtreeNode(*bsparray, staged->subtree);
+	  (*bsparray)->count = saved;
+	}
+	else
+	{
+	  resized = 1;
+	}
+
+	/* the staged subtree gets the old one and goes away with it */
+	swap = *staged->slot;
+	*staged->slot = staged->subtree;
+	staged->subtree = swap;
+	watch->nodes_rebuilt += count;
+  }
+
+  if (resized)
+  {
+	RCA_DestroyBSParray(*bsparray);
+	*bsparray = RCA_CompileBSPtree(map->bsptree);
+  }
+  else if (watch->subtree_count > 0)
+  {
+	depth = 0;
+	RCA_CountBSPtreeNodes(map->bsptree, &depth, 1);
+	(*bsparray)->depth = depth;
+  }
+
+  RCA_ClearMapWatch(watch);
+}
+
+/**
+ * Reload a map.
+ * 
+ * @param watch    Pointer to a MapWatch object.
+ * @param map      Pointer to a Map object, loaded from the file watched.
+ * @param bsparray Map compiled (updated, compiled again if needed).
+ * @param minimap  Pointer to a Minimap object holding the sectors of the map in order, or NULL.
+ * @return         RCA_HOTRELOAD_DONE, RCA_HOTRELOAD_NONE, RCA_HOTRELOAD_FULL or RCA_HOTRELOAD_FAILED.
+ */
+int RCA_ReloadMap(MapWatch *watch, Map *map, BSParray **bsparray, Minimap *minimap)
+{
+  MapText swap;
+  char *path;
+  FILE *file;
+  int i, valid, outcome = RCA_HOTRELOAD_FULL;
+
+  /* check if we have a valid MapWatch object */
+  RCA_CheckMapWatch(watch);
+  RCA_CheckMap(map);
+
+  watch->sectors_rebuilt = 0;
+  watch->nodes_rebuilt = 0;
+
+  path = malloc(strlen(watch->directory) + strlen(watch->name) + 2);
+  sprintf(path, "%s/%s", watch->directory, watch->name);
+  file = fopen(path, "r");
+  free(path);
+  if (file == NULL)
+	return RCA_HOTRELOAD_FAILED;
+
+  valid = RCA_ReadMapText(&watch->read, file);
+  fclose(file);
+
+  /* sectors added or removed: taken as the map on disk, which the caller loads again */
+  if (valid && watch->read.count == map->count && watch->loaded.count == map->count)
+  {
+	for (i = 0; valid && i < map->count; i++)
+	{
+	  if (!RCA_IsSameMapText(&watch->loaded, watch->loaded.sectors[i][0], watch->loaded.sectors[i][1],
+							 &watch->read, watch->read.sectors[i][0], watch->read.sectors[i][1]))
+		valid = RCA_StageMapSector(watch, i);
+	}
+	valid = valid && RCA_StageMapSubtree(watch, map, *bsparray, &map->bsptree, 0, 0, 0);
+
+	outcome = (watch->changed_count > 0 || watch->subtree_count > 0) ? RCA_HOTRELOAD_DONE : RCA_HOTRELOAD_NONE;
+  }
+
+  if (!valid)
+  {
+	RCA_ClearMapWatch(watch);
+	return RCA_HOTRELOAD_FAILED;
+  }
+
+  if (outcome == RCA_HOTRELOAD_DONE)
+	RCA_ApplyMapWatch(watch, map, bsparray, minimap);
+
+  swap = watch->loaded;
+  watch->loaded = watch->read;
+  watch->read = swap;
+
+  return outcome;
+}
+
+#endif
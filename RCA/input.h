@@ -0,0 +1,136 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Input.  Events only update a bitset of the keys held and the mouse
+ * motion gathered since the last tick; every tick takes a snapshot of
+ * both, so the work per tick doesn't grow with the rate of the events
+ * (a 1000 Hz mouse sends a motion event every millisecond).
+ * 
+ * The time the first event of a tick was polled goes along with the
+ * snapshot, which gives the latency from the event to the frame shown.
+ */
+
+#include <string.h>
+#include "SDL.h"
+
+#include "timer.h"
+
+#ifndef RCA_INPUT_H_
+#define RCA_INPUT_H_
+
+#define RCA_INPUT_UP (1<<0)
+#define RCA_INPUT_DOWN (1<<1)
+#define RCA_INPUT_RIGHT (1<<2)
+#define RCA_INPUT_LEFT (1<<3)
+#define RCA_INPUT_M (1<<4)
+#define RCA_INPUT_L (1<<5)
+#define RCA_INPUT_SPACE (1<<6)
+#define RCA_INPUT_PAN_UP (1<<7)			/* minimap */
+#define RCA_INPUT_PAN_DOWN (1<<8)
+#define RCA_INPUT_PAN_RIGHT (1<<9)
+#define RCA_INPUT_PAN_LEFT (1<<10)
+#define RCA_INPUT_ZOOM_IN (1<<11)
+#define RCA_INPUT_ZOOM_OUT (1<<12)
+#define RCA_INPUT_SENSITIVITY 0.25		/* rotation per mouse count (in degree) */
+
+/**
+ * Input of one tick.
+ */
+typedef struct {
+  unsigned int keys;			/* RCA_INPUT_* bits */
+  int xrel;						/* mouse motion along x */
+  double time;					/* first event polled (0 if none) */
+} InputTick;
+
+unsigned int RCA_INPUT__KEY_BITS[SDLK_LAST];	/* RCA_INPUT_* bit of every key */
+unsigned int RCA_INPUT__KEYS = 0;
+int RCA_INPUT__XREL = 0;
+double RCA_INPUT__TIME = 0;
+
+/**
+ * Initialize input.
+ * 
+ * Must be called once before any event is polled.
+ */
+void RCA_InitInput(void)
+{
+  memset(RCA_INPUT__KEY_BITS, 0, sizeof(RCA_INPUT__KEY_BITS));
+  RCA_INPUT__KEY_BITS[SDLK_UP] = RCA_INPUT_UP;
+  RCA_INPUT__KEY_BITS[SDLK_DOWN] = RCA_INPUT_DOWN;
+  RCA_INPUT__KEY_BITS[SDLK_RIGHT] = RCA_INPUT_RIGHT;
+  RCA_INPUT__KEY_BITS[SDLK_LEFT] = RCA_INPUT_LEFT;
+  RCA_INPUT__KEY_BITS[SDLK_m] = RCA_INPUT_M;
+  RCA_INPUT__KEY_BITS[SDLK_l] = RCA_INPUT_L;
+  RCA_INPUT__KEY_BITS[SDLK_SPACE] = RCA_INPUT_SPACE;
+  RCA_INPUT__KEY_BITS[SDLK_w] = RCA_INPUT_PAN_UP;
+  RCA_INPUT__KEY_BITS[SDLK_s] = RCA_INPUT_PAN_DOWN;
+  RCA_INPUT__KEY_BITS[SDLK_d] = RCA_INPUT_PAN_RIGHT;
+  RCA_INPUT__KEY_BITS[SDLK_a] = RCA_INPUT_PAN_LEFT;
+  RCA_INPUT__KEY_BITS[SDLK_PAGEUP] = RCA_INPUT_ZOOM_IN;
+  RCA_INPUT__KEY_BITS[SDLK_PAGEDOWN] = RCA_INPUT_ZOOM_OUT;
+}
+
+/**
+ * Poll event related to input.
+ * 
+ * Keys set or clear their bit, the mouse motion adds up.
+ * 
+ * @param event SDL_Event typedef.
+ */
+void RCA_PollInputEvent(SDL_Event *event)
+{
+  switch (event->type)
+  {
+	case SDL_KEYDOWN:
+	  RCA_INPUT__KEYS |= RCA_INPUT__KEY_BITS[event->key.keysym.sym];
+	  break;
+	case SDL_KEYUP:
+	  RCA_INPUT__KEYS &= ~RCA_INPUT__KEY_BITS[event->key.keysym.sym];
+	  break;
+	case SDL_MOUSEMOTION:
+	  RCA_INPUT__XREL += event->motion.xrel;
+	  break;
+	default:
+	  return;
+  }
+
+  if (RCA_INPUT__TIME == 0)
+	RCA_INPUT__TIME = RCA_GetTime();
+}
+
+/**
+ * Take a snapshot of the input.
+ * 
+ * The mouse motion and the time start over for the next tick.
+ * 
+ * @param tick Input of the tick (output).
+ */
+void RCA_SnapshotInput(InputTick *tick)
+{
+  tick->keys = RCA_INPUT__KEYS;
+  tick->xrel = RCA_INPUT__XREL;
+  tick->time = RCA_INPUT__TIME;
+
+  RCA_INPUT__XREL = 0;
+  RCA_INPUT__TIME = 0;
+}
+
+/**
+ * Get latency of a tick.
+ * 
+ * To be called once the frame showing the tick is presented.
+ * 
+ * @param tick Input of the tick.
+ * @return     Time since the first event of the tick (in second) or -1 (no event).
+ */
+double RCA_GetInputLatency(InputTick *tick)
+{
+  if (tick->time == 0)
+	return -1;
+
+  return RCA_GetTime() - tick->time;
+}
+
+#endif
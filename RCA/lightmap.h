@@ -0,0 +1,149 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Baked light (see lightbake.c).  Every wall can carry a light map: the
+ * light along the wall, then the light of the floor at its base, one
+ * sample (a luxel) every RCA_LIGHTMAP_LUXEL of its length.  Drawing a
+ * wall looks up the luxel it was hit at instead of the light of its
+ * sector, nothing is computed per pixel.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "arena.h"
+#include "sector.h"
+
+#ifndef RCA_LIGHTMAP_H_
+#define RCA_LIGHTMAP_H_
+
+#define RCA_LIGHTMAP_LUXEL 16			/* length of wall per luxel */
+#define RCA_LIGHTMAP_MAX_LUXELS 32		/* longer walls get longer luxels */
+
+/**
+ * Point light, only used to bake the light maps.
+ */
+typedef struct {
+  double x;
+  double y;
+  int light;					/* added at the lamp (0 to 255) */
+  double radius;				/* nothing added past it */
+} Lamp;
+
+/**
+ * Count luxels of a wall.
+ * 
+ * @param wall Pointer to a Sector object (a wall).
+ * @return     Number of luxels along the wall.
+ */
+int RCA_CountLuxels(Sector *wall)
+{
+  double length = sqrt((wall->x2 - wall->x1) * (wall->x2 - wall->x1) + (wall->y2 - wall->y1) * (wall->y2 - wall->y1));
+  int luxels = (int)ceil(length / RCA_LIGHTMAP_LUXEL);
+
+  if (luxels < 1)
+	return 1;
+  if (luxels > RCA_LIGHTMAP_MAX_LUXELS)
+	return RCA_LIGHTMAP_MAX_LUXELS;
+
+  return luxels;
+}
+
+/**
+ * Find the centre of a luxel.
+ * 
+ * @param wall  Pointer to a Sector object (a wall).
+ * @param luxel Luxel of the wall.
+ * @param point Centre of the luxel (output).
+ */
+void RCA_FindLuxelCenter(Sector *wall, int luxel, double point[2])
+{
+  double t = (luxel + 0.5) / RCA_CountLuxels(wall);
+
+  point[0] = wall->x1 + (wall->x2 - wall->x1) * t;
+  point[1] = wall->y1 + (wall->y2 - wall->y1) * t;
+}
+
+/**
+ * Set light map of a wall.
+ * 
+ * Allocated like the wall (from the level arena when it is set).
+ * 
+ * @param wall        Pointer to a Sector object (a wall).
+ * @param wall_light  Light along the wall (RCA_CountLuxels of them).
+ * @param floor_light Light of the floor at the base of the wall (as many).
+ */
+void RCA_SetWallLightmap(Sector *wall, unsigned char *wall_light, unsigned char *floor_light)
+{
+  int luxels = RCA_CountLuxels(wall);
+
+  /* check if we have a valid Sector object */
+  RCA_CheckSector(wall);
+
+  if (wall->lightmap == NULL)
+	wall->lightmap = RCA_AllocateLevel(2 * luxels);
+
+  memcpy(wall->lightmap, wall_light, luxels);
+  memcpy(wall->lightmap + luxels, floor_light, luxels);
+  wall->luxels = luxels;
+}
+
+/**
+ * Find luxel of a hit.
+ * 
+ * @param wall Pointer to a Sector object (a wall with a light map).
+ * @param x    Hit on the wall.
+ * @param y    Hit on the wall.
+ * @return     Luxel of the hit.
+ */
+int RCA_FindLuxel(Sector *wall, double x, double y)
+{
+  double dx = wall->x2 - wall->x1, dy = wall->y2 - wall->y1;
+  double length2 = dx * dx + dy * dy;
+  int luxel = (length2 > 0) ? (int)(((x - wall->x1) * dx + (y - wall->y1) * dy) / length2 * wall->luxels) : 0;
+
+  if (luxel < 0)
+	return 0;
+  if (luxel > wall->luxels - 1)
+	return wall->luxels - 1;
+
+  return luxel;
+}
+
+/**
+ * Sample light of a wall.
+ * 
+ * @param wall   Pointer to a Sector object (a wall).
+ * @param sector Pointer to a Sector object (the wall's).
+ * @param x      Hit on the wall.
+ * @param y      Hit on the wall.
+ * @return       Baked light at the hit, or the light of the sector without a light map.
+ */
+int RCA_SampleWallLight(Sector *wall, Sector *sector, double x, double y)
+{
+  if (wall->lightmap == NULL)
+	return sector->light;
+
+  return wall->lightmap[RCA_FindLuxel(wall, x, y)];
+}
+
+/**
+ * Sample light of the floor at the base of a wall.
+ * 
+ * @param wall   Pointer to a Sector object (a wall).
+ * @param sector Pointer to a Sector object (the wall's).
+ * @param x      Hit on the wall.
+ * @param y      Hit on the wall.
+ * @return       Baked light at the hit, or the light of the sector without a light map.
+ */
+int RCA_SampleFloorLight(Sector *wall, Sector *sector, double x, double y)
+{
+  if (wall->lightmap == NULL)
+	return sector->light;
+
+  return wall->lightmap[wall->luxels + RCA_FindLuxel(wall, x, y)];
+}
+
+#endif
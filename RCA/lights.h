@@ -0,0 +1,444 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Dynamic point lights (torches, flashes).  Every frame the lights are
+ * binned into a grid over the level, each cell keeping at most
+ * RCA_LIGHTS_PER_CELL of them (the strongest in the cell).  A slice only
+ * adds the lights of the cell it is hit in, so hundreds of lights cost
+ * no more per slice than a few.  They are added to the light of the
+ * sector (or the light map), nothing is cast: they go through walls.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "element.h"
+
+#ifndef RCA_LIGHTS_H_
+#define RCA_LIGHTS_H_
+
+#define RCA_LIGHTS_TYPE (1<<12)			/* dynamic type checking */
+#define RCA_LIGHTS_CELL 64				/* size of a cell of the grid */
+#define RCA_LIGHTS_PER_CELL 8			/* lights added per slice at most */
+
+/**
+ * LightList class.
+ */
+typedef struct {
+  unsigned int type;
+  int count;
+  int capacity;
+  double *x;
+  double *y;
+  int *light;					/* added at the light (0 to 255) */
+  double *radius;				/* nothing added past it */
+  Element **carrier;			/* followed when binned, or NULL */
+  int *ticks;					/* left to live (0 for ever) */
+  double origin[2];				/* corner of the grid */
+  int columns;
+  int rows;
+  int *cells;					/* RCA_LIGHTS_PER_CELL lights per cell */
+  float *weights;				/* light of each of them in the cell, at most */
+  int *counts;					/* lights in each cell */
+} LightList;
+
+LightList *RCA_LIGHTS__ACTIVE = NULL;	/* added when drawing, or NULL */
+
+/**
+ * Constructor.
+ * 
+ * @param lights   Pointer to a LightList object.
+ * @param capacity Maximum number of lights.
+ */
+void RCA_ConstructLightList(LightList *lights, int capacity)
+{
+  /* here OR the RCA_LIGHTS_TYPE constant into the type */
+  lights->type |= RCA_LIGHTS_TYPE;
+
+  lights->count = 0;
+  lights->capacity = capacity;
+  lights->x = malloc(capacity * sizeof(double));
+  lights->y = malloc(capacity * sizeof(double));
+  lights->light = malloc(capacity * sizeof(int));
+  lights->radius = malloc(capacity * sizeof(double));
+  lights->carrier = malloc(capacity * sizeof(Element *));
+  lights->ticks = malloc(capacity * sizeof(int));
+  lights->origin[0] = lights->origin[1] = 0;
+  lights->columns = lights->rows = 0;
+  lights->cells = NULL;
+  lights->weights = NULL;
+  lights->counts = NULL;
+}
+
+/**
+ * New.
+ * 
+ * @param capacity Maximum number of lights.
+ * @return         An object LightList.
+ */
+LightList *RCA_NewLightList(int capacity)
+{
+  LightList *lights = malloc(sizeof(LightList));
+  lights->type = RCA_LIGHTS_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructLightList(lights, capacity);
+
+  return lights;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param lights Pointer to a LightList object.
+ */
+void RCA_CheckLightList(LightList *lights)
+{
+  /* check if we have a valid LightList object */
+  if (lights == NULL ||
+	  !(lights->type & RCA_LIGHTS_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param lights Pointer to a LightList object.
+ */
+void RCA_DestroyLightList(LightList *lights)
+{
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  if (RCA_LIGHTS__ACTIVE == lights)
+	RCA_LIGHTS__ACTIVE = NULL;
+
+  /* set type to 0 indicate this is no longer a LightList object */
+  lights->type = 0;
+
+  /* free the memory allocated for the object */
+  free(lights->x);
+  free(lights->y);
+  free(lights->light);
+  free(lights->radius);
+  free(lights->carrier);
+  free(lights->ticks);
+  free(lights->cells);
+  free(lights->weights);
+  free(lights->counts);
+  free(lights);
+}
+
+/**
+ * Clear light list.
+ * 
+ * Must be called before the carriers go away.
+ * 
+ * @param lights Pointer to a LightList object.
+ */
+void RCA_ClearLightList(LightList *lights)
+{
+  int i;
+
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  lights->count = 0;
+  for (i = 0; i < lights->columns * lights->rows; i++)
+  {
+	lights->counts[i] = 0;
+  }
+}
+
+/**
+ * Set the area covered by the grid.
+ * 
+ * Lights outside of it are never added.
+ * 
+ * @param lights Pointer to a LightList object.
+ * @param x1     One corner of the level.
+ * @param y1     One corner of the level.
+ * @param x2     Other corner of the level.
+ * @param y2     Other corner of the level.
+ */
+void RCA_SetLightGrid(LightList *lights, double x1, double y1, double x2, double y2)
+{
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  lights->origin[0] = fmin(x1, x2);
+  lights->origin[1] = fmin(y1, y2);
+  lights->columns = (int)ceil(fabs(x2 - x1) / RCA_LIGHTS_CELL) + 1;
+  lights->rows = (int)ceil(fabs(y2 - y1) / RCA_LIGHTS_CELL) + 1;
+
+  free(lights->cells);
+  free(lights->weights);
+  free(lights->counts);
+  lights->cells = malloc(lights->columns * lights->rows * RCA_LIGHTS_PER_CELL * sizeof(int));
+  lights->weights = malloc(lights->columns * lights->rows * RCA_LIGHTS_PER_CELL * sizeof(float));
+  lights->counts = calloc(lights->columns * lights->rows, sizeof(int));
+}
+
+/**
+ * Add a light to the list.
+ * 
+ * @param lights Pointer to a LightList object.
+ * @param x      Coordinate of the light.
+ * @param y      Coordinate of the light.
+ * @param light  Light added at the light (0 to 255).
+ * @param radius Nothing added past it.
+ * @param ticks  Ticks the light lives (0 for ever).
+ * @return       Index of the light, or -1 if the list is full.
+ */
+int RCA_AddLightToList(LightList *lights, double x, double y, int light, double radius, int ticks)
+{
+  int index;
+
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  if (lights->count == lights->capacity)
+	return -1;
+
+  index = lights->count++;
+  lights->x[index] = x;
+  lights->y[index] = y;
+  lights->light[index] = light;
+  lights->radius[index] = radius;
+  lights->carrier[index] = NULL;
+  lights->ticks[index] = ticks;
+
+  return index;
+}
+
+/**
+ * Have an element carry a light.
+ * 
+ * @param lights  Pointer to a LightList object.
+ * @param index   Index of the light.
+ * @param carrier Pointer to an Element object (or NULL to leave the light where it is).
+ */
+void RCA_AttachLight(LightList *lights, int index, Element *carrier)
+{
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  lights->carrier[index] = carrier;
+}
+
+/**
+ * Find a light carried by an element.
+ * 
+ * @param lights  Pointer to a LightList object.
+ * @param carrier Pointer to an Element object.
+ * @return        Index of the light, or -1 if the element carries none.
+ */
+int RCA_FindCarriedLight(LightList *lights, Element *carrier)
+{
+  int i;
+
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  for (i = 0; i < lights->count; i++)
+  {
+	if (lights->carrier[i] == carrier)
+	  return i;
+  }
+
+  return -1;
+}
+
+/**
+ * Remove a light from the list.
+ * 
+ * The last light takes its index.
+ * 
+ * @param lights Pointer to a LightList object.
+ * @param index  Index of the light.
+ */
+void RCA_RemoveLightFromList(LightList *lights, int index)
+{
+  int last;
+
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  last = --lights->count;
+  lights->x[index] = lights->x[last];
+  lights->y[index] = lights->y[last];
+  lights->light[index] = lights->light[last];
+  lights->radius[index] = lights->radius[last];
+  lights->carrier[index] = lights->carrier[last];
+  lights->ticks[index] = lights->ticks[last];
+}
+
+/**
+ * Update lights (one tick).
+ * 
+ * The lights which are done living are removed.
+ * 
+ * @param lights Pointer to a LightList object.
+ */
+void RCA_UpdateLights(LightList *lights)
+{
+  int i;
+
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  for (i = lights->count - 1; i >= 0; i--)
+  {
+	if (lights->ticks[i] > 0 && --lights->ticks[i] == 0)
+	  RCA_RemoveLightFromList(lights, i);
+  }
+}
+
+/**
+ * Add a light to a cell of the grid.
+ * 
+ * A full cell keeps its strongest lights.
+ * 
+ * @param lights Pointer to a LightList object.
+ * @param cell   Index of the cell.
+ * @param index  Index of the light.
+ * @param weight Most light it can add in the cell.
+ */
+void RCA_AddLightToCell(LightList *lights, int cell, int index, float weight)
+{
+  int *items = &lights->cells[cell * RCA_LIGHTS_PER_CELL];
+  float *weights = &lights->weights[cell * RCA_LIGHTS_PER_CELL];
+  int k, weakest = 0;
+
+  if (lights->counts[cell] < RCA_LIGHTS_PER_CELL)
+  {
+	k = lights->counts[cell]++;
+	items[k] = index;
+	weights[k] = weight;
+	return;
+  }
+
+  for (k = 1; k < RCA_LIGHTS_PER_CELL; k++)
+  {
+	if (weights[k] < weights[weakest])
+	  weakest = k;
+  }
+  if (weight > weights[weakest])
+  {
+	items[weakest] = index;
+	weights[weakest] = weight;
+  }
+}
+
+/**
+ * Bin lights into the grid (once per frame, before drawing).
+ * 
+ * The carried lights are moved to their carrier first.
+ * 
+ * @param lights Pointer to a LightList object.
+ */
+void RCA_BinLights(LightList *lights)
+{
+  int i, column, row, first[2], last[2];
+  double x1, y1, dx, dy, distance;
+
+  /* check if we have a valid LightList object */
+  RCA_CheckLightList(lights);
+
+  for (i = 0; i < lights->columns * lights->rows; i++)
+  {
+	lights->counts[i] = 0;
+  }
+
+  for (i = 0; i < lights->count; i++)
+  {
+	if (lights->carrier[i] != NULL)
+	{
+	  lights->x[i] = lights->carrier[i]->x;
+	  lights->y[i] = lights->carrier[i]->y;
+	}
+
+	/* cells overlapped by the box of the light, clipped to the grid */
+	first[0] = (int)floor((lights->x[i] - lights->radius[i] - lights->origin[0]) / RCA_LIGHTS_CELL);
+	first[1] = (int)floor((lights->y[i] - lights->radius[i] - lights->origin[1]) / RCA_LIGHTS_CELL);
+	last[0] = (int)floor((lights->x[i] + lights->radius[i] - lights->origin[0]) / RCA_LIGHTS_CELL);
+	last[1] = (int)floor((lights->y[i] + lights->radius[i] - lights->origin[1]) / RCA_LIGHTS_CELL);
+	if (first[0] < 0) first[0] = 0;
+	if (first[1] < 0) first[1] = 0;
+	if (last[0] > lights->columns - 1) last[0] = lights->columns - 1;
+	if (last[1] > lights->rows - 1) last[1] = lights->rows - 1;
+
+	for (row = first[1]; row <= last[1]; row++)
+	{
+	  for (column = first[0]; column <= last[0]; column++)
+	  {
+		/* nearest point of the cell */
+		x1 = lights->origin[0] + column * RCA_LIGHTS_CELL;
+		y1 = lights->origin[1] + row * RCA_LIGHTS_CELL;
+		dx = fmax(0, fmax(x1 - lights->x[i], lights->x[i] - (x1 + RCA_LIGHTS_CELL)));
+		dy = fmax(0, fmax(y1 - lights->y[i], lights->y[i] - (y1 + RCA_LIGHTS_CELL)));
+		distance = sqrt(dx * dx + dy * dy);
+
+		if (distance < lights->radius[i])
+		  RCA_AddLightToCell(lights, row * lights->columns + column, i, lights->light[i] * (1 - distance / lights->radius[i]));
+	  }
+	}
+  }
+}
+
+/**
+ * Sample the dynamic lights at a point.
+ * 
+ * Only the lights of the cell of the point are added.
+ * 
+ * @param x Coordinate of the point.
+ * @param y Coordinate of the point.
+ * @return  Light added at the point (0 without active lights).
+ */
+int RCA_SampleDynamicLight(double x, double y)
+{
+  LightList *lights = RCA_LIGHTS__ACTIVE;
+  int column, row, cell, k, index;
+  double dx, dy, distance2, added = 0;
+
+  if (lights == NULL || lights->count == 0)
+	return 0;
+
+  column = (int)floor((x - lights->origin[0]) / RCA_LIGHTS_CELL);
+  row = (int)floor((y - lights->origin[1]) / RCA_LIGHTS_CELL);
+  if (column < 0 || row < 0 || column >= lights->columns || row >= lights->rows)
+	return 0;
+
+  cell = row * lights->columns + column;
+  for (k = 0; k < lights->counts[cell]; k++)
+  {
+	index = lights->cells[cell * RCA_LIGHTS_PER_CELL + k];
+	dx = x - lights->x[index];
+	dy = y - lights->y[index];
+	distance2 = dx * dx + dy * dy;
+	if (distance2 < lights->radius[index] * lights->radius[index])
+	  added += lights->light[index] * (1 - sqrt(distance2) / lights->radius[index]);
+  }
+
+  return (int)added;
+}
+
+/**
+ * Set the lights added when drawing.
+ * 
+ * @param lights Pointer to a LightList object (binned), or NULL.
+ */
+void RCA_SetActiveLights(LightList *lights)
+{
+  RCA_LIGHTS__ACTIVE = lights;
+}
+
+#endif
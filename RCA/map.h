@@ -0,0 +1,452 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Map loaded from a text file (see mapgen.c), instead of a level built
+ * in the code.  The geometry is allocated like any other, so from the
+ * level arena when one is set.
+ * 
+ * File format: one record per line, # starts a comment.
+ * 
+ *   sector                     (a new sector, numbered from 0)
+ *   light L                    (light of the last sector)
+ *   wall x1 y1 x2 y2 floor ceiling floor_slope ceiling_slope bottom middle top
+ *                              (a wall of the last sector, colours in RRGGBBAA hex)
+ *   lightmap LLLL...           (light map of the last wall, RCA_CountLuxels bytes of the
+ *                              wall then as many of the floor, in hex, see lightbake.c)
+ *   lamp x y light radius      (a point light, for baking)
+ *   player x y direction       (start of the player, direction in degree)
+ *   tree                       (followed by the BSP tree, in preorder)
+ *   node x1 y1 x2 y2           (followed by its front then its back)
+ *   leaf s                     (sector s)
+ *   empty                      (no child)
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bam.h"
+#include "bsptree.h"
+#include "lightmap.h"
+#include "sector.h"
+
+#ifndef RCA_MAP_H_
+#define RCA_MAP_H_
+
+#define RCA_MAP_TYPE (1<<11)			/* dynamic type checking */
+#define RCA_MAP_LINE 256				/* longest record */
+
+/**
+ * Map class.
+ */
+typedef struct {
+  unsigned int type;
+  int count;
+  int capacity;
+  int walls;
+  Sector **sectors;
+  BSPtree *bsptree;
+  Lamp *lamps;
+  int lamp_count;
+  int lamp_capacity;
+  double x;						/* start of the player */
+  double y;
+  Angle direction;
+  double bounds[4];				/* bounding box of every wall */
+} Map;
+
+/**
+ * Constructor.
+ * 
+ * @param map      Pointer to a Map object.
+ * @param capacity Number of sectors expected (grows as needed).
+ */
+void RCA_ConstructMap(Map *map, int capacity)
+{
+  /* here OR the RCA_MAP_TYPE constant into the type */
+  map->type |= RCA_MAP_TYPE;
+
+  map->count = 0;
+  map->capacity = capacity;
+  map->walls = 0;
+  map->sectors = malloc(capacity * sizeof(Sector *));
+  map->bsptree = NULL;
+  map->lamps = malloc(16 * sizeof(Lamp));
+  map->lamp_count = 0;
+  map->lamp_capacity = 16;
+  map->x = 0;
+  map->y = 0;
+  map->direction = 0;
+  map->bounds[0] = map->bounds[1] = HUGE_VAL;
+  map->bounds[2] = map->bounds[3] = -HUGE_VAL;
+}
+
+/**
+ * New.
+ * 
+ * @param capacity Number of sectors expected (grows as needed).
+ * @return         An object Map.
+ */
+Map *RCA_NewMap(int capacity)
+{
+  Map *map = malloc(sizeof(Map));
+  map->type = RCA_MAP_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructMap(map, capacity);
+
+  return map;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param map Pointer to a Map object.
+ */
+void RCA_CheckMap(Map *map)
+{
+  /* check if we have a valid Map object */
+  if (map == NULL ||
+	  !(map->type & RCA_MAP_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * Must be called before the level arena of the geometry is reset.
+ * 
+ * @param map Pointer to a Map object.
+ */
+void RCA_DestroyMap(Map *map)
+{
+  int i;
+
+  /* check if we have a valid Map object */
+  RCA_CheckMap(map);
+
+  /* set type to 0 indicate this is no longer a Map object */
+  map->type = 0;
+
+  /* free the memory allocated for the object (geometry from the level arena goes away with it) */
+  for (i = 0; i < map->count; i++)
+  {
+	RCA_DestroySector(map->sectors[i]);
+  }
+  if (map->bsptree != NULL)
+	RCA_DestroyBSPtree(map->bsptree);
+  free(map->sectors);
+  free(map->lamps);
+  free(map);
+}
+
+/**
+ * Add a new sector to the map.
+ * 
+ * @param map Pointer to a Map object.
+ * @return    Pointer to the Sector object added.
+ */
+Sector *RCA_AddSectorToMap(Map *map)
+{
+  /* check if we have a valid Map object */
+  RCA_CheckMap(map);
+
+  if (map->count == map->capacity)
+  {
+	map->capacity *= 2;
+	map->sectors = realloc(map->sectors, map->capacity * sizeof(Sector *));
+  }
+
+  map->sectors[map->count] = RCA_NewSector();
+
+  return map->sectors[map->count++];
+}
+
+/**
+ * Add a lamp to the map.
+ * 
+ * @param map    Pointer to a Map object.
+ * @param x      Coordinate of the lamp.
+ * @param y      Coordinate of the lamp.
+ * @param light  Light added at the lamp (0 to 255).
+ * @param radius Distance at which nothing is added anymore.
+ */
+void RCA_AddLampToMap(Map *map, double x, double y, int light, double radius)
+{
+  /* check if we have a valid Map object */
+  RCA_CheckMap(map);
+
+  if (map->lamp_count == map->lamp_capacity)
+  {
+	map->lamp_capacity *= 2;
+	map->lamps = realloc(map->lamps, map->lamp_capacity * sizeof(Lamp));
+  }
+
+  map->lamps[map->lamp_count].x = x;
+  map->lamps[map->lamp_count].y = y;
+  map->lamps[map->lamp_count].light = light;
+  map->lamps[map->lamp_count].radius = radius;
+  map->lamp_count++;
+}
+
+/**
+ * Read a light map.
+ * 
+ * @param wall Pointer to a Sector object (a wall).
+ * @param hex  Light map in hex (4 digits per luxel).
+ * @return     True (1) if the light map fits the wall, false (0) otherwise.
+ */
+int RCA_ReadMapLightmap(Sector *wall, const char *hex)
+{
+  unsigned char light[2 * RCA_LIGHTMAP_MAX_LUXELS];
+  int luxels = RCA_CountLuxels(wall);
+  unsigned int value;
+  int i;
+
+  if (strlen(hex) != (size_t)(4 * luxels))
+	return 0;
+
+  for (i = 0; i < 2 * luxels; i++)
+  {
+	if (sscanf(hex + 2 * i, "%2x", &value) != 1)
+	  return 0;
+	light[i] = value;
+  }
+
+  RCA_SetWallLightmap(wall, light, light + luxels);
+
+  return 1;
+}
+
+/**
+ * Read a record of a sector (wall, light or lightmap).
+ * 
+ * @param sector Pointer to a Sector object (the master).
+ * @param line   Record.
+ * @return       True (1) if the record was read, false (0) if it is not one of a sector or is wrong.
+ */
+int RCA_ReadMapSectorRecord(Sector *sector, const char *line)
+{
+  unsigned int colors[3];
+  int bottom[4], middle[4], top[4];
+  char hex[RCA_MAP_LINE];
+  double x1, y1, x2, y2, floor, ceiling, floor_slope, ceiling_slope;
+  int light;
+
+  if (sscanf(line, " wall %lf %lf %lf %lf %lf %lf %lf %lf %x %x %x", &x1, &y1, &x2, &y2, &floor, &ceiling,
+			 &floor_slope, &ceiling_slope, &colors[0], &colors[1], &colors[2]) == 11)
+  {
+	bottom[0] = colors[0] >> 24; bottom[1] = (colors[0] >> 16) & 0xff; bottom[2] = (colors[0] >> 8) & 0xff; bottom[3] = colors[0] & 0xff;
+	middle[0] = colors[1] >> 24; middle[1] = (colors[1] >> 16) & 0xff; middle[2] = (colors[1] >> 8) & 0xff; middle[3] = colors[1] & 0xff;
+	top[0] = colors[2] >> 24; top[1] = (colors[2] >> 16) & 0xff; top[2] = (colors[2] >> 8) & 0xff; top[3] = colors[2] & 0xff;
+	RCA_AddWallToSector(sector, x1, y1, x2, y2, floor, ceiling, floor_slope, ceiling_slope, bottom, middle, top);
+
+	return 1;
+  }
+
+  if (sscanf(line, " light %d", &light) == 1)
+  {
+	RCA_SetSectorLight(sector, light);
+
+	return 1;
+  }
+
+  if (sscanf(line, " lightmap %s", hex) == 1)
+	return sector->current != sector && RCA_ReadMapLightmap(sector->current, hex);
+
+  return 0;
+}
+
+/**
+ * Find the number of walls and the bounding box of a map.
+ * 
+ * @param map Pointer to a Map object.
+ */
+void RCA_FindMapBounds(Map *map)
+{
+  Sector *wall;
+  int i;
+
+  map->walls = 0;
+  map->bounds[0] = map->bounds[1] = HUGE_VAL;
+  map->bounds[2] = map->bounds[3] = -HUGE_VAL;
+
+  for (i = 0; i < map->count; i++)
+  {
+	for (wall = map->sectors[i]->first->next; wall != NULL; wall = wall->next)
+	{
+	  map->walls++;
+	  map->bounds[0] = fmin(map->bounds[0], fmin(wall->x1, wall->x2));
+	  map->bounds[1] = fmin(map->bounds[1], fmin(wall->y1, wall->y2));
+	  map->bounds[2] = fmax(map->bounds[2], fmax(wall->x1, wall->x2));
+	  map->bounds[3] = fmax(map->bounds[3], fmax(wall->y1, wall->y2));
+	}
+  }
+}
+
+/**
+ * Read the next record.
+ * 
+ * Blank lines and comments are skipped, the spaces at the end of the
+ * line are removed.
+ * 
+ * @param file File of the map.
+ * @param line Record read (RCA_MAP_LINE characters).
+ * @return     True (1) if a record was read, false (0) at the end of the file.
+ */
+int RCA_ReadMapRecord(FILE *file, char *line)
+{
+  char *comment;
+  size_t length;
+
+  while (fgets(line, RCA_MAP_LINE, file) != NULL)
+  {
+	comment = strchr(line, '#');
+	if (comment != NULL)
+	  *comment = '\0';
+	length = strlen(line);
+	while (length > 0 && strchr(" \t\r\n", line[length - 1]) != NULL)
+	  line[--length] = '\0';
+
+	if (line[strspn(line, " \t")] != '\0')
+	  return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * Read a node of the BSP tree and everything below it.
+ * 
+ * @param map    Pointer to a Map object.
+ * @param file   File of the map.
+ * @param parent Node the record is a child of (NULL for the root).
+ * @param front  Front (1) or back (0) child of the parent.
+ * @return       True (1) if the subtree was read, false (0) otherwise.
+ */
+int RCA_ReadMapNode(Map *map, FILE *file, BSPtree *parent, int front)
+{
+  char line[RCA_MAP_LINE];
+  double x1, y1, x2, y2;
+  BSPtree *node;
+  int s;
+
+  if (!RCA_ReadMapRecord(file, line))
+	return 0;
+
+  if (sscanf(line, " node %lf %lf %lf %lf", &x1, &y1, &x2, &y2) == 4)
+  {
+	if (parent == NULL)
+	{
+	  node = map->bsptree = RCA_NewBSPtree(x1, y1, x2, y2);
+	}
+	else if (front)
+	{
+	  RCA_AddNodeToBSPtreeFront(parent, x1, y1, x2, y2);
+	  node = parent->front;
+	}
+	else
+	{
+	  RCA_AddNodeToBSPtreeBack(parent, x1, y1, x2, y2);
+	  node = parent->back;
+	}
+
+	return RCA_ReadMapNode(map, file, node, 1) && RCA_ReadMapNode(map, file, node, 0);
+  }
+
+  if (sscanf(line, " leaf %d", &s) == 1)
+  {
+	if (s < 0 || s >= map->count)
+	  return 0;
+
+	/* a tree of a single sector */
+	if (parent == NULL)
+	{
+	  map->bsptree = RCA_NewBSPtree(0, 0, 0, 0);
+	  map->bsptree->sector = map->sectors[s];
+	}
+	else if (front)
+	{
+	  RCA_AddLeafToBSPtreeFront(parent, map->sectors[s]);
+	}
+	else
+	{
+	  RCA_AddLeafToBSPtreeBack(parent, map->sectors[s]);
+	}
+
+	return 1;
+  }
+
+  return parent != NULL && strcmp(line + strspn(line, " \t"), "empty") == 0;
+}
+
+/**
+ * Load a map.
+ * 
+ * @param path Path of the map.
+ * @return     An object Map (NULL if the file can't be read or is not a map).
+ */
+Map *RCA_LoadMap(const char *path)
+{
+  char line[RCA_MAP_LINE];
+  double x1, y1, direction, radius;
+  Sector *sector = NULL;
+  int light, valid = 1;
+  FILE *file = fopen(path, "r");
+
+  if (file == NULL)
+	return NULL;
+
+  Map *map = RCA_NewMap(64);
+
+  while (valid && RCA_ReadMapRecord(file, line))
+  {
+	if (sector != NULL && RCA_ReadMapSectorRecord(sector, line))
+	{
+	  /* a wall, the light or a light map of the last sector */
+	}
+	else if (sscanf(line, " lamp %lf %lf %d %lf", &x1, &y1, &light, &radius) == 4)
+	{
+	  RCA_AddLampToMap(map, x1, y1, light, radius);
+	}
+	else if (sscanf(line, " player %lf %lf %lf", &x1, &y1, &direction) == 3)
+	{
+	  map->x = x1;
+	  map->y = y1;
+	  map->direction = RCA_DegreesToBAM(direction);
+	}
+	else if (strcmp(line + strspn(line, " \t"), "sector") == 0)
+	{
+	  sector = RCA_AddSectorToMap(map);
+	}
+	else if (strcmp(line + strspn(line, " \t"), "tree") == 0 && map->bsptree == NULL)
+	{
+	  valid = RCA_ReadMapNode(map, file, NULL, 0);
+	}
+	else
+	{
+	  valid = 0;
+	}
+  }
+  fclose(file);
+
+  /* nothing to draw without a tree */
+  if (!valid || map->bsptree == NULL)
+  {
+	RCA_DestroyMap(map);
+	return NULL;
+  }
+  RCA_FindMapBounds(map);
+
+  return map;
+}
+
+#endif
@@ -0,0 +1,470 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Top down map.  The walls never change from one frame to the other, so
+ * they are rasterised once into offscreen tiles which are then blitted
+ * every frame.  Only the elements are drawn on top.  Tiles are cached
+ * per zoom level, which keeps panning and zooming over large maps cheap;
+ * the cache keeps twice the tiles of the view, so panning back and forth
+ * doesn't rasterise them again.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "element.h"
+#include "sector.h"
+
+#ifndef RCA_MINIMAP_H_
+#define RCA_MINIMAP_H_
+
+#define RCA_MINIMAP_TYPE (1<<5)			/* dynamic type checking */
+#define RCA_MINIMAP_TILE_SIZE 256		/* in pixel */
+#define RCA_MINIMAP_TILE_CACHE 32		/* number of tiles kept at once (at least) */
+#define RCA_MINIMAP_ZOOM_MIN -6
+#define RCA_MINIMAP_ZOOM_MAX 4
+#define RCA_MINIMAP_PAN_STEP 8			/* panned per tick (in pixel) */
+
+typedef struct {
+  int x;
+  int y;
+  int zoom_level;
+  unsigned int generation;		/* 0 for an empty tile */
+  unsigned int last_used;
+  SDL_Surface *surface;
+} MinimapTile;
+
+/**
+ * Minimap class.
+ */
+typedef struct {
+  unsigned int type;
+  int sector_count;
+  int sector_capacity;
+  Sector **sectors;
+  double (*bounds)[4];			/* bounding box of each sector */
+  double pan_x;					/* map coordinate at the top left corner */
+  double pan_y;
+  int zoom_level;				/* scale of 2^zoom_level */
+  unsigned int generation;
+  unsigned int frame;
+  MinimapTile *tile;
+  int tile_count;
+} Minimap;
+
+/**
+ * Grow the tile cache.
+ * 
+ * The new tiles are empty.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ * @param count   Number of tiles kept at once.
+ */
+void RCA_GrowMinimapCache(Minimap *minimap, int count)
+{
+  int i;
+
+  if (count <= minimap->tile_count)
+	return;
+
+  minimap->tile = realloc(minimap->tile, count * sizeof(MinimapTile));
+  for (i = minimap->tile_count; i < count; i++)
+  {
+	minimap->tile[i].x = 0;
+	minimap->tile[i].y = 0;
+	minimap->tile[i].zoom_level = 0;
+	minimap->tile[i].generation = 0;
+	minimap->tile[i].last_used = 0;
+	minimap->tile[i].surface = NULL;
+  }
+  minimap->tile_count = count;
+}
+
+/**
+ * Constructor.
+ * 
+ * @param minimap  Pointer to a Minimap object.
+ * @param capacity Maximum number of sectors.
+ */
+void RCA_ConstructMinimap(Minimap *minimap, int capacity)
+{
+  /* here OR the RCA_MINIMAP_TYPE constant into the type */
+  minimap->type |= RCA_MINIMAP_TYPE;
+
+  minimap->sector_count = 0;
+  minimap->sector_capacity = capacity;
+  minimap->sectors = malloc(capacity * sizeof(Sector *));
+  minimap->bounds = malloc(capacity * sizeof(double[4]));
+  minimap->pan_x = 0;
+  minimap->pan_y = 0;
+  minimap->zoom_level = 0;
+  minimap->generation = 1;
+  minimap->frame = 0;
+  minimap->tile = NULL;
+  minimap->tile_count = 0;
+  RCA_GrowMinimapCache(minimap, RCA_MINIMAP_TILE_CACHE);
+}
+
+/**
+ * New.
+ * 
+ * @param capacity Maximum number of sectors.
+ * @return         An object Minimap.
+ */
+Minimap *RCA_NewMinimap(int capacity)
+{
+  Minimap *minimap = malloc(sizeof(Minimap));
+  minimap->type = RCA_MINIMAP_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructMinimap(minimap, capacity);
+
+  return minimap;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ */
+void RCA_CheckMinimap(Minimap *minimap)
+{
+  /* check if we have a valid Minimap object */
+  if (minimap == NULL ||
+	  !(minimap->type & RCA_MINIMAP_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ */
+void RCA_DestroyMinimap(Minimap *minimap)
+{
+  int i;
+
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+
+  /* set type to 0 indicate this is no longer a Minimap object */
+  minimap->type = 0;
+
+  /* free the memory allocated for the object */
+  for (i = 0; i < minimap->tile_count; i++)
+  {
+	if (minimap->tile[i].surface != NULL)
+	  SDL_FreeSurface(minimap->tile[i].surface);
+  }
+  free(minimap->tile);
+  free(minimap->sectors);
+  free(minimap->bounds);
+  free(minimap);
+}
+
+/**
+ * Find bounding box of sector.
+ * 
+ * @param sector Pointer to a Sector object.
+ * @param bounds Bounding box (x1, y1, x2, y2).
+ */
+void RCA_FindSectorBounds(Sector *sector, double bounds[4])
+{
+  Sector *wall;
+
+  bounds[0] = HUGE_VAL; bounds[1] = HUGE_VAL;
+  bounds[2] = -HUGE_VAL; bounds[3] = -HUGE_VAL;
+
+  for (wall = sector->first->next; wall != NULL; wall = wall->next)
+  {
+	bounds[0] = fmin(bounds[0], fmin(wall->x1, wall->x2));
+	bounds[1] = fmin(bounds[1], fmin(wall->y1, wall->y2));
+	bounds[2] = fmax(bounds[2], fmax(wall->x1, wall->x2));
+	bounds[3] = fmax(bounds[3], fmax(wall->y1, wall->y2));
+  }
+}
+
+/**
+ * Add a sector to the minimap.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ * @param sector  Pointer to a Sector object.
+ */
+void RCA_AddSectorToMinimap(Minimap *minimap, Sector *sector)
+{
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+  RCA_CheckSector(sector);
+
+  if (minimap->sector_count == minimap->sector_capacity)
+  {
+	minimap->sector_capacity *= 2;
+	minimap->sectors = realloc(minimap->sectors, minimap->sector_capacity * sizeof(Sector *));
+	minimap->bounds = realloc(minimap->bounds, minimap->sector_capacity * sizeof(double[4]));
+  }
+
+  minimap->sectors[minimap->sector_count] = sector;
+  RCA_FindSectorBounds(sector, minimap->bounds[minimap->sector_count]);
+  minimap->sector_count++;
+  minimap->generation++;
+}
+
+/**
+ * Update a sector of the minimap, after its walls changed.
+ * 
+ * Only the cached tiles under the sector (before or after the change)
+ * are rasterised again.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ * @param index   Of the sector, in the order it was added.
+ */
+void RCA_UpdateMinimapSector(Minimap *minimap, int index)
+{
+  double bounds[4], scale;
+  int i;
+
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+  assert(index >= 0 && index < minimap->sector_count);
+
+  RCA_FindSectorBounds(minimap->sectors[index], bounds);
+  bounds[0] = fmin(bounds[0], minimap->bounds[index][0]);
+  bounds[1] = fmin(bounds[1], minimap->bounds[index][1]);
+  bounds[2] = fmax(bounds[2], minimap->bounds[index][2]);
+  bounds[3] = fmax(bounds[3], minimap->bounds[index][3]);
+  RCA_FindSectorBounds(minimap->sectors[index], minimap->bounds[index]);
+
+  for (i = 0; i < minimap->tile_count; i++)
+  {
+	/* empty or outdated already */
+	if (minimap->tile[i].generation != minimap->generation)
+	  continue;
+
+	scale = ldexp(1, minimap->tile[i].zoom_level);
+	if (bounds[2] < minimap->tile[i].x * RCA_MINIMAP_TILE_SIZE / scale - 1 ||
+		bounds[0] > (minimap->tile[i].x + 1) * RCA_MINIMAP_TILE_SIZE / scale + 1 ||
+		bounds[3] < minimap->tile[i].y * RCA_MINIMAP_TILE_SIZE / scale - 1 ||
+		bounds[1] > (minimap->tile[i].y + 1) * RCA_MINIMAP_TILE_SIZE / scale + 1)
+	  continue;
+
+	/* an empty tile, drawn again the next time it is needed */
+	minimap->tile[i].generation = 0;
+  }
+}
+
+/**
+ * Remove every sector from the minimap.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ */
+void RCA_ClearMinimap(Minimap *minimap)
+{
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+
+  minimap->sector_count = 0;
+  minimap->generation++;
+}
+
+/**
+ * Pan minimap.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ * @param dx      Displacement (in pixel).
+ * @param dy      Displacement (in pixel).
+ */
+void RCA_PanMinimap(Minimap *minimap, double dx, double dy)
+{
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+
+  minimap->pan_x += dx / ldexp(1, minimap->zoom_level);
+  minimap->pan_y += dy / ldexp(1, minimap->zoom_level);
+}
+
+/**
+ * Zoom minimap.
+ * 
+ * The map coordinate under the given pixel stays in place.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ * @param steps   Zoom in (positive) or out (negative), doubling each step.
+ * @param x       Center of the zoom (in pixel).
+ * @param y       Center of the zoom (in pixel).
+ */
+void RCA_ZoomMinimap(Minimap *minimap, int steps, int x, int y)
+{
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+
+  int zoom_level = minimap->zoom_level + steps;
+
+  if (zoom_level < RCA_MINIMAP_ZOOM_MIN)
+	zoom_level = RCA_MINIMAP_ZOOM_MIN;
+  if (zoom_level > RCA_MINIMAP_ZOOM_MAX)
+	zoom_level = RCA_MINIMAP_ZOOM_MAX;
+
+  double center_x = minimap->pan_x + x / ldexp(1, minimap->zoom_level);
+  double center_y = minimap->pan_y + y / ldexp(1, minimap->zoom_level);
+
+  minimap->zoom_level = zoom_level;
+  minimap->pan_x = center_x - x / ldexp(1, zoom_level);
+  minimap->pan_y = center_y - y / ldexp(1, zoom_level);
+}
+
+/**
+ * Rasterise a tile.
+ * 
+ * @param minimap Pointer to a Minimap object.
+ * @param tile    Tile to draw into.
+ */
+void RCA_DrawMinimapTile(Minimap *minimap, MinimapTile *tile)
+{
+  int i;
+  Sector *wall;
+  double scale = ldexp(1, tile->zoom_level);
+  double x1 = tile->x * RCA_MINIMAP_TILE_SIZE / scale;
+  double y1 = tile->y * RCA_MINIMAP_TILE_SIZE / scale;
+  double x2 = (tile->x + 1) * RCA_MINIMAP_TILE_SIZE / scale;
+  double y2 = (tile->y + 1) * RCA_MINIMAP_TILE_SIZE / scale;
+
+  SDL_FillRect(tile->surface, NULL, SDL_MapRGB(tile->surface->format, 0, 0, 0));
+
+  for (i = 0; i < minimap->sector_count; i++)
+  {
+	/* skip sectors away from the tile */
+	if (minimap->bounds[i][2] < x1 - 1 || minimap->bounds[i][0] > x2 + 1 ||
+		minimap->bounds[i][3] < y1 - 1 || minimap->bounds[i][1] > y2 + 1)
+	  continue;
+
+	for (wall = minimap->sectors[i]->first->next; wall != NULL; wall = wall->next)
+	{
+	  if (fmax(wall->x1, wall->x2) < x1 - 1 || fmin(wall->x1, wall->x2) > x2 + 1 ||
+		  fmax(wall->y1, wall->y2) < y1 - 1 || fmin(wall->y1, wall->y2) > y2 + 1)
+		continue;
+		
+	  lineRGBA(tile->surface, (wall->x1 - x1) * scale, (wall->y1 - y1) * scale, (wall->x2 - x1) * scale, (wall->y2 - y1) * scale,
+			   wall->top_color[0], wall->top_color[1], wall->top_color[2], 255);
+	}
+  }
+}
+
+/**
+ * Find tile in the cache.
+ * 
+ * Rasterise the tile when it is missing (or outdated), reusing the
+ * least recently used one.
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param minimap Pointer to a Minimap object.
+ * @param x       Tile coordinate.
+ * @param y       Tile coordinate.
+ * @return        Tile ready to be blitted.
+ */
+MinimapTile *RCA_FindMinimapTile(SDL_Surface *screen, Minimap *minimap, int x, int y)
+{
+  int i;
+  MinimapTile *tile = &minimap->tile[0];
+
+  for (i = 0; i < minimap->tile_count; i++)
+  {
+	if (minimap->tile[i].generation == minimap->generation && minimap->tile[i].zoom_level == minimap->zoom_level &&
+		minimap->tile[i].x == x && minimap->tile[i].y == y)
+	{
+	  minimap->tile[i].last_used = minimap->frame;
+	  return &minimap->tile[i];
+	}
+	if (minimap->tile[i].last_used < tile->last_used)
+	  tile = &minimap->tile[i];
+  }
+
+  if (tile->surface == NULL)
+  {
+	tile->surface = SDL_CreateRGBSurface(SDL_SWSURFACE, RCA_MINIMAP_TILE_SIZE, RCA_MINIMAP_TILE_SIZE, screen->format->BitsPerPixel,
+										 screen->format->Rmask, screen->format->Gmask, screen->format->Bmask, 0);
+  }
+
+  tile->x = x;
+  tile->y = y;
+  tile->zoom_level = minimap->zoom_level;
+  tile->generation = minimap->generation;
+  tile->last_used = minimap->frame;
+
+  RCA_DrawMinimapTile(minimap, tile);
+
+  return tile;
+}
+
+/**
+ * Draw minimap.
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param minimap Pointer to a Minimap object.
+ */
+void RCA_DrawMinimap(SDL_Surface *screen, Minimap *minimap)
+{
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+
+  int x, y;
+  double scale = ldexp(1, minimap->zoom_level);
+  int origin_x = (int)floor(minimap->pan_x * scale);
+  int origin_y = (int)floor(minimap->pan_y * scale);
+  int first_x = (int)floor((double)origin_x / RCA_MINIMAP_TILE_SIZE);
+  int first_y = (int)floor((double)origin_y / RCA_MINIMAP_TILE_SIZE);
+  int last_x = (int)floor((double)(origin_x + screen->w - 1) / RCA_MINIMAP_TILE_SIZE);
+  int last_y = (int)floor((double)(origin_y + screen->h - 1) / RCA_MINIMAP_TILE_SIZE);
+  MinimapTile *tile;
+  SDL_Rect position;
+
+  minimap->frame++;
+
+  /* every tile of the view must fit, or they would evict each other */
+  RCA_GrowMinimapCache(minimap, 2 * (last_x - first_x + 1) * (last_y - first_y + 1));
+
+  for (y = first_y; y <= last_y; y++)
+  {
+	for (x = first_x; x <= last_x; x++)
+	{
+	  tile = RCA_FindMinimapTile(screen, minimap, x, y);
+
+	  position.x = x * RCA_MINIMAP_TILE_SIZE - origin_x;
+	  position.y = y * RCA_MINIMAP_TILE_SIZE - origin_y;
+	  SDL_BlitSurface(tile->surface, NULL, screen, &position);
+	}
+  }
+}
+
+/**
+ * Draw Element on the minimap.
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param minimap Pointer to a Minimap object.
+ * @param element Pointer to an Element object.
+ */
+void RCA_DrawMinimapElement(SDL_Surface *screen, Minimap *minimap, Element *element)
+{
+  /* check if we have a valid Minimap object */
+  RCA_CheckMinimap(minimap);
+  RCA_CheckElement(element);
+
+  double scale = ldexp(1, minimap->zoom_level);
+  Element marker = *element;
+
+  /* same transformation as the tiles */
+  marker.x = element->x * scale - floor(minimap->pan_x * scale);
+  marker.y = element->y * scale - floor(minimap->pan_y * scale);
+
+  RCA_DrawElement(screen, &marker);
+}
+
+#endif
@@ -0,0 +1,447 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Movers (doors, lifts and sliding walls).  A floor or ceiling mover
+ * changes the heights of the walls of a sector already in the BSP tree,
+ * which only invalidates the cached constants of those walls.  A sliding
+ * wall moves a sector which is not in the BSP tree at all, it is drawn
+ * after the tree and depth tested like the sprites, so nothing is ever
+ * rebuilt while things move.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "colormap.h"
+#include "element.h"
+#include "raycaster.h"
+#include "sector.h"
+
+#ifndef RCA_MOVER_H_
+#define RCA_MOVER_H_
+
+#define RCA_MOVER_TYPE (1<<7)			/* dynamic type checking */
+#define RCA_MOVER_FLOOR 0				/* lifts */
+#define RCA_MOVER_CEILING 1				/* doors */
+#define RCA_MOVER_SLIDE 2				/* sliding walls */
+
+#define RCA_MOVER_STOPPED 0
+#define RCA_MOVER_RAISING 1				/* toward high */
+#define RCA_MOVER_LOWERING 2			/* toward low */
+#define RCA_MOVER_WAITING 3
+
+/**
+ * MoverList class.
+ */
+typedef struct {
+  unsigned int type;
+  int count;
+  int capacity;
+  Sector **sector;				/* master of the walls moved */
+  int *kind;
+  double *low;					/* height (in percent) or distance for a sliding wall */
+  double *high;
+  double *position;
+  double *speed;				/* per tick */
+  double (*direction)[2];		/* unit vector, sliding walls only */
+  int *state;
+  int *delay;					/* ticks waited at the ends (negative to stay at high) */
+  int *wait;
+  int *repeat;
+  double nearest[RCA_RAYCASTER_COLUMNS];		/* scratch of RCA_DrawMovingWalls */
+  Sector *nearest_wall[RCA_RAYCASTER_COLUMNS];
+  int nearest_light[RCA_RAYCASTER_COLUMNS];
+} MoverList;
+
+/**
+ * Constructor.
+ * 
+ * @param movers   Pointer to a MoverList object.
+ * @param capacity Maximum number of movers.
+ */
+void RCA_ConstructMoverList(MoverList *movers, int capacity)
+{
+  /* here OR the RCA_MOVER_TYPE constant into the type */
+  movers->type |= RCA_MOVER_TYPE;
+
+  movers->count = 0;
+  movers->capacity = capacity;
+  movers->sector = malloc(capacity * sizeof(Sector *));
+  movers->kind = malloc(capacity * sizeof(int));
+  movers->low = malloc(capacity * sizeof(double));
+  movers->high = malloc(capacity * sizeof(double));
+  movers->position = malloc(capacity * sizeof(double));
+  movers->speed = malloc(capacity * sizeof(double));
+  movers->direction = malloc(capacity * sizeof(double[2]));
+  movers->state = malloc(capacity * sizeof(int));
+  movers->delay = malloc(capacity * sizeof(int));
+  movers->wait = malloc(capacity * sizeof(int));
+  movers->repeat = malloc(capacity * sizeof(int));
+}
+
+/**
+ * New.
+ * 
+ * @param capacity Maximum number of movers.
+ * @return         An object MoverList.
+ */
+MoverList *RCA_NewMoverList(int capacity)
+{
+  MoverList *movers = malloc(sizeof(MoverList));
+  movers->type = RCA_MOVER_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructMoverList(movers, capacity);
+
+  return movers;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param movers Pointer to a MoverList object.
+ */
+void RCA_CheckMoverList(MoverList *movers)
+{
+  /* check if we have a valid MoverList object */
+  if (movers == NULL ||
+	  !(movers->type & RCA_MOVER_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * The sectors are not destroyed, they belong to the level.
+ * 
+ * @param movers Pointer to a MoverList object.
+ */
+void RCA_DestroyMoverList(MoverList *movers)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+
+  /* set type to 0 indicate this is no longer a MoverList object */
+  movers->type = 0;
+
+  /* free the memory allocated for the object */
+  free(movers->sector);
+  free(movers->kind);
+  free(movers->low);
+  free(movers->high);
+  free(movers->position);
+  free(movers->speed);
+  free(movers->direction);
+  free(movers->state);
+  free(movers->delay);
+  free(movers->wait);
+  free(movers->repeat);
+  free(movers);
+}
+
+/**
+ * Clear mover list.
+ * 
+ * Must be called before the sectors go away (unloading a level).
+ * 
+ * @param movers Pointer to a MoverList object.
+ */
+void RCA_ClearMoverList(MoverList *movers)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+
+  movers->count = 0;
+}
+
+/**
+ * Apply the position of a mover to its walls.
+ * 
+ * @param movers   Pointer to a MoverList object.
+ * @param index    Index of the mover.
+ * @param previous Position before the move (sliding walls move by the difference).
+ */
+void RCA_ApplyMover(MoverList *movers, int index, double previous)
+{
+  Sector *wall;
+  double position = movers->position[index];
+
+  for (wall = movers->sector[index]->first->next; wall != NULL; wall = wall->next)
+  {
+	if (movers->kind[index] == RCA_MOVER_FLOOR)
+	  RCA_SetWallHeights(wall, position, wall->ceiling);
+	else if (movers->kind[index] == RCA_MOVER_CEILING)
+	  RCA_SetWallHeights(wall, wall->floor, position);
+	else
+	  RCA_MoveWall(wall, movers->direction[index][0] * (position - previous), movers->direction[index][1] * (position - previous));
+  }
+}
+
+/**
+ * Add a mover to the list.
+ * 
+ * The mover starts stopped at low, a sliding wall is assumed to be
+ * where it is at low.
+ * 
+ * @param movers Pointer to a MoverList object.
+ * @param sector Sector moved (the master).
+ * @param kind   RCA_MOVER_FLOOR, RCA_MOVER_CEILING or RCA_MOVER_SLIDE.
+ * @param low    Lowest position.
+ * @param high   Highest position.
+ * @param speed  Speed (per tick).
+ * @param delay  Ticks waited at the ends (negative to stay at high).
+ * @return       Index of the mover or -1 if the list is full.
+ */
+int RCA_AddMoverToList(MoverList *movers, Sector *sector, int kind, double low, double high, double speed, int delay)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+  RCA_CheckSector(sector);
+
+  if (movers->count == movers->capacity)
+	return -1;
+
+  int i = movers->count++;
+
+  movers->sector[i] = sector;
+  movers->kind[i] = kind;
+  movers->low[i] = low;
+  movers->high[i] = high;
+  movers->position[i] = low;
+  movers->speed[i] = speed;
+  movers->direction[i][0] = 1; movers->direction[i][1] = 0;
+  movers->state[i] = RCA_MOVER_STOPPED;
+  movers->delay[i] = delay;
+  movers->wait[i] = 0;
+  movers->repeat[i] = 0;
+
+  if (kind != RCA_MOVER_SLIDE)
+	RCA_ApplyMover(movers, i, low);
+
+  return i;
+}
+
+/**
+ * Set direction of a sliding wall.
+ * 
+ * @param movers Pointer to a MoverList object.
+ * @param index  Index of the mover.
+ * @param dx     Direction along x.
+ * @param dy     Direction along y.
+ */
+void RCA_SetMoverDirection(MoverList *movers, int index, double dx, double dy)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+
+  double length = sqrt(dx * dx + dy * dy);
+
+  if (length == 0)
+	return;
+
+  movers->direction[index][0] = dx / length;
+  movers->direction[index][1] = dy / length;
+}
+
+/**
+ * Activate a mover.
+ * 
+ * A stopped mover goes to the other end, a moving one turns back.
+ * 
+ * @param movers Pointer to a MoverList object.
+ * @param index  Index of the mover.
+ * @param repeat Keep going back and forth (true) or stop at low (false).
+ */
+void RCA_ActivateMover(MoverList *movers, int index, int repeat)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+
+  movers->repeat[index] = repeat;
+
+  if (movers->state[index] == RCA_MOVER_RAISING)
+	movers->state[index] = RCA_MOVER_LOWERING;
+  else if (movers->state[index] == RCA_MOVER_LOWERING)
+	movers->state[index] = RCA_MOVER_RAISING;
+  else if (movers->state[index] == RCA_MOVER_STOPPED)
+	movers->state[index] = (movers->position[index] >= movers->high[index]) ? RCA_MOVER_LOWERING : RCA_MOVER_RAISING;
+}
+
+/**
+ * Update movers.
+ * 
+ * Must be called once per tick.
+ * 
+ * @param movers Pointer to a MoverList object.
+ */
+void RCA_UpdateMovers(MoverList *movers)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+
+  int i;
+  double previous;
+
+  for (i = 0; i < movers->count; i++)
+  {
+	previous = movers->position[i];
+
+	switch (movers->state[i])
+	{
+	  case RCA_MOVER_RAISING:
+		movers->position[i] += movers->speed[i];
+		if (movers->position[i] >= movers->high[i])
+		{
+		  movers->position[i] = movers->high[i];
+		  movers->state[i] = (movers->delay[i] < 0) ? RCA_MOVER_STOPPED : RCA_MOVER_WAITING;
+		  movers->wait[i] = movers->delay[i];
+		}
+		break;
+
+	  case RCA_MOVER_LOWERING:
+		movers->position[i] -= movers->speed[i];
+		if (movers->position[i] <= movers->low[i])
+		{
+		  movers->position[i] = movers->low[i];
+		  movers->state[i] = (movers->repeat[i]) ? RCA_MOVER_WAITING : RCA_MOVER_STOPPED;
+		  movers->wait[i] = movers->delay[i];
+		}
+		break;
+
+	  case RCA_MOVER_WAITING:
+		if (--movers->wait[i] <= 0)
+		  movers->state[i] = (movers->position[i] >= movers->high[i]) ? RCA_MOVER_LOWERING : RCA_MOVER_RAISING;
+		break;
+	}
+
+	if (movers->position[i] != previous)
+	  RCA_ApplyMover(movers, i, previous);
+  }
+}
+
+/**
+ * Draw moving walls.
+ * 
+ * Called after the BSP tree is traversed (and before the sprites).  For
+ * every column the nearest sliding wall is kept and drawn if it is in
+ * front of what is in the depth buffer.  Sliding walls have no slope and
+ * do not cast floor or ceiling, the sector they are in already did.
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param movers  Pointer to a MoverList object.
+ * @param element Pointer to an Element object.
+ */
+void RCA_DrawMovingWalls(SDL_Surface *screen, MoverList *movers, Element *element)
+{
+  /* check if we have a valid MoverList object */
+  RCA_CheckMoverList(movers);
+
+  int i, column, first, last, level;
+  int top, bottom, middle_top, middle_bottom;
+  double cosine = RCA_FineCosine(element->direction);
+  double sine = RCA_FineSine(element->direction);
+  double columns_per_degree = (double)RCA_RAYCASTER_COLUMNS / RCA_RAYCASTER_FOV;
+  double forward[2], angle[2], coordinates[4];
+  Angle ray_angle;
+  double distance, height;
+  double *intersection;
+  Sector *wall;
+
+  for (column = 0; column < RCA_RAYCASTER_COLUMNS; column++)
+  {
+	movers->nearest[column] = HUGE_VAL;
+	movers->nearest_wall[column] = NULL;
+  }
+
+  for (i = 0; i < movers->count; i++)
+  {
+	if (movers->kind[i] != RCA_MOVER_SLIDE)
+	  continue;
+
+	for (wall = movers->sector[i]->first->next; wall != NULL; wall = wall->next)
+	{
+	  /* columns covered by the wall */
+	  forward[0] = (wall->x1 - element->x) * cosine + (wall->y1 - element->y) * sine;
+	  forward[1] = (wall->x2 - element->x) * cosine + (wall->y2 - element->y) * sine;
+	  if (forward[0] < 1 && forward[1] < 1)
+		continue;
+
+	  if (forward[0] < 1 || forward[1] < 1)
+	  {
+		first = 0;
+		last = RCA_RAYCASTER_COLUMNS - 1;
+	  }
+	  else
+	  {
+		angle[0] = atan2((wall->y1 - element->y) * cosine - (wall->x1 - element->x) * sine, forward[0]) * 180 / M_PI;
+		angle[1] = atan2((wall->y2 - element->y) * cosine - (wall->x2 - element->x) * sine, forward[1]) * 180 / M_PI;
+		/* one more column on each side for the rounding */
+		first = (int)floor(((RCA_RAYCASTER_FOV / 2) - fmax(angle[0], angle[1])) * columns_per_degree) - 1;
+		last = (int)floor(((RCA_RAYCASTER_FOV / 2) - fmin(angle[0], angle[1])) * columns_per_degree) + 1;
+		if (first < 0)
+		  first = 0;
+		if (last > RCA_RAYCASTER_COLUMNS - 1)
+		  last = RCA_RAYCASTER_COLUMNS - 1;
+	  }
+
+	  coordinates[0] = wall->x1; coordinates[1] = wall->y1;
+	  coordinates[2] = wall->x2; coordinates[3] = wall->y2;
+
+	  for (column = first; column <= last; column++)
+	  {
+		ray_angle = element->direction + RCA_RAYCASTER_HALF_FOV - column * RCA_RAYCASTER_COLUMN_ANGLE;
+		intersection = RCA_FindWallIntersection(element, coordinates, ray_angle);
+
+		if (intersection == NULL ||
+			!RCA_CorrectIntersection(element, intersection[0], intersection[1], ray_angle) ||
+			!RCA_CheckWallLimit(coordinates, intersection[0], intersection[1]))
+		  continue;
+
+		distance = RCA_GettingDistanceToWall(element, intersection, ray_angle) * fabs(RCA_FineCosine(ray_angle - element->direction));
+		if (distance < movers->nearest[column])
+		{
+		  movers->nearest[column] = distance;
+		  movers->nearest_wall[column] = wall;
+		  movers->nearest_light[column] = movers->sector[i]->light + RCA_SampleDynamicLight(intersection[0], intersection[1]);
+		}
+	  }
+	}
+  }
+
+  for (column = 0; column < RCA_RAYCASTER_COLUMNS; column++)
+  {
+	wall = movers->nearest_wall[column];
+	distance = movers->nearest[column];
+	if (wall == NULL || distance >= RCA_RAYCASTER__DEPTH_BUFFER[column])
+	  continue;
+
+	height = RCA_GettingHeightOfWall(distance);
+	top = (screen->h / 2) - (int)(height / 2);
+	bottom = top + (int)height;
+	middle_top = top + (int)floor(wall->ceiling * height / 100);
+	middle_bottom = bottom - (int)floor(wall->floor * height / 100);
+	level = RCA_GetLightLevel(movers->nearest_light[column], distance);
+
+	if (wall->ceiling != 0 && wall->top_color[3] != 0)
+	  RCA_DrawSlice(screen, (RCA_RAYCASTER_COLUMNS - 1 - column) * RCA_RAYCASTER_SLICE_WIDTH, top, middle_top, wall->top_color, level);
+	if (wall->floor != 0 && wall->bottom_color[3] != 0)
+	  RCA_DrawSlice(screen, (RCA_RAYCASTER_COLUMNS - 1 - column) * RCA_RAYCASTER_SLICE_WIDTH, middle_bottom, bottom, wall->bottom_color, level);
+	if (wall->middle_color[3] != 0)
+	{
+	  RCA_DrawSlice(screen, (RCA_RAYCASTER_COLUMNS - 1 - column) * RCA_RAYCASTER_SLICE_WIDTH, middle_top, middle_bottom, wall->middle_color, level);
+	  RCA_RAYCASTER__DEPTH_BUFFER[column] = distance;
+	}
+  }
+}
+
+#endif
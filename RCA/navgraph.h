@@ -0,0 +1,1185 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Navigation graph.  Every sector is a node, and two sectors are linked
+ * where they share a portal: a wall with an invisible middle found in
+ * both of them.  Paths are found with A*, going from portal to portal.
+ * 
+ * The sectors are also grouped into square regions.  The sectors with a
+ * portal out of their region are entrances, and every pair of entrances
+ * of a region is linked by a shortcut: the shortest path between them
+ * inside the region, found once.  A path across regions is searched over
+ * the entrances (a much smaller graph) then the shortcuts it takes are
+ * searched again inside their region, which is quick.  Within a region,
+ * the path staying inside is taken unless going out of the region and
+ * back is cheaper.
+ * 
+ * Paths found are kept in a cache.  A batch of queries (every agent of a
+ * tick) takes what it can from the cache, searches the rest in parallel,
+ * each path asked more than once only searched once, then fills the
+ * cache.  Floor heights are not looked at: a step or a lift is walkable.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parallel.h"
+#include "sector.h"
+
+#ifndef RCA_NAVGRAPH_H_
+#define RCA_NAVGRAPH_H_
+
+#define RCA_NAVGRAPH_TYPE (1<<13)		/* dynamic type checking */
+#define RCA_NAVGRAPH_REGION 1024		/* size of a region */
+#define RCA_NAVGRAPH_CACHE 16384		/* paths kept (power of two) */
+#define RCA_NAVGRAPH_BLOCK 32			/* queries of a batch searched by the same worker at once */
+#define RCA_NAVGRAPH_SNAP 16			/* portals are matched at 1 / RCA_NAVGRAPH_SNAP of a unit */
+
+/**
+ * Nodes and their edges (sectors or entrances).
+ */
+typedef struct {
+  int count;
+  int *first;					/* edges of node i are first[i] to first[i + 1] - 1 */
+  int *to;
+  double *cost;
+  double (*centers)[2];
+} NavLevel;
+
+/**
+ * Path, from the first node to the last (also a query and a cache entry).
+ */
+typedef struct {
+  int from;
+  int to;
+  int length;					/* nodes in the path, 0 if there is none */
+  int capacity;
+  int *path;
+} NavPath;
+
+/**
+ * Scratch of a search of one level.
+ */
+typedef struct {
+  double *g;					/* cost from the start */
+  int *parent;
+  unsigned int *seen;			/* g and parent are valid if it is the generation */
+  unsigned int *closed;
+  unsigned int generation;
+  int *heap;					/* open nodes (a node can be in more than once) */
+  double *keys;
+  int heap_count;
+  int heap_capacity;
+} NavScratch;
+
+/**
+ * Search of a path (one per worker).
+ */
+typedef struct {
+  NavScratch nodes;
+  NavScratch shortcuts;			/* the last one is the goal */
+  NavPath route;				/* entrances gone through */
+  NavPath leg;					/* path inside a region */
+  double *start_costs;			/* from the start to the entrances of its region */
+  double *goal_costs;			/* from the entrances of its region to the goal */
+  unsigned int *allowed;		/* regions searched have the mark */
+  unsigned int mark;
+} NavSearch;
+
+/**
+ * NavGraph class.
+ */
+typedef struct {
+  unsigned int type;
+  Sector **sectors;				/* of the nodes */
+  int *order;					/* nodes sorted by sector, see RCA_FindNavNode */
+  NavLevel nodes;
+  double (*portals)[2];			/* middle of the portal of every edge of the nodes */
+  int region_count;
+  int *region;					/* of every node */
+  NavLevel shortcuts;			/* entrances, linked by shortcuts and by the portals between regions */
+  int *entrance;				/* of every node, or -1 */
+  int *entrances;				/* node of every entrance, by region */
+  int *region_first;			/* entrances of region r are region_first[r] to region_first[r + 1] - 1 */
+  int most_entrances;			/* in a region */
+  NavPath cache[RCA_NAVGRAPH_CACHE];
+  int hits;
+  int misses;
+  NavSearch searches[RCA_PARALLEL_MAX_THREADS];	/* kept from batch to batch, started when first taken */
+  int taken[RCA_PARALLEL_MAX_THREADS];			/* searches in use by a worker */
+} NavGraph;
+
+NavGraph *RCA_NAVGRAPH__SORTED;	/* graph being sorted by RCA_CompareNavNodes */
+
+/**
+ * Distance between two points.
+ * 
+ * @param a Point.
+ * @param b Point.
+ * @return  Distance.
+ */
+double RCA_FindNavDistance(double a[2], double b[2])
+{
+  return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]));
+}
+
+/**
+ * Build edges of a level from pairs of nodes.
+ * 
+ * @param level      Pointer to a NavLevel (count and centers set).
+ * @param pairs      Nodes linked (from, to).
+ * @param costs      Cost of every pair.
+ * @param pair_count Number of pairs.
+ * @param order      Edge of every pair (output, or NULL).
+ */
+void RCA_BuildNavLevel(NavLevel *level, int (*pairs)[2], double *costs, int pair_count, int *order)
+{
+  int i, edge, *next = calloc(level->count + 1, sizeof(int));
+
+  level->first = calloc(level->count + 1, sizeof(int));
+  level->to = malloc((pair_count > 0 ? pair_count : 1) * sizeof(int));
+  level->cost = malloc((pair_count > 0 ? pair_count : 1) * sizeof(double));
+
+  for (i = 0; i < pair_count; i++)
+  {
+	level->first[pairs[i][0] + 1]++;
+  }
+  for (i = 0; i < level->count; i++)
+  {
+	level->first[i + 1] += level->first[i];
+	next[i] = level->first[i];
+  }
+  for (i = 0; i < pair_count; i++)
+  {
+	edge = next[pairs[i][0]]++;
+	level->to[edge] = pairs[i][1];
+	level->cost[edge] = costs[i];
+	if (order != NULL)
+	  order[i] = edge;
+  }
+
+  free(next);
+}
+
+/**
+ * Free the edges of a level.
+ * 
+ * @param level Pointer to a NavLevel.
+ */
+void RCA_FreeNavLevel(NavLevel *level)
+{
+  free(level->first);
+  free(level->to);
+  free(level->cost);
+  free(level->centers);
+}
+
+/**
+ * Compare two nodes by sector (qsort).
+ * 
+ * @param a Pointer to a node.
+ * @param b Pointer to a node.
+ * @return  Order of the sectors.
+ */
+int RCA_CompareNavNodes(const void *a, const void *b)
+{
+  Sector *sa = RCA_NAVGRAPH__SORTED->sectors[*(const int *)a];
+  Sector *sb = RCA_NAVGRAPH__SORTED->sectors[*(const int *)b];
+
+  return (sa > sb) - (sa < sb);
+}
+
+/**
+ * Key of a portal, the same whichever way the wall goes.
+ * 
+ * @param wall Pointer to a Sector object (a wall).
+ * @param key  Ends of the wall, snapped and sorted (output).
+ */
+void RCA_FindPortalKey(Sector *wall, long key[4])
+{
+  long a[2] = {lround(wall->x1 * RCA_NAVGRAPH_SNAP), lround(wall->y1 * RCA_NAVGRAPH_SNAP)};
+  long b[2] = {lround(wall->x2 * RCA_NAVGRAPH_SNAP), lround(wall->y2 * RCA_NAVGRAPH_SNAP)};
+  int swap = (a[0] > b[0]) || (a[0] == b[0] && a[1] > b[1]);
+
+  key[0] = swap ? b[0] : a[0];
+  key[1] = swap ? b[1] : a[1];
+  key[2] = swap ? a[0] : b[0];
+  key[3] = swap ? a[1] : b[1];
+}
+
+/**
+ * Make room in a path.
+ * 
+ * @param path     Pointer to a NavPath.
+ * @param capacity Nodes needed.
+ */
+void RCA_ReserveNavPath(NavPath *path, int capacity)
+{
+  if (path->capacity < capacity)
+  {
+	path->capacity = (capacity > 2 * path->capacity) ? capacity : 2 * path->capacity;
+	path->path = realloc(path->path, path->capacity * sizeof(int));
+  }
+}
+
+/**
+ * Copy a path.
+ * 
+ * @param path   Pointer to a NavPath (output).
+ * @param source Pointer to a NavPath.
+ */
+void RCA_CopyNavPath(NavPath *path, NavPath *source)
+{
+  RCA_ReserveNavPath(path, source->length);
+  memcpy(path->path, source->path, source->length * sizeof(int));
+  path->from = source->from;
+  path->to = source->to;
+  path->length = source->length;
+}
+
+/**
+ * Allocate the scratch of a search.
+ * 
+ * @param scratch Pointer to a NavScratch.
+ * @param count   Nodes of the level searched.
+ */
+void RCA_InitNavScratch(NavScratch *scratch, int count)
+{
+  scratch->g = malloc((count > 0 ? count : 1) * sizeof(double));
+  scratch->parent = malloc((count > 0 ? count : 1) * sizeof(int));
+  scratch->seen = calloc(count > 0 ? count : 1, sizeof(unsigned int));
+  scratch->closed = calloc(count > 0 ? count : 1, sizeof(unsigned int));
+  scratch->generation = 0;
+  scratch->heap_capacity = 64;
+  scratch->heap_count = 0;
+  scratch->heap = malloc(scratch->heap_capacity * sizeof(int));
+  scratch->keys = malloc(scratch->heap_capacity * sizeof(double));
+}
+
+/**
+ * Free the scratch of a search.
+ * 
+ * @param scratch Pointer to a NavScratch.
+ */
+void RCA_FreeNavScratch(NavScratch *scratch)
+{
+  free(scratch->g);
+  free(scratch->parent);
+  free(scratch->seen);
+  free(scratch->closed);
+  free(scratch->heap);
+  free(scratch->keys);
+}
+
+/**
+ * Push an open node.
+ * 
+ * @param scratch Pointer to a NavScratch.
+ * @param node    Node.
+ * @param key     Cost from the start plus estimate to the goal.
+ */
+void RCA_PushNavNode(NavScratch *scratch, int node, double key)
+{
+  int i = scratch->heap_count++, parent;
+
+  if (scratch->heap_count > scratch->heap_capacity)
+  {
+	scratch->heap_capacity *= 2;
+	scratch->heap = realloc(scratch->heap, scratch->heap_capacity * sizeof(int));
+	scratch->keys = realloc(scratch->keys, scratch->heap_capacity * sizeof(double));
+  }
+
+  for (; i > 0 && scratch->keys[parent = (i - 1) / 2] > key; i = parent)
+  {
+	scratch->heap[i] = scratch->heap[parent];
+	scratch->keys[i] = scratch->keys[parent];
+  }
+  scratch->heap[i] = node;
+  scratch->keys[i] = key;
+}
+
+/**
+ * Pop the open node with the smallest key.
+ * 
+ * @param scratch Pointer to a NavScratch (not empty).
+ * @return        Node.
+ */
+int RCA_PopNavNode(NavScratch *scratch)
+{
+  int node = scratch->heap[0], last = scratch->heap[--scratch->heap_count];
+  double key = scratch->keys[scratch->heap_count];
+  int i = 0, child;
+
+  while ((child = 2 * i + 1) < scratch->heap_count)
+  {
+	if (child + 1 < scratch->heap_count && scratch->keys[child + 1] < scratch->keys[child])
+	  child++;
+	if (scratch->keys[child] >= key)
+	  break;
+	scratch->heap[i] = scratch->heap[child];
+	scratch->keys[i] = scratch->keys[child];
+	i = child;
+  }
+  scratch->heap[i] = last;
+  scratch->keys[i] = key;
+
+  return node;
+}
+
+/**
+ * Open a node if it is reached cheaper than before.
+ * 
+ * @param scratch Pointer to a NavScratch.
+ * @param node    Node reached.
+ * @param parent  Node it is reached from (-1 for a start).
+ * @param g       Cost from the start.
+ * @param h       Estimate to the goal.
+ */
+void RCA_RelaxNavNode(NavScratch *scratch, int node, int parent, double g, double h)
+{
+  if (scratch->closed[node] == scratch->generation)
+	return;
+
+  if (scratch->seen[node] != scratch->generation || g < scratch->g[node])
+  {
+	scratch->seen[node] = scratch->generation;
+	scratch->g[node] = g;
+	scratch->parent[node] = parent;
+	RCA_PushNavNode(scratch, node, g + h);
+  }
+}
+
+/**
+ * Write the path to a node.
+ * 
+ * @param scratch Pointer to a NavScratch (the node closed).
+ * @param node    Last node.
+ * @param path    Pointer to a NavPath (output).
+ * @return        Nodes in the path.
+ */
+int RCA_FindNavParents(NavScratch *scratch, int node, NavPath *path)
+{
+  int length, next;
+
+  for (length = 0, next = node; next >= 0; next = scratch->parent[next])
+	length++;
+
+  RCA_ReserveNavPath(path, length);
+  path->length = length;
+  for (next = node; next >= 0; next = scratch->parent[next])
+	path->path[--length] = next;
+
+  return path->length;
+}
+
+/**
+ * A* over a level.
+ * 
+ * The estimate is the straight line between the centres, never more
+ * than the cost of the edges.  Without a goal every node reachable is
+ * visited (the costs are then in the scratch).
+ * 
+ * @param level   Pointer to a NavLevel.
+ * @param scratch Pointer to a NavScratch (sized for the level).
+ * @param region  Region of every node (or NULL to search them all).
+ * @param allowed Regions searched have the mark.
+ * @param mark    Mark of the regions searched.
+ * @param from    First node.
+ * @param to      Last node (or -1).
+ * @param path    Pointer to a NavPath (output, or NULL without a goal).
+ * @return        Nodes in the path, 0 if there is none.
+ */
+int RCA_SearchNavLevel(NavLevel *level, NavScratch *scratch, int *region, unsigned int *allowed, unsigned int mark,
+					   int from, int to, NavPath *path)
+{
+  int node, next, edge;
+
+  if (path != NULL)
+  {
+	path->from = from;
+	path->to = to;
+	path->length = 0;
+  }
+
+  scratch->generation++;
+  scratch->heap_count = 0;
+  RCA_RelaxNavNode(scratch, from, -1, 0, (to >= 0) ? RCA_FindNavDistance(level->centers[from], level->centers[to]) : 0);
+
+  while (scratch->heap_count > 0)
+  {
+	node = RCA_PopNavNode(scratch);
+	if (scratch->closed[node] == scratch->generation)
+	  continue;
+	scratch->closed[node] = scratch->generation;
+
+	if (node == to)
+	  return RCA_FindNavParents(scratch, to, path);
+
+	for (edge = level->first[node]; edge < level->first[node + 1]; edge++)
+	{
+	  next = level->to[edge];
+	  if (region == NULL || allowed[region[next]] == mark)
+		RCA_RelaxNavNode(scratch, next, node, scratch->g[node] + level->cost[edge],
+						 (to >= 0) ? RCA_FindNavDistance(level->centers[next], level->centers[to]) : 0);
+	}
+  }
+
+  return 0;
+}
+
+/**
+ * Add a link between entrances.
+ * 
+ * @param pairs    Entrances linked (grown as needed).
+ * @param costs    Cost of every pair (grown as needed).
+ * @param count    Number of pairs (updated).
+ * @param capacity Room for pairs (updated).
+ * @param from     Entrance.
+ * @param to       Entrance.
+ * @param cost     Cost of the link.
+ */
+void RCA_AddNavLink(int (**pairs)[2], double **costs, int *count, int *capacity, int from, int to, double cost)
+{
+  if (*count == *capacity)
+  {
+	*capacity *= 2;
+	*pairs = realloc(*pairs, *capacity * sizeof(int[2]));
+	*costs = realloc(*costs, *capacity * sizeof(double));
+  }
+
+  (*pairs)[*count][0] = from;
+  (*pairs)[*count][1] = to;
+  (*costs)[*count] = cost;
+  (*count)++;
+}
+
+/**
+ * Find the links of the entrances of a region.
+ * 
+ * Every entrance gets a shortcut to the other entrances it reaches
+ * inside the region, and keeps its portals to the other regions.
+ * 
+ * @param graph    Pointer to a NavGraph object (entrances set).
+ * @param scratch  Pointer to a NavScratch (sized for the nodes).
+ * @param allowed  Mark of every region (scratch).
+ * @param region   Region.
+ * @param pairs    Entrances linked (grown as needed).
+ * @param costs    Cost of every pair (grown as needed).
+ * @param count    Number of pairs (updated).
+ * @param capacity Room for pairs (updated).
+ */
+void RCA_FindNavShortcuts(NavGraph *graph, NavScratch *scratch, unsigned int *allowed, int region, int (**pairs)[2],
+						  double **costs, int *count, int *capacity)
+{
+  int a, b, edge, node;
+
+  for (a = graph->region_first[region]; a < graph->region_first[region + 1]; a++)
+  {
+	/* every search has its own mark */
+	node = graph->entrances[a];
+	allowed[region] = a + 1;
+	RCA_SearchNavLevel(&graph->nodes, scratch, graph->region, allowed, a + 1, node, -1, NULL);
+
+	for (b = graph->region_first[region]; b < graph->region_first[region + 1]; b++)
+	{
+	  if (b != a && scratch->seen[graph->entrances[b]] == scratch->generation)
+		RCA_AddNavLink(pairs, costs, count, capacity, a, b, scratch->g[graph->entrances[b]]);
+	}
+
+	for (edge = graph->nodes.first[node]; edge < graph->nodes.first[node + 1]; edge++)
+	{
+	  if (graph->region[graph->nodes.to[edge]] != region)
+		RCA_AddNavLink(pairs, costs, count, capacity, a, graph->entrance[graph->nodes.to[edge]], graph->nodes.cost[edge]);
+	}
+  }
+}
+
+/**
+ * Constructor.
+ * 
+ * The portals are matched through a hash table of their ends, then the
+ * shortcuts of every region are found.
+ * 
+ * @param graph   Pointer to a NavGraph object.
+ * @param sectors Sectors of the level (the masters).
+ * @param count   Number of sectors.
+ */
+void RCA_ConstructNavGraph(NavGraph *graph, Sector **sectors, int count)
+{
+  int i, j, k, candidate_count = 0, pair_count = 0, pair_capacity = 64, table_size = 1;
+  int *owners, *table, *cells, *order, (*pairs)[2] = malloc(pair_capacity * sizeof(int[2]));
+  double (*middles)[2] = malloc(pair_capacity * sizeof(double[2])), *costs;
+  double bounds[4] = {HUGE_VAL, HUGE_VAL, -HUGE_VAL, -HUGE_VAL};
+  int columns, rows, walls;
+  long key[4], other[4];
+  unsigned long hash;
+  unsigned int *allowed;
+  Sector *wall, **candidates;
+  NavScratch scratch;
+
+  /* here OR the RCA_NAVGRAPH_TYPE constant into the type */
+  graph->type |= RCA_NAVGRAPH_TYPE;
+
+  graph->sectors = malloc((count > 0 ? count : 1) * sizeof(Sector *));
+  memcpy(graph->sectors, sectors, count * sizeof(Sector *));
+  graph->nodes.count = count;
+  graph->nodes.centers = malloc((count > 0 ? count : 1) * sizeof(double[2]));
+  graph->hits = graph->misses = 0;
+  memset(graph->cache, 0, sizeof(graph->cache));
+  memset(graph->searches, 0, sizeof(graph->searches));
+  memset(graph->taken, 0, sizeof(graph->taken));
+
+  /* centre of every sector, and the walls which may be portals */
+  for (i = 0; i < count; i++)
+  {
+	graph->nodes.centers[i][0] = graph->nodes.centers[i][1] = 0;
+	for (wall = sectors[i]->first->next, walls = 0; wall != NULL; wall = wall->next, walls++)
+	{
+	  graph->nodes.centers[i][0] += (wall->x1 + wall->x2) / 2;
+	  graph->nodes.centers[i][1] += (wall->y1 + wall->y2) / 2;
+	  if (wall->middle_color[3] == 0)
+		candidate_count++;
+	}
+	if (walls > 0)
+	{
+	  graph->nodes.centers[i][0] /= walls;
+	  graph->nodes.centers[i][1] /= walls;
+	}
+	bounds[0] = fmin(bounds[0], graph->nodes.centers[i][0]);
+	bounds[1] = fmin(bounds[1], graph->nodes.centers[i][1]);
+	bounds[2] = fmax(bounds[2], graph->nodes.centers[i][0]);
+	bounds[3] = fmax(bounds[3], graph->nodes.centers[i][1]);
+  }
+
+  /* portals: the same wall in two sectors (linear probing, every match of a key is linked) */
+  while (table_size < 2 * candidate_count)
+	table_size *= 2;
+  table = malloc(table_size * sizeof(int));
+  memset(table, -1, table_size * sizeof(int));
+  candidates = malloc((candidate_count > 0 ? candidate_count : 1) * sizeof(Sector *));
+  owners = malloc((candidate_count > 0 ? candidate_count : 1) * sizeof(int));
+
+  for (i = 0, k = 0; i < count; i++)
+  {
+	for (wall = sectors[i]->first->next; wall != NULL; wall = wall->next)
+	{
+	  if (wall->middle_color[3] != 0)
+		continue;
+
+	  RCA_FindPortalKey(wall, key);
+	  hash = ((unsigned long)key[0] * 73856093u) ^ ((unsigned long)key[1] * 19349663u) ^
+			 ((unsigned long)key[2] * 83492791u) ^ ((unsigned long)key[3] * 2654435761u);
+	  hash = (hash ^ (hash >> 31)) * 0x9e3779b97f4a7c15ul;	/* the low bits of snapped ends are mostly 0 */
+	  hash ^= hash >> 29;
+	  for (j = hash & (table_size - 1); table[j] >= 0; j = (j + 1) & (table_size - 1))
+	  {
+		RCA_FindPortalKey(candidates[table[j]], other);
+		if (memcmp(key, other, sizeof(key)) != 0 || owners[table[j]] == i)
+		  continue;
+
+		if (pair_count + 2 > pair_capacity)
+		{
+		  pair_capacity *= 2;
+		  pairs = realloc(pairs, pair_capacity * sizeof(int[2]));
+		  middles = realloc(middles, pair_capacity * sizeof(double[2]));
+		}
+		pairs[pair_count][0] = i; pairs[pair_count][1] = owners[table[j]];
+		pairs[pair_count + 1][0] = owners[table[j]]; pairs[pair_count + 1][1] = i;
+		middles[pair_count][0] = middles[pair_count + 1][0] = (wall->x1 + wall->x2) / 2;
+		middles[pair_count][1] = middles[pair_count + 1][1] = (wall->y1 + wall->y2) / 2;
+		pair_count += 2;
+	  }
+	  candidates[k] = wall;
+	  owners[k] = i;
+	  table[j] = k++;
+	}
+  }
+
+  /* edges of the sectors go through the middle of their portal */
+  costs = malloc((pair_count > 0 ? pair_count : 1) * sizeof(double));
+  for (i = 0; i < pair_count; i++)
+  {
+	costs[i] = RCA_FindNavDistance(graph->nodes.centers[pairs[i][0]], middles[i]) +
+			   RCA_FindNavDistance(middles[i], graph->nodes.centers[pairs[i][1]]);
+  }
+  order = malloc((pair_count > 0 ? pair_count : 1) * sizeof(int));
+  RCA_BuildNavLevel(&graph->nodes, pairs, costs, pair_count, order);
+  graph->portals = malloc((pair_count > 0 ? pair_count : 1) * sizeof(double[2]));
+  for (i = 0; i < pair_count; i++)
+  {
+	graph->portals[order[i]][0] = middles[i][0];
+	graph->portals[order[i]][1] = middles[i][1];
+  }
+
+  /* regions: a grid over the centres, only the cells used are kept */
+  columns = (count > 0) ? (int)((bounds[2] - bounds[0]) / RCA_NAVGRAPH_REGION) + 1 : 1;
+  rows = (count > 0) ? (int)((bounds[3] - bounds[1]) / RCA_NAVGRAPH_REGION) + 1 : 1;
+  cells = malloc(columns * rows * sizeof(int));
+  memset(cells, -1, columns * rows * sizeof(int));
+  graph->region = malloc((count > 0 ? count : 1) * sizeof(int));
+  graph->region_count = 0;
+  for (i = 0; i < count; i++)
+  {
+	k = (int)((graph->nodes.centers[i][1] - bounds[1]) / RCA_NAVGRAPH_REGION) * columns +
+		(int)((graph->nodes.centers[i][0] - bounds[0]) / RCA_NAVGRAPH_REGION);
+	if (cells[k] < 0)
+	  cells[k] = graph->region_count++;
+	graph->region[i] = cells[k];
+  }
+
+  /* entrances, grouped by region */
+  graph->entrance = malloc((count > 0 ? count : 1) * sizeof(int));
+  graph->region_first = calloc(graph->region_count + 1, sizeof(int));
+  for (i = 0; i < count; i++)
+  {
+	graph->entrance[i] = -1;
+	for (j = graph->nodes.first[i]; j < graph->nodes.first[i + 1]; j++)
+	{
+	  if (graph->region[graph->nodes.to[j]] != graph->region[i])
+		graph->entrance[i] = 0;
+	}
+	if (graph->entrance[i] == 0)
+	  graph->region_first[graph->region[i] + 1]++;
+  }
+  graph->most_entrances = 0;
+  for (i = 0; i < graph->region_count; i++)
+  {
+	if (graph->region_first[i + 1] > graph->most_entrances)
+	  graph->most_entrances = graph->region_first[i + 1];
+	graph->region_first[i + 1] += graph->region_first[i];
+	cells[i] = graph->region_first[i];
+  }
+  graph->shortcuts.count = graph->region_first[graph->region_count];
+  graph->entrances = malloc((graph->shortcuts.count > 0 ? graph->shortcuts.count : 1) * sizeof(int));
+  graph->shortcuts.centers = malloc((graph->shortcuts.count > 0 ? graph->shortcuts.count : 1) * sizeof(double[2]));
+  for (i = 0; i < count; i++)
+  {
+	if (graph->entrance[i] < 0)
+	  continue;
+	graph->entrance[i] = cells[graph->region[i]]++;
+	graph->entrances[graph->entrance[i]] = i;
+	graph->shortcuts.centers[graph->entrance[i]][0] = graph->nodes.centers[i][0];
+	graph->shortcuts.centers[graph->entrance[i]][1] = graph->nodes.centers[i][1];
+  }
+
+  /* shortcuts (the pairs are used again) */
+  RCA_InitNavScratch(&scratch, count);
+  allowed = calloc(graph->region_count > 0 ? graph->region_count : 1, sizeof(unsigned int));
+  for (i = 0, k = 0; i < graph->region_count; i++)
+  {
+	RCA_FindNavShortcuts(graph, &scratch, allowed, i, &pairs, &costs, &k, &pair_capacity);
+  }
+  RCA_BuildNavLevel(&graph->shortcuts, pairs, costs, k, NULL);
+  RCA_FreeNavScratch(&scratch);
+
+  /* nodes sorted by sector, to find the node of a sector */
+  graph->order = malloc((count > 0 ? count : 1) * sizeof(int));
+  for (i = 0; i < count; i++)
+  {
+	graph->order[i] = i;
+  }
+  RCA_NAVGRAPH__SORTED = graph;
+  qsort(graph->order, count, sizeof(int), RCA_CompareNavNodes);
+
+  free(pairs);
+  free(middles);
+  free(costs);
+  free(table);
+  free(candidates);
+  free(owners);
+  free(order);
+  free(cells);
+  free(allowed);
+}
+
+/**
+ * Start a search.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch.
+ */
+void RCA_InitNavSearch(NavGraph *graph, NavSearch *search)
+{
+  RCA_InitNavScratch(&search->nodes, graph->nodes.count);
+  RCA_InitNavScratch(&search->shortcuts, graph->shortcuts.count + 1);
+  memset(&search->route, 0, sizeof(NavPath));
+  memset(&search->leg, 0, sizeof(NavPath));
+  search->start_costs = malloc((graph->most_entrances > 0 ? graph->most_entrances : 1) * sizeof(double));
+  search->goal_costs = malloc((graph->most_entrances > 0 ? graph->most_entrances : 1) * sizeof(double));
+  search->allowed = calloc(graph->region_count > 0 ? graph->region_count : 1, sizeof(unsigned int));
+  search->mark = 0;
+}
+
+/**
+ * Free a search.
+ * 
+ * @param search Pointer to a NavSearch.
+ */
+void RCA_FreeNavSearch(NavSearch *search)
+{
+  RCA_FreeNavScratch(&search->nodes);
+  RCA_FreeNavScratch(&search->shortcuts);
+  free(search->route.path);
+  free(search->leg.path);
+  free(search->start_costs);
+  free(search->goal_costs);
+  free(search->allowed);
+}
+
+/**
+ * New.
+ * 
+ * @param sectors Sectors of the level (the masters).
+ * @param count   Number of sectors.
+ * @return        An object NavGraph.
+ */
+NavGraph *RCA_NewNavGraph(Sector **sectors, int count)
+{
+  NavGraph *graph = malloc(sizeof(NavGraph));
+  graph->type = RCA_NAVGRAPH_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructNavGraph(graph, sectors, count);
+
+  return graph;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param graph Pointer to a NavGraph object.
+ */
+void RCA_CheckNavGraph(NavGraph *graph)
+{
+  /* check if we have a valid NavGraph object */
+  if (graph == NULL ||
+	  !(graph->type & RCA_NAVGRAPH_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param graph Pointer to a NavGraph object.
+ */
+void RCA_DestroyNavGraph(NavGraph *graph)
+{
+  int i;
+
+  /* check if we have a valid NavGraph object */
+  RCA_CheckNavGraph(graph);
+
+  /* set type to 0 indicate this is no longer a NavGraph object */
+  graph->type = 0;
+
+  /* free the memory allocated for the object */
+  for (i = 0; i < RCA_NAVGRAPH_CACHE; i++)
+  {
+	free(graph->cache[i].path);
+  }
+  for (i = 0; i < RCA_PARALLEL_MAX_THREADS; i++)
+  {
+	if (graph->searches[i].allowed != NULL)
+	  RCA_FreeNavSearch(&graph->searches[i]);
+  }
+  RCA_FreeNavLevel(&graph->nodes);
+  RCA_FreeNavLevel(&graph->shortcuts);
+  free(graph->sectors);
+  free(graph->order);
+  free(graph->portals);
+  free(graph->region);
+  free(graph->entrance);
+  free(graph->entrances);
+  free(graph->region_first);
+  free(graph);
+}
+
+/**
+ * Find the node of a sector.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param sector Pointer to a Sector object (a master).
+ * @return       Node of the sector, or -1 if it is not in the graph.
+ */
+int RCA_FindNavNode(NavGraph *graph, Sector *sector)
+{
+  int low = 0, high = graph->nodes.count - 1, middle;
+
+  while (low <= high)
+  {
+	middle = (low + high) / 2;
+	if (graph->sectors[graph->order[middle]] == sector)
+	  return graph->order[middle];
+	if (graph->sectors[graph->order[middle]] < sector)
+	  low = middle + 1;
+	else
+	  high = middle - 1;
+  }
+
+  return -1;
+}
+
+/**
+ * Search nodes inside a region.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch.
+ * @param from   First node.
+ * @param to     Last node in the same region (or -1 to visit the region).
+ * @param path   Pointer to a NavPath (output, or NULL).
+ * @return       Nodes in the path, 0 if there is none.
+ */
+int RCA_SearchNavRegion(NavGraph *graph, NavSearch *search, int from, int to, NavPath *path)
+{
+  search->allowed[graph->region[from]] = ++search->mark;
+
+  return RCA_SearchNavLevel(&graph->nodes, &search->nodes, graph->region, search->allowed, search->mark, from, to, path);
+}
+
+/**
+ * Find costs from a node to the entrances of its region.
+ * 
+ * The links are the same both ways, so these are the costs to the node
+ * as well.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch.
+ * @param node   Node.
+ * @param costs  Cost of every entrance of the region, HUGE_VAL if not reached (output).
+ */
+void RCA_FindNavEntranceCosts(NavGraph *graph, NavSearch *search, int node, double *costs)
+{
+  int region = graph->region[node], k;
+
+  RCA_SearchNavRegion(graph, search, node, -1, NULL);
+  for (k = graph->region_first[region]; k < graph->region_first[region + 1]; k++)
+  {
+	costs[k - graph->region_first[region]] = (search->nodes.seen[graph->entrances[k]] == search->nodes.generation)
+											 ? search->nodes.g[graph->entrances[k]] : HUGE_VAL;
+  }
+}
+
+/**
+ * A* over the entrances.
+ * 
+ * Starts from every entrance of the region of the start, and goes to the
+ * goal (an extra node) from every entrance of the region of the goal.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch (start_costs and goal_costs set).
+ * @param from   First node.
+ * @param to     Last node.
+ * @return       Entrances in the route, 0 if there is none.
+ */
+int RCA_SearchNavShortcuts(NavGraph *graph, NavSearch *search, int from, int to)
+{
+  NavScratch *scratch = &search->shortcuts;
+  NavLevel *level = &graph->shortcuts;
+  int goal = level->count, first = graph->region_first[graph->region[to]], last = graph->region_first[graph->region[to] + 1];
+  int node, edge, k;
+  double *target = graph->nodes.centers[to];
+
+  search->route.length = 0;
+  scratch->generation++;
+  scratch->heap_count = 0;
+  for (k = graph->region_first[graph->region[from]]; k < graph->region_first[graph->region[from] + 1]; k++)
+  {
+	if (search->start_costs[k - graph->region_first[graph->region[from]]] < HUGE_VAL)
+	  RCA_RelaxNavNode(scratch, k, -1, search->start_costs[k - graph->region_first[graph->region[from]]],
+					   RCA_FindNavDistance(level->centers[k], target));
+  }
+
+  while (scratch->heap_count > 0)
+  {
+	node = RCA_PopNavNode(scratch);
+	if (scratch->closed[node] == scratch->generation)
+	  continue;
+	scratch->closed[node] = scratch->generation;
+
+	if (node == goal)
+	{
+	  RCA_FindNavParents(scratch, scratch->parent[goal], &search->route);
+	  return search->route.length;
+	}
+
+	if (node >= first && node < last && search->goal_costs[node - first] < HUGE_VAL)
+	  RCA_RelaxNavNode(scratch, goal, node, scratch->g[node] + search->goal_costs[node - first], 0);
+
+	for (edge = level->first[node]; edge < level->first[node + 1]; edge++)
+	{
+	  RCA_RelaxNavNode(scratch, level->to[edge], node, scratch->g[node] + level->cost[edge],
+					   RCA_FindNavDistance(level->centers[level->to[edge]], target));
+	}
+  }
+
+  return 0;
+}
+
+/**
+ * Add a path inside a region to the end of a path.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch.
+ * @param from   Last node of the path (or its first one if it is empty).
+ * @param to     Node in the same region.
+ * @param path   Pointer to a NavPath (grown).
+ */
+void RCA_AddNavLeg(NavGraph *graph, NavSearch *search, int from, int to, NavPath *path)
+{
+  int skip = (path->length > 0) ? 1 : 0;
+
+  RCA_SearchNavRegion(graph, search, from, to, &search->leg);
+  RCA_ReserveNavPath(path, path->length + search->leg.length);
+  memcpy(path->path + path->length, search->leg.path + skip, (search->leg.length - skip) * sizeof(int));
+  path->length += search->leg.length - skip;
+}
+
+/**
+ * Find a path between two sectors (no cache).
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch (of this thread).
+ * @param from   Node of the first sector (-1, from RCA_FindNavNode, has no path).
+ * @param to     Node of the last sector (-1 has no path).
+ * @param path   Pointer to a NavPath (output).
+ * @return       Sectors in the path, 0 if there is none.
+ */
+int RCA_FindNavPath(NavGraph *graph, NavSearch *search, int from, int to, NavPath *path)
+{
+  int i, a, b;
+  double cost = HUGE_VAL;
+
+  path->from = from;
+  path->to = to;
+  path->length = 0;
+
+  if (from < 0 || to < 0)
+	return 0;
+
+  /* the region of the start is searched whole, which gives the path staying inside */
+  RCA_FindNavEntranceCosts(graph, search, from, search->start_costs);
+  if (graph->region[from] == graph->region[to] && search->nodes.seen[to] == search->nodes.generation)
+  {
+	cost = search->nodes.g[to];
+	RCA_FindNavParents(&search->nodes, to, path);
+  }
+
+  /* going out of the region (and back) is taken only if it reaches the goal (the node after the entrances) cheaper */
+  RCA_FindNavEntranceCosts(graph, search, to, search->goal_costs);
+  if (RCA_SearchNavShortcuts(graph, search, from, to) == 0 || search->shortcuts.g[graph->shortcuts.count] >= cost)
+	return path->length;
+  path->length = 0;
+
+  /* the route is walked again inside every region it goes through */
+  RCA_AddNavLeg(graph, search, from, graph->entrances[search->route.path[0]], path);
+  for (i = 0; i + 1 < search->route.length; i++)
+  {
+	a = graph->entrances[search->route.path[i]];
+	b = graph->entrances[search->route.path[i + 1]];
+	if (graph->region[a] == graph->region[b])
+	{
+	  RCA_AddNavLeg(graph, search, a, b, path);
+	}
+	else
+	{
+	  RCA_ReserveNavPath(path, path->length + 1);
+	  path->path[path->length++] = b;
+	}
+  }
+  RCA_AddNavLeg(graph, search, graph->entrances[search->route.path[search->route.length - 1]], to, path);
+
+  return path->length;
+}
+
+/**
+ * Cache entry of a path.
+ * 
+ * @param from First node.
+ * @param to   Last node.
+ * @return     Index in the cache.
+ */
+int RCA_FindNavCacheSlot(int from, int to)
+{
+  unsigned int hash = (unsigned int)from * 2654435761u ^ (unsigned int)to * 40503u;
+
+  return (hash ^ (hash >> 15)) & (RCA_NAVGRAPH_CACHE - 1);
+}
+
+/**
+ * Check if a cache entry holds a path.
+ * 
+ * @param entry Pointer to a NavPath (a cache entry).
+ * @param from  First node.
+ * @param to    Last node.
+ * @return      True (1) if the entry is the path from the first node to the last, false (0) otherwise.
+ */
+int RCA_CheckNavCacheEntry(NavPath *entry, int from, int to)
+{
+  return entry->capacity > 0 && entry->from == from && entry->to == to;
+}
+
+/**
+ * Clear the cache (after the level changed).
+ * 
+ * @param graph Pointer to a NavGraph object.
+ */
+void RCA_ClearNavCache(NavGraph *graph)
+{
+  int i;
+
+  /* check if we have a valid NavGraph object */
+  RCA_CheckNavGraph(graph);
+
+  for (i = 0; i < RCA_NAVGRAPH_CACHE; i++)
+  {
+	graph->cache[i].from = graph->cache[i].to = -1;
+	graph->cache[i].length = 0;
+  }
+}
+
+/**
+ * Find a path, through the cache.
+ * 
+ * @param graph  Pointer to a NavGraph object.
+ * @param search Pointer to a NavSearch.
+ * @param path   Pointer to a NavPath (from and to set, the path is output).
+ * @return       Sectors in the path, 0 if there is none.
+ */
+int RCA_FindCachedNavPath(NavGraph *graph, NavSearch *search, NavPath *path)
+{
+  NavPath *entry = &graph->cache[RCA_FindNavCacheSlot(path->from, path->to)];
+
+  /* check if we have a valid NavGraph object */
+  RCA_CheckNavGraph(graph);
+
+  if (RCA_CheckNavCacheEntry(entry, path->from, path->to))
+  {
+	graph->hits++;
+	RCA_CopyNavPath(path, entry);
+	return path->length;
+  }
+
+  graph->misses++;
+  RCA_FindNavPath(graph, search, path->from, path->to, path);
+  RCA_ReserveNavPath(entry, 1);
+  RCA_CopyNavPath(entry, path);
+
+  return path->length;
+}
+
+/**
+ * Batch of queries.
+ */
+typedef struct {
+  NavGraph *graph;
+  NavPath *queries;
+  int count;
+  int *owners;					/* query searching the path of every query, -1 if cached */
+} NavBatch;
+
+/**
+ * Search a block of queries of a batch (one worker).
+ * 
+ * @param block Index of the block.
+ * @param data  Pointer to a NavBatch.
+ */
+void RCA_SearchNavBlock(int block, void *data)
+{
+  NavBatch *batch = data;
+  NavGraph *graph = batch->graph;
+  int i, s = 0;
+
+  /* a search not taken by another worker (there are no more workers than searches) */
+  while (__atomic_exchange_n(&graph->taken[s], 1, __ATOMIC_ACQUIRE))
+  {
+	s = (s + 1) % RCA_PARALLEL_MAX_THREADS;
+  }
+  if (graph->searches[s].allowed == NULL)
+	RCA_InitNavSearch(graph, &graph->searches[s]);
+
+  for (i = block * RCA_NAVGRAPH_BLOCK; i < (block + 1) * RCA_NAVGRAPH_BLOCK && i < batch->count; i++)
+  {
+	if (batch->owners[i] == i)
+	  RCA_FindNavPath(graph, &graph->searches[s], batch->queries[i].from, batch->queries[i].to, &batch->queries[i]);
+  }
+
+  __atomic_store_n(&graph->taken[s], 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Find the paths of a batch of queries.
+ * 
+ * The cached paths are copied, the other ones searched in parallel
+ * (once each, however many queries ask for it) and cached.
+ * 
+ * @param graph   Pointer to a NavGraph object.
+ * @param queries Queries (from and to set, the paths are output).
+ * @param count   Number of queries.
+ * @param threads Number of threads.
+ */
+void RCA_FindNavPaths(NavGraph *graph, NavPath *queries, int count, int threads)
+{
+  NavBatch batch = {graph, queries, count, malloc((count > 0 ? count : 1) * sizeof(int))};
+  int *pending = malloc(RCA_NAVGRAPH_CACHE * sizeof(int));
+  int i, slot;
+  NavPath *entry;
+
+  /* check if we have a valid NavGraph object */
+  RCA_CheckNavGraph(graph);
+
+  /* a slot searched in this batch remembers by which query */
+  memset(pending, -1, RCA_NAVGRAPH_CACHE * sizeof(int));
+  for (i = 0; i < count; i++)
+  {
+	slot = RCA_FindNavCacheSlot(queries[i].from, queries[i].to);
+	entry = &graph->cache[slot];
+
+	if (pending[slot] >= 0 && queries[pending[slot]].from == queries[i].from && queries[pending[slot]].to == queries[i].to)
+	{
+	  batch.owners[i] = pending[slot];
+	}
+	else if (RCA_CheckNavCacheEntry(entry, queries[i].from, queries[i].to))
+	{
+	  graph->hits++;
+	  batch.owners[i] = -1;
+	  RCA_CopyNavPath(&queries[i], entry);
+	}
+	else
+	{
+	  graph->misses++;
+	  batch.owners[i] = i;
+	  pending[slot] = i;
+	}
+  }
+
+  RCA_ParallelFor((count + RCA_NAVGRAPH_BLOCK - 1) / RCA_NAVGRAPH_BLOCK, threads, RCA_SearchNavBlock, &batch);
+
+  /* the paths searched go to the cache and to the queries which asked for them too */
+  for (i = 0; i < count; i++)
+  {
+	if (batch.owners[i] == i)
+	{
+	  entry = &graph->cache[RCA_FindNavCacheSlot(queries[i].from, queries[i].to)];
+	  RCA_ReserveNavPath(entry, 1);
+	  RCA_CopyNavPath(entry, &queries[i]);
+	}
+	else if (batch.owners[i] >= 0)
+	{
+	  RCA_CopyNavPath(&queries[i], &queries[batch.owners[i]]);
+	}
+  }
+
+  free(batch.owners);
+  free(pending);
+}
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Palette of the 8-bit indexed frame.  Every colour drawn (a material)
+ * gets RCA_PALETTE_SHADES entries of the palette, its shades from dark
+ * to full bright, so a shaded colour is an index computed without any
+ * table.  The frame is drawn one byte per pixel and converted to the
+ * format of the screen once, when presented.
+ * 
+ * Materials are added as they are first drawn.  Once the palette is
+ * full, a new colour is drawn with the nearest material.  A colour not
+ * quite transparent is drawn opaque (there is no blending).
+ */
+
+#include <string.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "colormap.h"
+
+#ifndef RCA_PALETTE_H_
+#define RCA_PALETTE_H_
+
+#define RCA_PALETTE_SHADES 16		/* entries per material */
+#define RCA_PALETTE_MATERIALS (256 / RCA_PALETTE_SHADES)
+
+int RCA_PALETTE__MATERIALS[RCA_PALETTE_MATERIALS][3];
+int RCA_PALETTE__MATERIAL_COUNT = 0;
+SDL_Color RCA_PALETTE__COLORS[256];
+
+/**
+ * Initialize palette.
+ * 
+ * Must be called once the colormap is, before anything is drawn.  The
+ * first material is black (index 0 clears the frame).
+ */
+void RCA_InitPalette(void)
+{
+  memset(RCA_PALETTE__COLORS, 0, sizeof(RCA_PALETTE__COLORS));
+  memset(RCA_PALETTE__MATERIALS, 0, sizeof(RCA_PALETTE__MATERIALS));
+  RCA_PALETTE__MATERIAL_COUNT = 1;
+}
+
+/**
+ * Find material of a colour.
+ * 
+ * @param color Colour (the alpha is ignored).
+ * @return      Material of the colour, added if new.
+ */
+int RCA_FindMaterial(int color[4])
+{
+  int m, shade, level, distance, nearest = 0, nearest_distance = 3 * 256 * 256;
+
+  for (m = 0; m < RCA_PALETTE__MATERIAL_COUNT; m++)
+  {
+	if (RCA_PALETTE__MATERIALS[m][0] == color[0] && RCA_PALETTE__MATERIALS[m][1] == color[1] &&
+		RCA_PALETTE__MATERIALS[m][2] == color[2])
+	  return m;
+  }
+
+  /* full, the nearest material will do */
+  if (RCA_PALETTE__MATERIAL_COUNT == RCA_PALETTE_MATERIALS)
+  {
+	for (m = 0; m < RCA_PALETTE_MATERIALS; m++)
+	{
+	  distance = (RCA_PALETTE__MATERIALS[m][0] - color[0]) * (RCA_PALETTE__MATERIALS[m][0] - color[0]) +
+		(RCA_PALETTE__MATERIALS[m][1] - color[1]) * (RCA_PALETTE__MATERIALS[m][1] - color[1]) +
+		(RCA_PALETTE__MATERIALS[m][2] - color[2]) * (RCA_PALETTE__MATERIALS[m][2] - color[2]);
+	  if (distance < nearest_distance)
+	  {
+		nearest = m;
+		nearest_distance = distance;
+	  }
+	}
+	return nearest;
+  }
+
+  m = RCA_PALETTE__MATERIAL_COUNT++;
+  RCA_PALETTE__MATERIALS[m][0] = color[0];
+  RCA_PALETTE__MATERIALS[m][1] = color[1];
+  RCA_PALETTE__MATERIALS[m][2] = color[2];
+
+  /* the brighter of the light levels of every shade */
+  for (shade = 0; shade < RCA_PALETTE_SHADES; shade++)
+  {
+	level = (shade + 1) * RCA_COLORMAP_LEVELS / RCA_PALETTE_SHADES - 1;
+	RCA_PALETTE__COLORS[m * RCA_PALETTE_SHADES + shade].r = RCA_COLORMAP__TABLE[level][color[0]];
+	RCA_PALETTE__COLORS[m * RCA_PALETTE_SHADES + shade].g = RCA_COLORMAP__TABLE[level][color[1]];
+	RCA_PALETTE__COLORS[m * RCA_PALETTE_SHADES + shade].b = RCA_COLORMAP__TABLE[level][color[2]];
+  }
+
+  return m;
+}
+
+/**
+ * Get palette index.
+ * 
+ * @param color Colour (unshaded).
+ * @param level Light level.
+ * @return      Index of the shaded colour.
+ */
+unsigned char RCA_GetPaletteIndex(int color[4], int level)
+{
+  return RCA_FindMaterial(color) * RCA_PALETTE_SHADES + level * RCA_PALETTE_SHADES / RCA_COLORMAP_LEVELS;
+}
+
+/**
+ * Fill a box.
+ * 
+ * Shaded with the colormap, or the palette on an 8-bit surface.  The
+ * corners are included, like boxRGBA.
+ * 
+ * @param screen A copy of the current SDL surface.
+ * @param x1     One corner of the box.
+ * @param y1     One corner of the box.
+ * @param x2     Other corner of the box.
+ * @param y2     Other corner of the box.
+ * @param color  Colour of the box (unshaded).
+ * @param level  Light level.
+ */
+void RCA_FillBox(SDL_Surface *screen, int x1, int y1, int x2, int y2, int color[4], int level)
+{
+  unsigned char *colormap = RCA_COLORMAP__TABLE[level];
+  unsigned char index;
+  Uint8 *row;
+  int swap;
+
+  if (screen->format->BytesPerPixel != 1)
+  {
+	boxRGBA(screen, x1, y1, x2, y2, colormap[color[0]], colormap[color[1]], colormap[color[2]], color[3]);
+	return;
+  }
+
+  if (color[3] == 0)
+	return;
+
+  if (x1 > x2) { swap = x1; x1 = x2; x2 = swap; }
+  if (y1 > y2) { swap = y1; y1 = y2; y2 = swap; }
+  if (x1 < 0) x1 = 0;
+  if (y1 < 0) y1 = 0;
+  if (x2 > screen->w - 1) x2 = screen->w - 1;
+  if (y2 > screen->h - 1) y2 = screen->h - 1;
+  if (x1 > x2 || y1 > y2)
+	return;
+
+  index = RCA_GetPaletteIndex(color, level);
+  for (row = (Uint8 *)screen->pixels + y1 * screen->pitch + x1; y1 <= y2; y1++, row += screen->pitch)
+  {
+	memset(row, index, x2 - x1 + 1);
+  }
+}
+
+/**
+ * Present an indexed frame.
+ * 
+ * Every byte of the frame becomes a pixel of the screen through the
+ * palette converted to the format of the screen, in one pass.
+ * 
+ * @param frame  8-bit surface drawn.
+ * @param screen Surface shown (same size).
+ */
+void RCA_PresentIndexedFrame(SDL_Surface *frame, SDL_Surface *screen)
+{
+  Uint32 native[256];
+  Uint8 *source;
+  Uint32 *destination;
+  int i, x, y;
+
+  /* other depths go through SDL */
+  if (screen->format->BytesPerPixel != 4)
+  {
+	SDL_SetColors(frame, RCA_PALETTE__COLORS, 0, 256);
+	SDL_BlitSurface(frame, NULL, screen, NULL);
+	return;
+  }
+
+  for (i = 0; i < 256; i++)
+  {
+	native[i] = SDL_MapRGB(screen->format, RCA_PALETTE__COLORS[i].r, RCA_PALETTE__COLORS[i].g, RCA_PALETTE__COLORS[i].b);
+  }
+
+  SDL_LockSurface(screen);
+  for (y = 0; y < frame->h; y++)
+  {
+	source = (Uint8 *)frame->pixels + y * frame->pitch;
+	destination = (Uint32 *)((Uint8 *)screen->pixels + y * screen->pitch);
+	for (x = 0; x < frame->w; x++)
+	{
+	  destination[x] = native[source[x]];
+	}
+  }
+  SDL_UnlockSurface(screen);
+}
+
+#endif
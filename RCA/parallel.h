@@ -0,0 +1,82 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Parallel loop over SDL threads.  The indexes are handed out by chunks
+ * from a shared counter, so threads that get the cheap indexes take more
+ * of them.  The body must only write what belongs to its index.
+ */
+
+#include "SDL.h"
+
+#ifndef RCA_PARALLEL_H_
+#define RCA_PARALLEL_H_
+
+#define RCA_PARALLEL_CHUNK 64			/* indexes taken at once */
+#define RCA_PARALLEL_MAX_THREADS 64
+
+typedef struct {
+  int count;
+  int next;						/* next index handed out */
+  void (*body)(int index, void *data);
+  void *data;
+} ParallelLoop;
+
+/**
+ * Run the body on chunks of the loop until every index is taken.
+ * 
+ * @param data Pointer to a ParallelLoop.
+ * @return     0.
+ */
+int RCA_RunParallelLoop(void *data)
+{
+  ParallelLoop *loop = data;
+  int first, last, index;
+
+  for (;;)
+  {
+	first = __atomic_fetch_add(&loop->next, RCA_PARALLEL_CHUNK, __ATOMIC_RELAXED);
+	if (first >= loop->count)
+	  return 0;
+
+	last = (first + RCA_PARALLEL_CHUNK < loop->count) ? first + RCA_PARALLEL_CHUNK : loop->count;
+	for (index = first; index < last; index++)
+	{
+	  loop->body(index, loop->data);
+	}
+  }
+}
+
+/**
+ * Parallel for.
+ * 
+ * The calling thread works as well, so a single thread runs the whole
+ * loop in place.
+ * 
+ * @param count   Number of indexes (0 to count - 1).
+ * @param threads Number of threads (RCA_PARALLEL_MAX_THREADS at most).
+ * @param body    Called once for every index.
+ * @param data    Passed to the body.
+ */
+void RCA_ParallelFor(int count, int threads, void (*body)(int index, void *data), void *data)
+{
+  SDL_Thread *workers[RCA_PARALLEL_MAX_THREADS];
+  ParallelLoop loop = {count, 0, body, data};
+  int i;
+
+  if (threads > RCA_PARALLEL_MAX_THREADS)
+	threads = RCA_PARALLEL_MAX_THREADS;
+
+  for (i = 1; i < threads; i++)
+  {
+	workers[i] = SDL_CreateThread(RCA_RunParallelLoop, &loop);
+  }
+  RCA_RunParallelLoop(&loop);
+  for (i = 1; i < threads; i++)
+  {
+	SDL_WaitThread(workers[i], NULL);
+  }
+}
+
+#endif
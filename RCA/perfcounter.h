@@ -0,0 +1,485 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Hardware performance counters (Linux perf_event_open).  Cycles,
+ * instructions, L1 data cache misses, last level cache misses and branch
+ * misses are counted for the thread that opened them, and attributed to
+ * the stage of the drawing being done: the traversal (BSP tree, culling),
+ * the intersection of the rays with the walls and the rasterization of
+ * the hits.  Everything else of the frame is counted apart.
+ * 
+ * The drawing code enters a stage with RCA_EnterPerfStage, which does
+ * nothing unless the thread is counting a frame.  The counters are read
+ * with rdpmc when the kernel allows it (a few dozens of cycles), with a
+ * read of the event otherwise.  Counting has a cost of its own: times
+ * measured while counting aren't comparable to times measured without,
+ * and the walk of a ray in the compiled tree switches stage at every leaf.
+ * 
+ * When there are more events than counters the kernel takes turns
+ * (multiplexing) and the group is only counted part of the time; the
+ * counts are scaled by the time the group was enabled over the time it
+ * was running, stage by stage.
+ */
+
+#include <assert.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef RCA_PERFCOUNTER_H_
+#define RCA_PERFCOUNTER_H_
+
+#define RCA_PERFCOUNTER_TYPE (1<<15)	/* dynamic type checking */
+
+#define RCA_PERFCOUNTER_CYCLES 0		/* events counted */
+#define RCA_PERFCOUNTER_INSTRUCTIONS 1
+#define RCA_PERFCOUNTER_L1_MISSES 2
+#define RCA_PERFCOUNTER_LLC_MISSES 3
+#define RCA_PERFCOUNTER_BRANCH_MISSES 4
+#define RCA_PERFCOUNTER_EVENTS 5
+
+#define RCA_PERFCOUNTER_OTHER 0			/* stages of a frame */
+#define RCA_PERFCOUNTER_TRAVERSAL 1
+#define RCA_PERFCOUNTER_INTERSECTION 2
+#define RCA_PERFCOUNTER_RASTERIZATION 3
+#define RCA_PERFCOUNTER_STAGES 4
+
+unsigned int RCA_PERFCOUNTER__TYPES[RCA_PERFCOUNTER_EVENTS] = {
+  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE
+};
+unsigned long long RCA_PERFCOUNTER__CONFIGS[RCA_PERFCOUNTER_EVENTS] = {
+  PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+  PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+const char *RCA_PERFCOUNTER__STAGE_NAMES[RCA_PERFCOUNTER_STAGES] = {"other", "traversal", "intersection", "rasterization"};
+
+/**
+ * PerfCounters class.
+ */
+typedef struct {
+  unsigned int type;
+  int fds[RCA_PERFCOUNTER_EVENTS];		/* -1 if the event can't be counted */
+  struct perf_event_mmap_page *pages[RCA_PERFCOUNTER_EVENTS];	/* to read with rdpmc, or NULL */
+  int leader;							/* event leading the group */
+  int stage;							/* being counted */
+  unsigned long long entered[RCA_PERFCOUNTER_EVENTS];			/* counters when it was entered */
+  unsigned long long entered_time[2];							/* time enabled and running when it was entered */
+  unsigned long long frame[RCA_PERFCOUNTER_STAGES][RCA_PERFCOUNTER_EVENTS];	/* counted during the last frame */
+  unsigned long long frame_time[RCA_PERFCOUNTER_STAGES][2];
+  unsigned long long total[RCA_PERFCOUNTER_STAGES][RCA_PERFCOUNTER_EVENTS];
+  unsigned long long total_time[RCA_PERFCOUNTER_STAGES][2];
+  int frames;
+} PerfCounters;
+
+__thread PerfCounters *RCA_PERFCOUNTER__ACTIVE = NULL;	/* frame counted by the thread, or NULL */
+
+/**
+ * Constructor.
+ * 
+ * The events are opened as a group, so that they are all counted at the
+ * same time; an event the processor doesn't have is left out.
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_ConstructPerfCounters(PerfCounters *counters)
+{
+  struct perf_event_attr attr;
+  long page_size = sysconf(_SC_PAGESIZE);
+  int e;
+  void *page;
+
+  /* here OR the RCA_PERFCOUNTER_TYPE constant into the type */
+  counters->type |= RCA_PERFCOUNTER_TYPE;
+
+  counters->leader = -1;
+  for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+  {
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = RCA_PERFCOUNTER__TYPES[e];
+	attr.config = RCA_PERFCOUNTER__CONFIGS[e];
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	/* this thread, on any processor */
+	counters->fds[e] = syscall(SYS_perf_event_open, &attr, 0, -1,
+							   (counters->leader < 0) ? -1 : counters->fds[counters->leader], 0);
+	counters->pages[e] = NULL;
+	if (counters->fds[e] < 0)
+	{
+	  counters->fds[e] = -1;
+	  continue;
+	}
+	if (counters->leader < 0)
+	  counters->leader = e;
+
+	page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, counters->fds[e], 0);
+	if (page != MAP_FAILED)
+	  counters->pages[e] = page;
+  }
+
+  counters->stage = RCA_PERFCOUNTER_OTHER;
+  memset(counters->entered, 0, sizeof(counters->entered));
+  memset(counters->entered_time, 0, sizeof(counters->entered_time));
+  memset(counters->frame, 0, sizeof(counters->frame));
+  memset(counters->frame_time, 0, sizeof(counters->frame_time));
+  memset(counters->total, 0, sizeof(counters->total));
+  memset(counters->total_time, 0, sizeof(counters->total_time));
+  counters->frames = 0;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_CheckPerfCounters(PerfCounters *counters)
+{
+  /* check if we have a valid PerfCounters object */
+  if (counters == NULL ||
+	  !(counters->type & RCA_PERFCOUNTER_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_DestroyPerfCounters(PerfCounters *counters)
+{
+  int e;
+
+  /* check if we have a valid PerfCounters object */
+  RCA_CheckPerfCounters(counters);
+
+  if (RCA_PERFCOUNTER__ACTIVE == counters)
+	RCA_PERFCOUNTER__ACTIVE = NULL;
+
+  /* set type to 0 indicate this is no longer a PerfCounters object */
+  counters->type = 0;
+
+  /* the members of the group before the leader */
+  for (e = RCA_PERFCOUNTER_EVENTS - 1; e >= 0; e--)
+  {
+	if (counters->pages[e] != NULL)
+	  munmap(counters->pages[e], sysconf(_SC_PAGESIZE));
+	if (counters->fds[e] >= 0)
+	  close(counters->fds[e]);
+  }
+
+  /* free the memory allocated for the object */
+  free(counters);
+}
+
+/**
+ * New.
+ * 
+ * @return An object PerfCounters, or NULL if no event can be counted
+ *         (no access to the counters, or none in a virtual machine).
+ */
+PerfCounters *RCA_NewPerfCounters(void)
+{
+  int e;
+  PerfCounters *counters = malloc(sizeof(PerfCounters));
+  counters->type = RCA_PERFCOUNTER_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructPerfCounters(counters);
+
+  for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+  {
+	if (counters->fds[e] >= 0)
+	  return counters;
+  }
+
+  RCA_DestroyPerfCounters(counters);
+  return NULL;
+}
+
+/**
+ * Read a counter.
+ * 
+ * With rdpmc while the event is on the processor, as told by the page
+ * the kernel maps for it (read again if it changed meanwhile).
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ * @param event    Event counted (RCA_PERFCOUNTER_CYCLES...).
+ * @return         Value of the counter.
+ */
+unsigned long long RCA_ReadPerfCounter(PerfCounters *counters, int event)
+{
+  unsigned long long value = 0, values[3];
+
+#if defined(__x86_64__) || defined(__i386__)
+  struct perf_event_mmap_page *page = counters->pages[event];
+  unsigned int lock, index, low, high;
+  unsigned long long pmc;
+  int width;
+
+  if (page != NULL && page->cap_user_rdpmc)
+  {
+	do
+	{
+	  lock = page->lock;
+	  __asm__ __volatile__("" ::: "memory");
+	  index = page->index;
+	  value = page->offset;
+	  width = page->pmc_width;
+	  if (index != 0)
+	  {
+		__asm__ __volatile__("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+		pmc = ((unsigned long long)high << 32) | low;
+
+		/* sign extended from the width of the counter */
+		value += (unsigned long long)((long long)(pmc << (64 - width)) >> (64 - width));
+	  }
+	  __asm__ __volatile__("" ::: "memory");
+	} while (page->lock != lock);
+
+	if (index != 0)
+	  return value;
+  }
+#endif
+
+  /* value, time enabled and time running */
+  if (read(counters->fds[event], values, sizeof(values)) != sizeof(values))
+	return 0;
+
+  return values[0];
+}
+
+/**
+ * Read the times of the group.
+ * 
+ * How long the group was enabled and how long it was on the processor.
+ * From the page of the leader and the time stamp counter when the events
+ * are read with rdpmc, with a read of the leader otherwise.
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ * @param time     Time enabled and time running, in nanosecond (set).
+ */
+void RCA_ReadPerfTimes(PerfCounters *counters, unsigned long long time[2])
+{
+  unsigned long long values[3];
+
+#if defined(__x86_64__) || defined(__i386__)
+  struct perf_event_mmap_page *page = counters->pages[counters->leader];
+  unsigned int lock, index, low, high;
+  unsigned long long cycles, delta;
+
+  if (page != NULL && page->cap_user_rdpmc && page->cap_user_time)
+  {
+	do
+	{
+	  lock = page->lock;
+	  __asm__ __volatile__("" ::: "memory");
+	  index = page->index;
+	  time[0] = page->time_enabled;
+	  time[1] = page->time_running;
+	  __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+	  cycles = ((unsigned long long)high << 32) | low;
+
+	  /* time since the page was updated */
+	  delta = page->time_offset + (cycles >> page->time_shift) * page->time_mult +
+			  (((cycles & ((1ULL << page->time_shift) - 1)) * page->time_mult) >> page->time_shift);
+	  __asm__ __volatile__("" ::: "memory");
+	} while (page->lock != lock);
+
+	time[0] += delta;
+	if (index != 0)
+	  time[1] += delta;
+	return;
+  }
+#endif
+
+  if (read(counters->fds[counters->leader], values, sizeof(values)) != sizeof(values))
+  {
+	time[0] = time[1] = 0;
+	return;
+  }
+
+  time[0] = values[1];
+  time[1] = values[2];
+}
+
+/**
+ * Scale a count to the time the group was enabled.
+ * 
+ * @param count Counted.
+ * @param time  Time enabled and time running while it was counted.
+ * @return      What would have been counted with the group always running.
+ */
+double RCA_ScalePerfCount(unsigned long long count, unsigned long long time[2])
+{
+  if (time[1] == 0 || time[1] >= time[0])
+	return count;
+
+  return (double)count * time[0] / time[1];
+}
+
+/**
+ * Enter a stage.
+ * 
+ * What was counted since the last stage was entered goes to that stage.
+ * Does nothing unless the thread is counting a frame.
+ * 
+ * @param stage Stage entered (RCA_PERFCOUNTER_TRAVERSAL...).
+ * @return      Stage left, to enter it again when done.
+ */
+int RCA_EnterPerfStage(int stage)
+{
+  PerfCounters *counters = RCA_PERFCOUNTER__ACTIVE;
+  unsigned long long now, time[2];
+  int e, left;
+
+  if (counters == NULL)
+	return RCA_PERFCOUNTER_OTHER;
+
+  left = counters->stage;
+  if (stage == left)
+	return left;
+
+  for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+  {
+	if (counters->fds[e] < 0)
+	  continue;
+	now = RCA_ReadPerfCounter(counters, e);
+	counters->frame[left][e] += now - counters->entered[e];
+	counters->entered[e] = now;
+  }
+  RCA_ReadPerfTimes(counters, time);
+  for (e = 0; e < 2; e++)
+  {
+	counters->frame_time[left][e] += time[e] - counters->entered_time[e];
+	counters->entered_time[e] = time[e];
+  }
+  counters->stage = stage;
+
+  return left;
+}
+
+/**
+ * Begin counting a frame.
+ * 
+ * Done by the thread that opened the counters.
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_BeginPerfFrame(PerfCounters *counters)
+{
+  int e;
+
+  /* check if we have a valid PerfCounters object */
+  RCA_CheckPerfCounters(counters);
+
+  memset(counters->frame, 0, sizeof(counters->frame));
+  memset(counters->frame_time, 0, sizeof(counters->frame_time));
+  for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+  {
+	if (counters->fds[e] >= 0)
+	  counters->entered[e] = RCA_ReadPerfCounter(counters, e);
+  }
+  RCA_ReadPerfTimes(counters, counters->entered_time);
+  counters->stage = RCA_PERFCOUNTER_OTHER;
+  RCA_PERFCOUNTER__ACTIVE = counters;
+}
+
+/**
+ * End counting a frame.
+ * 
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_EndPerfFrame(PerfCounters *counters)
+{
+  int s, e;
+
+  /* check if we have a valid PerfCounters object */
+  RCA_CheckPerfCounters(counters);
+
+  RCA_EnterPerfStage(RCA_PERFCOUNTER_OTHER);
+  RCA_PERFCOUNTER__ACTIVE = NULL;
+
+  for (s = 0; s < RCA_PERFCOUNTER_STAGES; s++)
+  {
+	for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+	{
+	  counters->total[s][e] += counters->frame[s][e];
+	}
+	counters->total_time[s][0] += counters->frame_time[s][0];
+	counters->total_time[s][1] += counters->frame_time[s][1];
+  }
+  counters->frames++;
+}
+
+/**
+ * Print the counters of the last frame.
+ * 
+ * Every event of every stage, in order (stages first), on the same line
+ * as whatever was printed before; -1 for an event that can't be counted.
+ * Scaled if the group was multiplexed.
+ * 
+ * @param stream   Where to print the counters.
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_PrintPerfFrame(FILE *stream, PerfCounters *counters)
+{
+  int s, e;
+
+  for (s = 0; s < RCA_PERFCOUNTER_STAGES; s++)
+  {
+	for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+	{
+	  if (counters->fds[e] < 0)
+		fprintf(stream, " -1");
+	  else
+		fprintf(stream, " %.0f", RCA_ScalePerfCount(counters->frame[s][e], counters->frame_time[s]));
+	}
+  }
+}
+
+/**
+ * Print counters summary.
+ * 
+ * Mean of every event per frame, stage by stage (-1 for an event that
+ * can't be counted), scaled if the group was multiplexed.
+ * 
+ * @param stream   Where to print the summary.
+ * @param counters Pointer to a PerfCounters object.
+ */
+void RCA_PrintPerfSummary(FILE *stream, PerfCounters *counters)
+{
+  int s, e;
+  double mean[RCA_PERFCOUNTER_EVENTS];
+
+  if (counters->frames == 0)
+	return;
+
+  for (s = 0; s < RCA_PERFCOUNTER_STAGES; s++)
+  {
+	for (e = 0; e < RCA_PERFCOUNTER_EVENTS; e++)
+	{
+	  mean[e] = (counters->fds[e] < 0) ? -1 : RCA_ScalePerfCount(counters->total[s][e], counters->total_time[s]) / counters->frames;
+	}
+
+	fprintf(stream, "%s: %.0f cycles, %.0f instructions (%.2f per cycle), %.0f L1 misses, %.0f LLC misses, %.0f branch misses"
+			" per frame\n", RCA_PERFCOUNTER__STAGE_NAMES[s], mean[RCA_PERFCOUNTER_CYCLES], mean[RCA_PERFCOUNTER_INSTRUCTIONS],
+			(mean[RCA_PERFCOUNTER_CYCLES] > 0) ? mean[RCA_PERFCOUNTER_INSTRUCTIONS] / mean[RCA_PERFCOUNTER_CYCLES] : 0,
+			mean[RCA_PERFCOUNTER_L1_MISSES], mean[RCA_PERFCOUNTER_LLC_MISSES], mean[RCA_PERFCOUNTER_BRANCH_MISSES]);
+  }
+}
+
+#endif
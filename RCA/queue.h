@@ -0,0 +1,194 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Bounded queue shared by threads.  Pushing blocks while the queue is
+ * full and popping blocks while it is empty, so a slow consumer holds
+ * back the producers instead of letting the memory grow.  Once closed,
+ * the items left are still popped, then popping returns NULL.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include "SDL.h"
+
+#ifndef RCA_QUEUE_H_
+#define RCA_QUEUE_H_
+
+#define RCA_QUEUE_TYPE (1<<8)		/* dynamic type checking */
+
+/**
+ * Queue class.
+ */
+typedef struct {
+  unsigned int type;
+  void **items;					/* ring buffer */
+  int capacity;
+  int head;						/* next item popped */
+  int count;
+  int closed;
+  SDL_mutex *lock;
+  SDL_cond *not_empty;
+  SDL_cond *not_full;
+} Queue;
+
+/**
+ * Constructor.
+ * 
+ * @param queue    Pointer to a Queue object.
+ * @param capacity Maximum number of items waiting.
+ */
+void RCA_ConstructQueue(Queue *queue, int capacity)
+{
+  /* here OR the RCA_QUEUE_TYPE constant into the type */
+  queue->type |= RCA_QUEUE_TYPE;
+
+  queue->items = malloc(capacity * sizeof(void *));
+  queue->capacity = capacity;
+  queue->head = 0;
+  queue->count = 0;
+  queue->closed = 0;
+  queue->lock = SDL_CreateMutex();
+  queue->not_empty = SDL_CreateCond();
+  queue->not_full = SDL_CreateCond();
+}
+
+/**
+ * New.
+ * 
+ * @param capacity Maximum number of items waiting.
+ * @return         An object Queue.
+ */
+Queue *RCA_NewQueue(int capacity)
+{
+  Queue *queue = malloc(sizeof(Queue));
+  queue->type = RCA_QUEUE_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructQueue(queue, capacity);
+
+  return queue;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param queue Pointer to a Queue object.
+ */
+void RCA_CheckQueue(Queue *queue)
+{
+  /* check if we have a valid Queue object */
+  if (queue == NULL ||
+	  !(queue->type & RCA_QUEUE_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * No thread may be using the queue anymore.  The items are not
+ * destroyed, they belong to whoever pushed them.
+ * 
+ * @param queue Pointer to a Queue object.
+ */
+void RCA_DestroyQueue(Queue *queue)
+{
+  /* check if we have a valid Queue object */
+  RCA_CheckQueue(queue);
+
+  /* set type to 0 indicate this is no longer a Queue object */
+  queue->type = 0;
+
+  /* free the memory allocated for the object */
+  SDL_DestroyCond(queue->not_full);
+  SDL_DestroyCond(queue->not_empty);
+  SDL_DestroyMutex(queue->lock);
+  free(queue->items);
+  free(queue);
+}
+
+/**
+ * Push an item.
+ * 
+ * Waits while the queue is full.
+ * 
+ * @param queue Pointer to a Queue object.
+ * @param item  Item to push (not NULL).
+ */
+void RCA_PushToQueue(Queue *queue, void *item)
+{
+  /* check if we have a valid Queue object */
+  RCA_CheckQueue(queue);
+
+  SDL_mutexP(queue->lock);
+  while (queue->count == queue->capacity)
+  {
+	SDL_CondWait(queue->not_full, queue->lock);
+  }
+
+  queue->items[(queue->head + queue->count) % queue->capacity] = item;
+  queue->count++;
+
+  SDL_CondSignal(queue->not_empty);
+  SDL_mutexV(queue->lock);
+}
+
+/**
+ * Pop an item.
+ * 
+ * Waits while the queue is empty and still open.
+ * 
+ * @param queue Pointer to a Queue object.
+ * @return      The oldest item or NULL (closed and empty).
+ */
+void *RCA_PopFromQueue(Queue *queue)
+{
+  void *item = NULL;
+
+  /* check if we have a valid Queue object */
+  RCA_CheckQueue(queue);
+
+  SDL_mutexP(queue->lock);
+  while (queue->count == 0 && !queue->closed)
+  {
+	SDL_CondWait(queue->not_empty, queue->lock);
+  }
+
+  if (queue->count > 0)
+  {
+	item = queue->items[queue->head];
+	queue->head = (queue->head + 1) % queue->capacity;
+	queue->count--;
+	SDL_CondSignal(queue->not_full);
+  }
+
+  SDL_mutexV(queue->lock);
+
+  return item;
+}
+
+/**
+ * Close the queue.
+ * 
+ * Nothing more will be pushed, every thread waiting to pop is woken up.
+ * 
+ * @param queue Pointer to a Queue object.
+ */
+void RCA_CloseQueue(Queue *queue)
+{
+  /* check if we have a valid Queue object */
+  RCA_CheckQueue(queue);
+
+  SDL_mutexP(queue->lock);
+  queue->closed = 1;
+  SDL_CondBroadcast(queue->not_empty);
+  SDL_mutexV(queue->lock);
+}
+
+#endif
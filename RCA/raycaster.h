@@ -9,12 +9,32 @@
  
 #include <math.h>
 
+#include "bam.h"
+#include "colormap.h"
 #include "element.h"
+#include "hitlist.h"
+#include "lightmap.h"
+#include "lights.h"
+#include "palette.h"
+#include "perfcounter.h"
 #include "sector.h"
 
 #ifndef RCA_RAYCASTER_H_
 #define RCA_RAYCASTER_H_
 
+#define RCA_RAYCASTER_COLUMNS 256		/* number of rays casted per frame */
+#define RCA_RAYCASTER_FOV 60			/* field of view (in degree) */
+#define RCA_RAYCASTER_HALF_FOV ((Angle)(RCA_RAYCASTER_FOV / 2 * RCA_BAM_DEGREE))
+#define RCA_RAYCASTER_COLUMN_ANGLE ((Angle)(RCA_RAYCASTER_FOV * RCA_BAM_DEGREE / RCA_RAYCASTER_COLUMNS))	/* between two rays */
+#define RCA_RAYCASTER_SLICE_WIDTH 5		/* width of a wall slice on screen */
+#define RCA_RAYCASTER_PLATFORM_SHADE 8	/* platforms are darker than the floor (in light level) */
+#define RCA_RAYCASTER_ADAPTIVE_STEP 8	/* columns between the rays always casted (adaptive casting) */
+#define RCA_RAYCASTER_PACKET 8			/* rays traced together by the wall casting (4, 8 or 16) */
+
+__thread double RCA_RAYCASTER__DEPTH_BUFFER[RCA_RAYCASTER_COLUMNS];	/* one per thread rendering */
+int RCA_RAYCASTER__FLOOR_COLOR[4] = {0, 0, 100, 255};
+int RCA_RAYCASTER__CEILING_COLOR[4] = {100, 0, 0, 255};
+
 /**
  * Find slope of wall (gradient).
  * 
@@ -38,25 +58,25 @@ double RCA_FindWallsGradient(double wall[4])
  * @param angle_of_ray Angle of the ray casted.
  * @return             Slope (gradient) of the line (ray).
  */
-double RCA_FindRaysGradient(double angle_of_ray)
+double RCA_FindRaysGradient(Angle angle_of_ray)
 {
-	if (angle_of_ray == 0 || angle_of_ray == 180)
-	  return 0;
-	else 
-	  return tan(angle_of_ray * M_PI / 180);		/* must handle infinite case ... */
+	return RCA_FineTangent(angle_of_ray);		/* HUGE_VAL straight up or down */
 }
 
 /**
  * Find Intersection of ray and wall.
  * 
- * @param element      Pointer to an Element object.
- * @param wall         An array containing the wall's start and end coordinate.
- * @param angle_of_ray Angle of the ray casted.
- * @return             Intersection point of the ray and wall.
+ * Same as RCA_FindWallIntersection, for a ray whose gradient is already
+ * known (it is the same for every wall of a column).
+ * 
+ * @param element       Pointer to an Element object.
+ * @param wall          An array containing the wall's start and end coordinate.
+ * @param rays_gradient Slope (gradient) of the ray casted.
+ * @return              Intersection point of the ray and wall.
  */
-double *RCA_FindWallIntersection(Element *element, double wall[4], double angle_of_ray)
+double *RCA_FindWallIntersectionWithRay(Element *element, double wall[4], double rays_gradient)
 {
-  static double intersection[2] = {0, 0};
+  static __thread double intersection[2] = {0, 0};
 	
   double b1;
   double x, y;
@@ -65,7 +85,7 @@ double *RCA_FindWallIntersection(Element *element, double wall[4], double angle_
   double x1 = wall[0]; double y1 = wall[1];
   double x2 = wall[2]; double y2 = wall[3];
   double m1 = RCA_FindWallsGradient(wall);
-  double m2 = RCA_FindRaysGradient(angle_of_ray);
+  double m2 = rays_gradient;
   
   /* handling the infinite case and more... */
   if (m1 == 0 && m2 == 0)
@@ -114,6 +134,19 @@ double *RCA_FindWallIntersection(Element *element, double wall[4], double angle_
   return intersection;
 }
 
+/**
+ * Find Intersection of ray and wall.
+ * 
+ * @param element      Pointer to an Element object.
+ * @param wall         An array containing the wall's start and end coordinate.
+ * @param angle_of_ray Angle of the ray casted.
+ * @return             Intersection point of the ray and wall.
+ */
+double *RCA_FindWallIntersection(Element *element, double wall[4], Angle angle_of_ray)
+{
+  return RCA_FindWallIntersectionWithRay(element, wall, RCA_FindRaysGradient(angle_of_ray));
+}
+
 /**
  * Getting distance to wall slice.
  * 
@@ -122,14 +155,13 @@ double *RCA_FindWallIntersection(Element *element, double wall[4], double angle_
  * @param angle_of_ray Angle of the ray casted.
  * @return             Distance to wall.
  */
-double RCA_GettingDistanceToWall(Element *element, double *intersection, double angle_of_ray)
+double RCA_GettingDistanceToWall(Element *element, double *intersection, Angle angle_of_ray)
 {
   double distance;
   double x_diff, y_diff;	
 
   double playerx = element->x; double playery = element->y;	
   double xs = intersection[0]; double ys = intersection[1];
-  double angle = angle_of_ray;	
 	
   x_diff = fabs(playerx - xs);
   y_diff = fabs(playery - ys);
@@ -160,30 +192,22 @@ double RCA_GettingHeightOfWall(double distance)
   return height;
 }
 
-/* ------------------------------------------------------------------------------------------ */
 /**
- * Check angle limit.
+ * Clear depth buffer.
  * 
- * @param angle Angle to check.
- * @return      Corrected angle (if needed).
+ * Must be called once per frame before the walls are casted.
  */
-double RCA_CheckAngleLimit(double angle)
+void RCA_ClearDepthBuffer(void)
 {
-  double correct_angle = angle;
-
-  /* check angle limits */
-  if (angle < 0)
-  {
-	correct_angle = angle + 360;
-  }
-  if (angle >= 360)
+  int i;
+  
+  for (i = 0; i < RCA_RAYCASTER_COLUMNS; i++)
   {
-	correct_angle = angle - 360;
+	RCA_RAYCASTER__DEPTH_BUFFER[i] = HUGE_VAL;
   }
-  
-  return correct_angle;
 }
 
+/* ------------------------------------------------------------------------------------------ */
 /**
  * Check wall limit.
  * 
@@ -202,45 +226,6 @@ int RCA_CheckWallLimit(double wall[4], double xs, double ys)
   return 1;
 }
 
-/**
- * Get quadrant for angle.
- * 
- * @param angle Angle to get quadrant for.
- * @return      Quadrant in which angle is.
- */
-int RCA_GetQuadrant(double angle)
-{
-  if ((angle >= 0) && (angle < 90)) return(1);          /* angle in first quadrant */
-  if ((angle >= 90) && (angle < 180)) return(2);        /* angle in second quadrant */
-  if ((angle >= 180) && (angle < 270)) return(3);       /* angle in third quadrant */
-  if ((angle >= 270) && (angle < 360)) return(4);       /* angle in fourth quadrant */
-}
-
-/**
- * Get quadrant for intersection point.
- * 
- * @param element Pointer to an Element object.
- * @param xs      Intersection point.
- * @param ys      Intersection point.
- * @return        Quadrant in which intersection point is.
- */
-int RCA_GetIntersectionQuadrant(Element *element, double xs, double ys)
-{
-  double x_diff, y_diff;
-
-  x_diff = -element->x + xs;
-  y_diff = -element->y + ys;
-
-  if (x_diff > 0) 
-  {
-	if (y_diff < 0) return(4); else return(1);
-  } 
-  else 
-  {
-	if (y_diff < 0) return(3); else return(2);
-  }  
-}
-
 /**
  * Check correctness of intersection.
  * 
@@ -250,37 +235,34 @@ int RCA_GetIntersectionQuadrant(Element *element, double xs, double ys)
  * @param angle_of_ray Angle of the ray casted.
  * @return             True (1) or false (0) depending of the ray and intersection position.
  */
-int RCA_CorrectIntersection(Element *element, double xs, double ys, double angle_of_ray)
+int RCA_CorrectIntersection(Element *element, double xs, double ys, Angle angle_of_ray)
 {
-  /* this doesn't work quite right */
-  /* if (RCA_GetIntersectionQuadrant(element, xs, ys) == RCA_GetQuadrant(angle_of_ray)) return(1); else return(0); */
-  
-  double adj, opp;
-  double angle;
-
-  adj = -element->x + xs;
-  opp = -element->y + ys;
-  
-  if (adj == 0 && opp >= 0)
-	angle = 90;
-  else if (adj == 0)
-	angle = 270;	
-  else if (adj > 0 && opp >= 0)
-	angle = fabs(atan(opp / adj)) * 180 / M_PI;
-  else if (adj < 0 && opp >= 0)
-	angle = 180 - fabs(atan(opp / adj)) * 180 / M_PI;
-  else if (adj < 0 && opp < 0)
-	angle = 180 + fabs(atan(opp / adj)) * 180 / M_PI;
-  else
-	angle = 360 - fabs(atan(opp / adj)) * 180 / M_PI;
-  
-  if (fabs(angle - angle_of_ray) < 10 || fabs(angle - angle_of_ray) > 350)
+  /* the ray is a line, the intersection must be ahead and not behind */
+  if ((xs - element->x) * RCA_FineCosine(angle_of_ray) + (ys - element->y) * RCA_FineSine(angle_of_ray) >= 0)
 	return (1);
   else
 	return (0);
 }
 /* ------------------------------------------------------------------------------------------ */
 
+/**
+ * Draw a slice.
+ * 
+ * Every part of a slice (walls, floor and ceiling) is drawn through
+ * here, shaded with the colormap (or the palette).
+ * 
+ * @param screen         A copy of the current SDL surface.
+ * @param slice_position Position of current wall slice.
+ * @param top            Top of the slice.
+ * @param bottom         Bottom of the slice.
+ * @param color          Colour of the slice (unshaded).
+ * @param level          Light level.
+ */
+void RCA_DrawSlice(SDL_Surface *screen, int slice_position, int top, int bottom, int color[4], int level)
+{
+  RCA_FillBox(screen, slice_position, top, slice_position + RCA_RAYCASTER_SLICE_WIDTH, bottom, color, level);
+}
+
 /**
  * Floor casting.
  * 
@@ -288,16 +270,11 @@ int RCA_CorrectIntersection(Element *element, double xs, double ys, double angle
  * @param position_of_wall Position of the wall being drawn.
  * @param bottom_of_wall   Bottom of the wall being drawn.
  * @param top_of_wall      Top of previous wall drawn.
- * @param shade			   Shade for the floor.
+ * @param level			   Light level of the floor.
  */
-void RCA_FloorCasting(SDL_Surface *screen, int position_of_wall, int bottom_of_wall, int top_of_wall, int shade)
+void RCA_FloorCasting(SDL_Surface *screen, int position_of_wall, int bottom_of_wall, int top_of_wall, int level)
 {
-  int x1 = position_of_wall;
-  int y1 = bottom_of_wall;
-  int x2 = x1 + 5;
-  int y2 = top_of_wall;
-	
-  boxRGBA(screen, x1, y1, x2, y2, 0, 0, 100 + shade, 255);
+  RCA_DrawSlice(screen, position_of_wall, bottom_of_wall, top_of_wall, RCA_RAYCASTER__FLOOR_COLOR, level);
 }
 
 /**
@@ -307,164 +284,329 @@ void RCA_FloorCasting(SDL_Surface *screen, int position_of_wall, int bottom_of_w
  * @param position_of_wall     Position of the wall being drawn.
  * @param top_of_wall          Top of the wall being drawn.
  * @param top_of_previous_wall Top of previous wall drawn.
- * @param shade			       Shade for the ceiling.
+ * @param level			       Light level of the ceiling.
  */
-void RCA_CeilingCasting(SDL_Surface *screen, int position_of_wall, int top_of_wall, int top_of_previous_wall, int shade)
+void RCA_CeilingCasting(SDL_Surface *screen, int position_of_wall, int top_of_wall, int top_of_previous_wall, int level)
 {
-  int x1 = position_of_wall;
-  int y1 = top_of_wall;
-  int x2 = x1 + 5;
-  int y2 = top_of_previous_wall;
-	
-  boxRGBA(screen, x1, y1, x2, y2, 100 + shade, 0, 0, 255);
+  RCA_DrawSlice(screen, position_of_wall, top_of_wall, top_of_previous_wall, RCA_RAYCASTER__CEILING_COLOR, level);
 }
 
 /**
- * Bottom wall casting.
+ * Draw a slice inside the clip window.
  * 
  * @param screen         A copy of the current SDL surface.
- * @param wall           Pointer to a Sector object.
  * @param slice_position Position of current wall slice.
- * @param top            Top of wall.
- * @param bottom         Bottom of wall.
- * @param middle_top     Top of 'middle wall'.
- * @param middle_bottom  Bottom of 'middle wall'.
+ * @param y1             One end of the slice.
+ * @param y2             Other end of the slice.
+ * @param clip_top       Top of what is still to be drawn in the column.
+ * @param clip_bottom    Bottom of what is still to be drawn in the column.
+ * @param color          Colour of the slice (unshaded).
+ * @param level          Light level.
  */
-void RCA_BottomWallCasting(SDL_Surface *screen, Sector *wall[2], int slice_position, int top[2], int bottom[2], int middle_top[2], int middle_bottom[2])
+void RCA_DrawClippedSlice(SDL_Surface *screen, int slice_position, int y1, int y2, int clip_top, int clip_bottom, int color[4], int level)
 {
-  if (wall[1] == NULL)
+  int top = (y1 < y2) ? y1 : y2;
+  int bottom = (y1 < y2) ? y2 : y1;
+  
+  if (top < clip_top)
+	top = clip_top;
+  if (bottom > clip_bottom)
+	bottom = clip_bottom;
+  
+  if (top <= bottom)
+	RCA_DrawSlice(screen, slice_position, top, bottom, color, level);
+}
+
+/**
+ * Find limits of a wall slice on screen.
+ * 
+ * @param screen A copy of the current SDL surface.
+ * @param hit    Hit of the wall.
+ * @param limits Top, bottom, top of 'middle wall' and bottom of 'middle wall' (output).
+ */
+void RCA_FindSliceLimits(SDL_Surface *screen, Hit *hit, int limits[4])
+{
+  Sector *wall = hit->wall;
+  double height = RCA_GettingHeightOfWall(hit->corrected_distance);
+  double offset;
+  
+  limits[0] = (screen->h / 2) - (int)(height / 2);
+  limits[1] = limits[0] + (int)height;
+  limits[2] = limits[0] + (int)floor(wall->ceiling * height / 100);
+  limits[3] = limits[1] - (int)floor(wall->floor * height / 100);
+  
+  /* Slope floor */
+  if (wall->floor_slope != 0)
   {
-	if (wall[0] != NULL)
-	{
-	  if (wall[0]->floor != 0)
-	  {
-		boxRGBA(screen, slice_position, middle_bottom[0], slice_position + 5, bottom[0], wall[0]->bottom_color[0], wall[0]->bottom_color[1], 
-				wall[0]->bottom_color[2], wall[0]->bottom_color[3]);
-		
-		RCA_FloorCasting(screen, slice_position, middle_bottom[0], (screen->h - 1), -25);
-	  }
-	}
+	if (wall->floor_slope < 0)
+	  offset = sqrt(pow((hit->x - wall->x2), 2) + pow((hit->y - wall->y2), 2));
+	else
+	  offset = sqrt(pow((hit->x - wall->x1), 2) + pow((hit->y - wall->y1), 2));
+	
+	limits[3] = limits[1] - (int)((offset * wall->floor_gradient) / wall->floor * (floor(wall->floor * height / 100))
+				+ (floor(fabs(wall->floor_slope) * height / 100)) * (wall->floor / fabs(wall->floor)));
   }
-  else
+  
+  /* Slope ceiling */
+  if (wall->ceiling_slope != 0)
   {
-	if (wall[0]->floor != 0)
-	{
-	  boxRGBA(screen, slice_position, middle_bottom[1], slice_position + 5, bottom[1], wall[1]->bottom_color[0], wall[1]->bottom_color[1], 
-			  wall[1]->bottom_color[2], wall[1]->bottom_color[3]);
-	  boxRGBA(screen, slice_position, middle_bottom[0], slice_position + 5, bottom[0], wall[0]->bottom_color[0], wall[0]->bottom_color[1], 
-			  wall[0]->bottom_color[2], wall[0]->bottom_color[3]);
-	  
-      if (middle_bottom[1] < middle_bottom[0])		  
-	    RCA_FloorCasting(screen, slice_position, middle_bottom[1], middle_bottom[0], -25);
-	}
+	if (wall->ceiling_slope < 0)
+	  offset = sqrt(pow((hit->x - wall->x2), 2) + pow((hit->y - wall->y2), 2));
+	else
+	  offset = sqrt(pow((hit->x - wall->x1), 2) + pow((hit->y - wall->y1), 2));
+	
+	limits[2] = limits[0] + (int)((offset * wall->ceiling_gradient) / wall->ceiling * (floor(wall->ceiling * height / 100))
+				+ (floor(fabs(wall->ceiling_slope) * height / 100)) * (wall->ceiling / fabs(wall->ceiling)));
   }
 }
 
 /**
- * Middle wall casting.
+ * Resolve a column.
+ * 
+ * The hits are drawn from the nearest to the farthest, inside a clip
+ * window which closes as the column gets covered.  Seen from outside, a
+ * wall shows its raised floor (bottom) and lowered ceiling (top); seen
+ * from inside, the floor and ceiling of the sector lead to it and a
+ * lowered floor or raised ceiling shows the inner side of the wall.  A
+ * visible middle wall closes the column.
+ * 
+ * A wall with a light map is shaded by the luxel it is hit at, the floor
+ * and ceiling up to it by the luxel of the floor at its base.  The
+ * dynamic lights of the cell of the hit are added to both.
  * 
  * @param screen         A copy of the current SDL surface.
- * @param wall           Pointer to a Sector object.
+ * @param hits           Hits of the column.
  * @param slice_position Position of current wall slice.
- * @param top            Top of wall.
- * @param bottom         Bottom of wall.
- * @param middle_top     Top of 'middle wall'.
- * @param middle_bottom  Bottom of 'middle wall'.
+ * @return               Distance (corrected) to the wall closing the column or HUGE_VAL.
  */
-void RCA_MiddleWallCasting(SDL_Surface *screen, Sector *wall[2], int slice_position, int top[2], int bottom[2], int middle_top[2], int middle_bottom[2])
+double RCA_ResolveHitList(SDL_Surface *screen, HitList *hits, int slice_position)
 {
-  if (wall[1] == NULL)
+  int k, level, floor_level, platform_level, dynamic;
+  int limits[4], top, bottom, middle_top, middle_bottom;
+  int clip_top = 0, clip_bottom = screen->h - 1;
+  Sector *wall;
+  Hit *hit;
+  
+  RCA_FindHitParity(hits);
+  RCA_OrderHitTies(hits);
+  
+  for (k = 0; k < hits->count && clip_top <= clip_bottom; k++)
   {
-	if (wall[0] != NULL)
-	{
-	  if (middle_top[0] < top[0])
-	    middle_top[0] = top[0];
-      if (middle_bottom[0] > bottom[0])
-	    middle_bottom[0] = bottom [0];	
-		
-	  if (wall[0]->middle_color[3] != 0)
-		boxRGBA(screen, slice_position, middle_top[0], slice_position + 5, middle_bottom[0], wall[0]->middle_color[0], wall[0]->middle_color[1], 
-				wall[0]->middle_color[2], wall[0]->middle_color[3]);
+	hit = &hits->hits[k];
+	wall = hit->wall;
 	
-	  if (wall[0]->floor == 0)
-	    RCA_FloorCasting(screen, slice_position, bottom[0], (screen->h - 1), 0);
-	  if (wall[0]->ceiling == 0)
-	    RCA_CeilingCasting(screen, slice_position, top[0], 0, 0);
-	} 
-  }
-  else
-  {
-	if (middle_top[1] < top[1])
-	  middle_top[1] = top[1];
-    if (middle_bottom[1] > bottom[1])
-	  middle_bottom[1] = bottom [1];
-    if (middle_bottom[1] > middle_bottom[0])
-	  middle_bottom[1] = middle_bottom[0];
-    if (middle_top[1] < middle_top[0])
-	  middle_top[1] = middle_top[0];  
+	RCA_FindSliceLimits(screen, hit, limits);
+	top = limits[0]; bottom = limits[1]; middle_top = limits[2]; middle_bottom = limits[3];
+	dynamic = RCA_SampleDynamicLight(hit->x, hit->y);
+	level = RCA_GetLightLevel(RCA_SampleWallLight(wall, hit->sector, hit->x, hit->y) + dynamic, hit->corrected_distance);
+	floor_level = RCA_GetLightLevel(RCA_SampleFloorLight(wall, hit->sector, hit->x, hit->y) + dynamic, hit->corrected_distance);
+	platform_level = RCA_ClampLightLevel(floor_level - RCA_RAYCASTER_PLATFORM_SHADE);
+	
+	/* seen from outside: the floor and ceiling in front of the sector, raised floor and lowered ceiling */
+	if (!hit->inside)
+	{
+	  if (bottom <= clip_bottom)
+		RCA_FloorCasting(screen, slice_position, (bottom > clip_top) ? bottom : clip_top, clip_bottom, floor_level);
+	  if (top >= clip_top)
+		RCA_CeilingCasting(screen, slice_position, (top < clip_bottom) ? top : clip_bottom, clip_top, floor_level);
+
+	  if (wall->floor > 0)
+	  {
+		RCA_DrawClippedSlice(screen, slice_position, middle_bottom, bottom, clip_top, clip_bottom, wall->bottom_color, level);
+		clip_bottom = (middle_bottom - 1 < clip_bottom) ? middle_bottom - 1 : clip_bottom;
+	  }
+	  else if (wall->floor < 0)
+	  {
+		clip_bottom = (bottom - 1 < clip_bottom) ? bottom - 1 : clip_bottom;
+	  }
 	  
-	if (wall[1]->middle_color[3] != 0)
+	  if (wall->ceiling > 0)
+	  {
+		RCA_DrawClippedSlice(screen, slice_position, top, middle_top, clip_top, clip_bottom, wall->top_color, level);
+		clip_top = (middle_top + 1 > clip_top) ? middle_top + 1 : clip_top;
+	  }
+	  else if (wall->ceiling < 0)
+	  {
+		clip_top = (top + 1 > clip_top) ? top + 1 : clip_top;
+	  }
+	}
+	
+	/* floor and ceiling up to the wall */
+	if (hit->inside || wall->middle_color[3] != 0)
 	{
-	  if (middle_bottom[1] > middle_top[1])
-	    boxRGBA(screen, slice_position, middle_top[1], slice_position + 5, middle_bottom[1], wall[1]->middle_color[0], wall[1]->middle_color[1], 
-			    wall[1]->middle_color[2], wall[1]->middle_color[3]);
+	  if (middle_bottom <= clip_bottom)
+		RCA_FloorCasting(screen, slice_position, (middle_bottom > clip_top) ? middle_bottom : clip_top, clip_bottom,
+						 (hit->inside && wall->floor != 0) ? platform_level : floor_level);
+	  if (middle_top >= clip_top)
+		RCA_CeilingCasting(screen, slice_position, (middle_top < clip_bottom) ? middle_top : clip_bottom, clip_top,
+						   (hit->inside && wall->ceiling != 0) ? platform_level : floor_level);
 	}
-	if (wall[0]->middle_color[3] != 0)
+	
+	/* seen from inside: lowered floor and raised ceiling */
+	if (hit->inside)
 	{
-	  boxRGBA(screen, slice_position, middle_top[0], slice_position + 5, middle_bottom[0], wall[0]->middle_color[0], wall[0]->middle_color[1], 
-			  wall[0]->middle_color[2], wall[0]->middle_color[3]);
-	  if (wall[0]->floor == 0)
-	    RCA_FloorCasting(screen, slice_position, middle_bottom[0], (screen->h - 1), 0);
-	  if (wall[0]->ceiling == 0)
-	    RCA_CeilingCasting(screen, slice_position, middle_top[0], 0, 0);
+	  if (wall->floor < 0)
+	  {
+		RCA_DrawClippedSlice(screen, slice_position, bottom, middle_bottom, clip_top, clip_bottom, wall->bottom_color, level);
+		clip_bottom = (bottom - 1 < clip_bottom) ? bottom - 1 : clip_bottom;
+	  }
+	  else
+	  {
+		clip_bottom = (middle_bottom - 1 < clip_bottom) ? middle_bottom - 1 : clip_bottom;
+	  }
+	  
+	  if (wall->ceiling < 0)
+	  {
+		RCA_DrawClippedSlice(screen, slice_position, middle_top, top, clip_top, clip_bottom, wall->top_color, level);
+		clip_top = (top + 1 > clip_top) ? top + 1 : clip_top;
+	  }
+	  else
+	  {
+		clip_top = (middle_top + 1 > clip_top) ? middle_top + 1 : clip_top;
+	  }
 	}
-	else 
+	
+	/* middle wall, nothing behind it is visible */
+	if (wall->middle_color[3] != 0)
 	{
-	  if (wall[0]->floor == 0)
-	    RCA_FloorCasting(screen, slice_position, middle_bottom[1], (screen->h - 1), 0);
-	  if (wall[0]->ceiling == 0)
-	    RCA_CeilingCasting(screen, slice_position, middle_top[1], 0, 0);	
+	  RCA_DrawClippedSlice(screen, slice_position, (middle_top > top) ? middle_top : top, (middle_bottom < bottom) ? middle_bottom : bottom,
+						   clip_top, clip_bottom, wall->middle_color, level);
+	  
+	  return hit->corrected_distance;
 	}
   }
+  
+  return HUGE_VAL;
 }
- 
+
 /**
- * Top wall casting.
+ * Cast a ray on a wall.
  * 
- * @param screen         A copy of the current SDL surface.
- * @param wall           Pointer to a Sector object.
- * @param slice_position Position of current wall slice.
- * @param top            Top of wall.
- * @param bottom         Bottom of wall.
- * @param middle_top     Top of 'middle wall'.
- * @param middle_bottom  Bottom of 'middle wall'.
+ * @param hits          Hits of the column (the wall is added if hit).
+ * @param element       Pointer to an Element object.
+ * @param sector        Pointer to a Sector object (the wall's).
+ * @param wall          Pointer to a Sector object (a wall).
+ * @param angle_of_ray  Angle of the ray casted.
+ * @param rays_gradient Slope (gradient) of the ray casted.
+ * @param correction    Fish-eye correction of the column.
  */
-void RCA_TopWallCasting(SDL_Surface *screen, Sector *wall[2], int slice_position, int top[2], int bottom[2], int middle_top[2], int middle_bottom[2])
+void RCA_CastRayOnWall(HitList *hits, Element *element, Sector *sector, Sector *wall, Angle angle_of_ray, double rays_gradient,
+					   double correction)
 {
-  if (wall[1] == NULL)
+  double *intersection;
+  double distance;
+  
+  intersection = RCA_FindWallIntersectionWithRay(element, RCA_WallOfSector(wall), rays_gradient);
+  
+  if (intersection != NULL &&
+	  RCA_CorrectIntersection(element, intersection[0], intersection[1], angle_of_ray) &&
+	  RCA_CheckWallLimit(RCA_WallOfSector(wall), intersection[0], intersection[1]))
   {
-	if (wall[0] != NULL)
-	{
-	  if (wall[0]->ceiling != 0)
-	  {
-		boxRGBA(screen, slice_position, top[0], slice_position + 5, middle_top[0], wall[0]->top_color[0], wall[0]->top_color[1], 
-				wall[0]->top_color[2], wall[0]->top_color[3]);
-		
-		RCA_CeilingCasting(screen, slice_position, middle_top[0], 0, -25);
-	  }
-	}
+	distance = RCA_GettingDistanceToWall(element, intersection, angle_of_ray);
+	RCA_UpdateWallConstants(wall);
+	
+	RCA_AddHitToList(hits, wall, sector, distance, distance * correction, intersection[0], intersection[1]);
   }
-  else
+}
+
+/**
+ * Cast a ray on the walls of a sector.
+ * 
+ * @param hits          Hits of the column (every wall hit is added).
+ * @param element       Pointer to an Element object.
+ * @param sector        Pointer to a Sector object.
+ * @param angle_of_ray  Angle of the ray casted.
+ * @param rays_gradient Slope (gradient) of the ray casted.
+ * @param correction    Fish-eye correction of the column.
+ */
+void RCA_CastRayOnSector(HitList *hits, Element *element, Sector *sector, Angle angle_of_ray, double rays_gradient, double correction)
+{
+  Sector *wall;
+  
+  for (wall = sector->first->next; wall != NULL; wall = wall->next)
   {
-	if (wall[0]->ceiling != 0)
-	{
-	  boxRGBA(screen, slice_position, top[1], slice_position + 5, middle_top[1], wall[1]->top_color[0], wall[1]->top_color[1], 
-			  wall[1]->top_color[2], wall[1]->top_color[3]);
-	  boxRGBA(screen, slice_position, top[0], slice_position + 5, middle_top[0], wall[0]->top_color[0], wall[0]->top_color[1], 
-			  wall[0]->top_color[2], wall[0]->top_color[3]);
+	RCA_CastRayOnWall(hits, element, sector, wall, angle_of_ray, rays_gradient, correction);
+  }
+}
+
+/**
+ * Check if a wall can be hit by the rays of a wedge.
+ * 
+ * Conservative, the wall is left out only when both its ends are more
+ * than a unit (the tolerance of the parallel cases of the intersection)
+ * on the same side of an edge of the wedge, or behind it.
+ * 
+ * @param element Pointer to an Element object (the apex).
+ * @param wall    Pointer to a Sector object (a wall).
+ * @param left    Direction of the leftmost ray (cosine and sine).
+ * @param right   Direction of the rightmost ray (cosine and sine).
+ * @param middle  Direction in the middle of the wedge (cosine and sine).
+ * @return        True (1) or false (0).
+ */
+int RCA_CheckWallInWedge(Element *element, Sector *wall, double left[2], double right[2], double middle[2])
+{
+  double x1 = wall->x1 - element->x, y1 = wall->y1 - element->y;
+  double x2 = wall->x2 - element->x, y2 = wall->y2 - element->y;
+  
+  /* right of the rightmost ray */
+  if (right[0] * y1 - right[1] * x1 < -1 && right[0] * y2 - right[1] * x2 < -1)
+	return 0;
+  
+  /* left of the leftmost ray */
+  if (left[0] * y1 - left[1] * x1 > 1 && left[0] * y2 - left[1] * x2 > 1)
+	return 0;
+  
+  /* behind */
+  if (middle[0] * x1 + middle[1] * y1 < -1 && middle[0] * x2 + middle[1] * y2 < -1)
+	return 0;
+  
+  return 1;
+}
+
+/**
+ * Cast a packet of rays on the walls of a sector.
+ * 
+ * The rays of consecutive columns are traced together.  Each wall is
+ * tested once against the wedge of the whole packet, and only the walls
+ * left are casted for every ray, so the walls are read once per packet
+ * instead of once per column.  The hits are the same as casting every
+ * ray alone.
+ * 
+ * @param hits    Hits of the columns (count of them, every wall hit is added).
+ * @param element Pointer to an Element object.
+ * @param sector  Pointer to a Sector object.
+ * @param first   Column of the first ray (0 is the leftmost ray).
+ * @param count   Number of rays (RCA_RAYCASTER_PACKET at most).
+ */
+void RCA_CastPacketOnSector(HitList *hits, Element *element, Sector *sector, int first, int count)
+{
+  int k;
+  Angle angles[RCA_RAYCASTER_PACKET];
+  double gradients[RCA_RAYCASTER_PACKET], corrections[RCA_RAYCASTER_PACKET];
+  double left[2], right[2], middle[2];
+  Angle middle_angle;
+  Sector *wall;
+  
+  for (k = 0; k < count; k++)
+  {
+	angles[k] = element->direction + RCA_RAYCASTER_HALF_FOV - (first + k) * RCA_RAYCASTER_COLUMN_ANGLE;
+	gradients[k] = RCA_FindRaysGradient(angles[k]);
+	corrections[k] = fabs(RCA_FineCosine(angles[k] - element->direction));
+  }
+  
+  middle_angle = angles[0] - (angles[0] - angles[count - 1]) / 2;
+  left[0] = RCA_FineCosine(angles[0]); left[1] = RCA_FineSine(angles[0]);
+  right[0] = RCA_FineCosine(angles[count - 1]); right[1] = RCA_FineSine(angles[count - 1]);
+  middle[0] = RCA_FineCosine(middle_angle); middle[1] = RCA_FineSine(middle_angle);
+  
+  for (wall = sector->first->next; wall != NULL; wall = wall->next)
+  {
+	if (!RCA_CheckWallInWedge(element, wall, left, right, middle))
+	  continue;
 	
-	  if (middle_top[1] > middle_top[0])
-	    RCA_CeilingCasting(screen, slice_position, middle_top[0], middle_top[1], -25);	
+	for (k = 0; k < count; k++)
+	{
+	  RCA_CastRayOnWall(&hits[k], element, sector, wall, angles[k], gradients[k], corrections[k]);
 	}
   }
 }
@@ -472,6 +614,8 @@ void RCA_TopWallCasting(SDL_Surface *screen, Sector *wall[2], int slice_position
 /**
  * Wall casting.
  * 
+ * The columns are casted by packets of RCA_RAYCASTER_PACKET rays.
+ * 
  * @param screen  A copy of the current SDL surface.
  * @param element Pointer to an Element object.
  * @param sector  Pointer to a Sector object.
@@ -481,155 +625,289 @@ void RCA_WallCasting(SDL_Surface *screen, Element *element, Sector *sector)
   if (sector == NULL)
     return;
 
-  int i = 0;
-  int flag = 0;
-  int bottom[2], top[2], middle_bottom[2], middle_top[2];
-  int current_bottom = 0, current_top = 0;
-  double *intersection = NULL;
-  double distance = 0, previous_distance = -1, corrected_distance = 0;
-  double height;
-  double ray_angle = element->direction + 30;
-  int slice_position = 1275;
-  Sector *wall[2] = {NULL, NULL};
-  
-  double offset, m, y;
+  int i, k, stage = RCA_EnterPerfStage(RCA_PERFCOUNTER_INTERSECTION);
+  double nearest_opaque;
+  HitList hits[RCA_RAYCASTER_PACKET];
 	
-  for (i = 0; i < 256; i++)
+  for (i = 0; i < RCA_RAYCASTER_COLUMNS; i += RCA_RAYCASTER_PACKET)
   {
-	bottom[0] = -1; bottom[1] = -1;
-	top[0] = -1; top[1] = -1;
-	middle_bottom[0] = (screen->h - 1); middle_bottom[1] = (screen->h - 1);
-	middle_top[0] = 0; middle_top[1] = 0;
-	flag = 0;
-	previous_distance = -1;
-	wall[0] = NULL; wall[1] = NULL;
-	  
-	sector->current = sector->first->next;
-	while((sector->current) != NULL)
+	/* every hit along the rays of the packet, in one pass */
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_INTERSECTION);
+	for (k = 0; k < RCA_RAYCASTER_PACKET; k++)
+	{
+	  RCA_ClearHitList(&hits[k]);
+	}
+	RCA_CastPacketOnSector(hits, element, sector, i, RCA_RAYCASTER_PACKET);
+	
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_RASTERIZATION);
+	for (k = 0; k < RCA_RAYCASTER_PACKET; k++)
 	{
-	  intersection = RCA_FindWallIntersection(element, RCA_WallOfSector(sector->current), RCA_CheckAngleLimit(ray_angle));
+	  nearest_opaque = RCA_ResolveHitList(screen, &hits[k], (RCA_RAYCASTER_COLUMNS - 1 - i - k) * RCA_RAYCASTER_SLICE_WIDTH);
 	  
-	  if (intersection != NULL)
+	  /* keep the nearest occluder for the sprites */
+	  if (nearest_opaque < RCA_RAYCASTER__DEPTH_BUFFER[i + k])
 	  {
-	    if (RCA_CorrectIntersection(element, intersection[0], intersection[1], RCA_CheckAngleLimit(ray_angle)) &&
-		    RCA_CheckWallLimit(RCA_WallOfSector(sector->current), intersection[0], intersection[1]))
-		{
-		  distance = RCA_GettingDistanceToWall(element, intersection, RCA_CheckAngleLimit(ray_angle));
-		  
-		  /* correcting distance */
-		  corrected_distance = distance * fabs(cos((ray_angle - element->direction) * M_PI / 180)); 
-		  
-		  height = RCA_GettingHeightOfWall(corrected_distance);
-		  
-		  current_top = (screen->h / 2) - (int)(height / 2);
-		  current_bottom = (screen->h / 2) - (int)(height / 2) + (int)height;
-		  
-		  if (distance < previous_distance && flag)
-		  {
-			wall[1] = wall[0];
-			wall[0] = sector->current;
-			top[1] = top[0];
-			top[0] = current_top;
-			bottom[1] = bottom [0];
-			bottom[0] = current_bottom;
-			middle_top[1] = middle_top[0];
-			middle_top[0] = current_top + (int)floor(wall[0]->ceiling * height / 100);
-			middle_bottom[1] = middle_bottom[0];
-			middle_bottom[0] = current_bottom - (int)floor(wall[0]->floor * height / 100);
-			
-			/* Slope floor */
-			if (wall[0]->floor_slope != 0)
-			{
-			  if (wall[0]->floor_slope < 0)
-			    offset = sqrt(pow((intersection[0] - wall[0]->x2), 2) + pow((intersection[1] - wall[0]->y2), 2));
-			  else
-				offset = sqrt(pow((intersection[0] - wall[0]->x1), 2) + pow((intersection[1] - wall[0]->y1), 2));  
-			  
-			  m = wall[0]->floor / sqrt(pow((wall[0]->x2 - wall[0]->x1), 2) + pow((wall[0]->y2 - wall[0]->y1), 2));
-			  middle_bottom[0] = current_bottom - (int)((offset * m) / wall[0]->floor * (floor(wall[0]->floor * height / 100))
-								 + (floor(fabs(wall[0]->floor_slope) * height / 100)) * (wall[0]->floor / fabs(wall[0]->floor)));
-			}
-			
-			/* Slope ceiling */
-			if (wall[0]->ceiling_slope != 0)
-			{
-			  if (wall[0]->ceiling_slope < 0)
-			    offset = sqrt(pow((intersection[0] - wall[0]->x2), 2) + pow((intersection[1] - wall[0]->y2), 2));
-			  else
-				offset = sqrt(pow((intersection[0] - wall[0]->x1), 2) + pow((intersection[1] - wall[0]->y1), 2));  
-			  
-			  m = wall[0]->ceiling / sqrt(pow((wall[0]->x2 - wall[0]->x1), 2) + pow((wall[0]->y2 - wall[0]->y1), 2));
-			  middle_top[0] = current_top + (int)((offset * m) / wall[0]->ceiling * (floor(wall[0]->ceiling * height / 100))
-								 + (floor(fabs(wall[0]->ceiling_slope) * height / 100)) * (wall[0]->ceiling / fabs(wall[0]->ceiling)));
-			}
-		  }
-		  else
-		  {
-			wall[0 + flag] = sector->current;
-			top[0 + flag] = current_top;
-			bottom[0 + flag] = current_bottom;
-			middle_top[0 + flag] = current_top + (int)floor(wall[0 + flag]->ceiling * height / 100);
-			middle_bottom[0 + flag] = current_bottom - (int)floor(wall[0 + flag]->floor * height / 100);
-			
-			/* Slope floor */
-			if (wall[0 + flag]->floor_slope != 0)
-			{
-			  if (wall[0 + flag]->floor_slope < 0)
-			    offset = sqrt(pow((intersection[0] - wall[0 + flag]->x2), 2) + pow((intersection[1] - wall[0 + flag]->y2), 2));
-			  else 
-			    offset = sqrt(pow((intersection[0] - wall[0 + flag]->x1), 2) + pow((intersection[1] - wall[0 + flag]->y1), 2));
-				
-			  m = wall[0 + flag]->floor / sqrt(pow((wall[0 + flag]->x2 - wall[0 + flag]->x1), 2) + pow((wall[0 + flag]->y2 - wall[0 + flag]->y1), 2));
-			  middle_bottom[0 + flag] = current_bottom - (int)((offset * m) / wall[0 + flag]->floor * (floor(wall[0 + flag]->floor * height / 100))
-										+ (floor(fabs(wall[0 + flag]->floor_slope) * height / 100)) * (wall[0 + flag]->floor / fabs(wall[0 + flag]->floor)));
-			}
-			
-			/* Slope ceiling */
-			if (wall[0 + flag]->ceiling_slope != 0)
-			{
-			  if (wall[0 + flag]->ceiling_slope < 0)
-			    offset = sqrt(pow((intersection[0] - wall[0 + flag]->x2), 2) + pow((intersection[1] - wall[0 + flag]->y2), 2));
-			  else
-				offset = sqrt(pow((intersection[0] - wall[0 + flag]->x1), 2) + pow((intersection[1] - wall[0 + flag]->y1), 2));  
-			  
-			  m = wall[0 + flag]->ceiling / sqrt(pow((wall[0 + flag]->x2 - wall[0 + flag]->x1), 2) + pow((wall[0 + flag]->y2 - wall[0 + flag]->y1), 2));
-			  middle_top[0 + flag] = current_top + (int)((offset * m) / wall[0 + flag]->ceiling * (floor(wall[0 + flag]->ceiling * height / 100))
-								 + (floor(fabs(wall[0 + flag]->ceiling_slope) * height / 100)) * (wall[0 + flag]->ceiling / fabs(wall[0 + flag]->ceiling)));
-			}
-		  }
-		  
-		  flag = 1;
-		  previous_distance = distance;
-		}
+		RCA_RAYCASTER__DEPTH_BUFFER[i + k] = nearest_opaque;
 	  }
-	  sector->current = sector->current->next;
 	}
-		
-	if (wall[0] != NULL)
+  }
+  RCA_EnterPerfStage(stage);
+}
+
+/**
+ * Check if a sector can be seen.
+ * 
+ * Conservative, a sector is skipped only when every wall is behind the
+ * element.
+ * 
+ * @param element Pointer to an Element object.
+ * @param sector  Pointer to a Sector object.
+ * @return        True (1) or false (0).
+ */
+int RCA_CheckSectorInFront(Element *element, Sector *sector)
+{
+  double cosine = RCA_FineCosine(element->direction);
+  double sine = RCA_FineSine(element->direction);
+  Sector *wall;
+  
+  for (wall = sector->first->next; wall != NULL; wall = wall->next)
+  {
+	if ((wall->x1 - element->x) * cosine + (wall->y1 - element->y) * sine > 0 ||
+		(wall->x2 - element->x) * cosine + (wall->y2 - element->y) * sine > 0)
+	  return 1;
+  }
+  
+  return 0;
+}
+
+/**
+ * Find sectors in front.
+ * 
+ * @param element Pointer to an Element object.
+ * @param sectors Sectors of the level (the leaves of the BSP tree).
+ * @param count   Number of sectors.
+ * @param visible Sectors in front of the element (output, count of them at most).
+ * @return        Number of sectors in front.
+ */
+int RCA_FindSectorsInFront(Element *element, Sector **sectors, int count, Sector **visible)
+{
+  int s;
+  int visible_count = 0;
+  
+  for (s = 0; s < count; s++)
+  {
+	if (RCA_CheckSectorInFront(element, sectors[s]))
+	  visible[visible_count++] = sectors[s];
+  }
+  
+  return visible_count;
+}
+
+/**
+ * Cast the ray of a column on sectors.
+ * 
+ * @param hits    Hits of the column (cleared first).
+ * @param element Pointer to an Element object.
+ * @param sectors Sectors to cast the ray on.
+ * @param count   Number of sectors.
+ * @param column  Column of the ray (0 is the leftmost ray, drawn on the right).
+ */
+void RCA_CastColumn(HitList *hits, Element *element, Sector **sectors, int count, int column)
+{
+  int s;
+  Angle ray_angle = element->direction + RCA_RAYCASTER_HALF_FOV - column * RCA_RAYCASTER_COLUMN_ANGLE;
+  double gradient = RCA_FindRaysGradient(ray_angle);
+  double correction = fabs(RCA_FineCosine(ray_angle - element->direction));
+  
+  RCA_ClearHitList(hits);
+  for (s = 0; s < count; s++)
+  {
+	RCA_CastRayOnSector(hits, element, sectors[s], ray_angle, gradient, correction);
+  }
+}
+
+/**
+ * Single pass casting.
+ * 
+ * One ray per column, tested against the walls of every sector in
+ * front of the element, and resolved once.  Replaces the traversal of
+ * the BSP tree (which casts every ray once per leaf).
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param element Pointer to an Element object.
+ * @param sectors Sectors of the level (the leaves of the BSP tree).
+ * @param count   Number of sectors.
+ */
+void RCA_SinglePassCasting(SDL_Surface *screen, Element *element, Sector **sectors, int count)
+{
+  int i;
+  int slice_position = (RCA_RAYCASTER_COLUMNS - 1) * RCA_RAYCASTER_SLICE_WIDTH;
+  Sector *visible[count > 0 ? count : 1];
+  HitList hits;
+  
+  /* sectors behind the element are left out once for every column */
+  int stage = RCA_EnterPerfStage(RCA_PERFCOUNTER_TRAVERSAL);
+  int visible_count = RCA_FindSectorsInFront(element, sectors, count, visible);
+  
+  for (i = 0; i < RCA_RAYCASTER_COLUMNS; i++)
+  {
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_INTERSECTION);
+	RCA_CastColumn(&hits, element, visible, visible_count, i);
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_RASTERIZATION);
+	RCA_RAYCASTER__DEPTH_BUFFER[i] = RCA_ResolveHitList(screen, &hits, slice_position);
+	
+	slice_position -= RCA_RAYCASTER_SLICE_WIDTH;
+  }
+  RCA_EnterPerfStage(stage);
+}
+
+/**
+ * Interpolate the hits of a column.
+ * 
+ * The columns first and last hit the same walls.  Along a flat wall the
+ * inverse of the corrected distance is linear in the tangent of the
+ * angle of the ray (from the direction of the element), so the hits in
+ * between come out of first and last without casting a ray.
+ * 
+ * @param hits    Hits of the column (output).
+ * @param element Pointer to an Element object.
+ * @param first   Hits of a column on the left.
+ * @param last    Hits of a column on the right.
+ * @param columns Columns of first, hits and last.
+ */
+void RCA_InterpolateColumn(HitList *hits, Element *element, HitList *first, HitList *last, int columns[3])
+{
+  int k;
+  double tangent[3], weight, corrected;
+  double forward[2] = {RCA_FineCosine(element->direction), RCA_FineSine(element->direction)};
+  double lateral[2] = {-forward[1], forward[0]};
+  
+  for (k = 0; k < 3; k++)
+  {
+	tangent[k] = RCA_FineTangent(RCA_RAYCASTER_HALF_FOV - columns[k] * RCA_RAYCASTER_COLUMN_ANGLE);
+  }
+  weight = (tangent[1] - tangent[0]) / (tangent[2] - tangent[0]);
+  
+  hits->count = first->count;
+  for (k = 0; k < first->count; k++)
+  {
+	hits->hits[k] = first->hits[k];
+	
+	corrected = 1 / ((1 - weight) / first->hits[k].corrected_distance + weight / last->hits[k].corrected_distance);
+	hits->hits[k].corrected_distance = corrected;
+	hits->hits[k].distance = corrected * sqrt(1 + tangent[1] * tangent[1]);
+	hits->hits[k].x = element->x + corrected * (forward[0] + tangent[1] * lateral[0]);
+	hits->hits[k].y = element->y + corrected * (forward[1] + tangent[1] * lateral[1]);
+  }
+}
+
+/**
+ * Refine the columns between two rays.
+ * 
+ * If both rays hit the same walls, the columns in between are
+ * interpolated.  Otherwise the ray in the middle is casted and both
+ * halves are refined.
+ * 
+ * @param window  Hits of the columns from base on.
+ * @param base    Column of window[0].
+ * @param first   Column on the left (already casted).
+ * @param last    Column on the right (already casted).
+ * @param element Pointer to an Element object.
+ * @param sectors Sectors to cast the rays on.
+ * @param count   Number of sectors.
+ * @return        Number of rays casted.
+ */
+int RCA_RefineColumns(HitList *window, int base, int first, int last, Element *element, Sector **sectors, int count)
+{
+  int i, middle, k;
+  int columns[3] = {first, 0, last};
+  HitList *left = &window[first - base];
+  HitList *right = &window[last - base];
+  
+  if (last - first < 2)
+	return 0;
+  
+  if (RCA_CompareHitLists(left, right))
+  {
+	/* a hit at the element can't be interpolated */
+	for (k = 0; k < left->count; k++)
+	{
+	  if (left->hits[k].corrected_distance <= 0 || right->hits[k].corrected_distance <= 0)
+		break;
+	}
+	
+	if (k == left->count)
 	{
-	  if (wall[0]->floor < wall[0]->ceiling)
+	  for (i = first + 1; i < last; i++)
 	  {
-	    /* bottom */
-	    RCA_BottomWallCasting(screen, wall, slice_position, top, bottom, middle_top, middle_bottom);
-	    /* top */
-	    RCA_TopWallCasting(screen, wall, slice_position, top, bottom, middle_top, middle_bottom);
-		/* middle */
-	    RCA_MiddleWallCasting(screen, wall, slice_position, top, bottom, middle_top, middle_bottom);
-	  }
-	  else
-	  {
-		/* bottom */
-	    RCA_TopWallCasting(screen, wall, slice_position, top, bottom, middle_top, middle_bottom);
-	    /* top */
-	    RCA_BottomWallCasting(screen, wall, slice_position, top, bottom, middle_top, middle_bottom);
-		/* middle */
-	    RCA_MiddleWallCasting(screen, wall, slice_position, top, bottom, middle_top, middle_bottom);
+		columns[1] = i;
+		RCA_InterpolateColumn(&window[i - base], element, left, right, columns);
 	  }
+	  return 0;
 	}
+  }
+  
+  middle = (first + last) / 2;
+  RCA_CastColumn(&window[middle - base], element, sectors, count, middle);
+  
+  return 1 + RCA_RefineColumns(window, base, first, middle, element, sectors, count) +
+	RCA_RefineColumns(window, base, middle, last, element, sectors, count);
+}
 
-	ray_angle -= (60.0 / 256);
-	slice_position -= 5;
+/**
+ * Adaptive casting.
+ * 
+ * Same as RCA_SinglePassCasting, but only one ray every
+ * RCA_RAYCASTER_ADAPTIVE_STEP columns is always casted.  Where two of
+ * them hit different walls the columns in between are subdivided, the
+ * others are interpolated, so a big flat wall costs a handful of rays.
+ * 
+ * A wall seen between two rays that both miss it (narrower than the
+ * step) is missed as well.
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param element Pointer to an Element object.
+ * @param sectors Sectors of the level (the leaves of the BSP tree).
+ * @param count   Number of sectors.
+ * @return        Number of rays casted.
+ */
+int RCA_AdaptiveCasting(SDL_Surface *screen, Element *element, Sector **sectors, int count)
+{
+  int i, first, last;
+  int rays = 1;
+  Sector *visible[count > 0 ? count : 1];
+  HitList window[RCA_RAYCASTER_ADAPTIVE_STEP + 1];
+  
+  int stage = RCA_EnterPerfStage(RCA_PERFCOUNTER_TRAVERSAL);
+  int visible_count = RCA_FindSectorsInFront(element, sectors, count, visible);
+  
+  RCA_EnterPerfStage(RCA_PERFCOUNTER_INTERSECTION);
+  RCA_CastColumn(&window[0], element, visible, visible_count, 0);
+  for (first = 0; first < RCA_RAYCASTER_COLUMNS - 1; first = last)
+  {
+	last = first + RCA_RAYCASTER_ADAPTIVE_STEP;
+	if (last > RCA_RAYCASTER_COLUMNS - 1)
+	  last = RCA_RAYCASTER_COLUMNS - 1;
+	
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_INTERSECTION);
+	RCA_CastColumn(&window[last - first], element, visible, visible_count, last);
+	rays += 1 + RCA_RefineColumns(window, first, first, last, element, visible, visible_count);
+	
+	RCA_EnterPerfStage(RCA_PERFCOUNTER_RASTERIZATION);
+	for (i = first; i < last; i++)
+	{
+	  RCA_RAYCASTER__DEPTH_BUFFER[i] = RCA_ResolveHitList(screen, &window[i - first],
+														  (RCA_RAYCASTER_COLUMNS - 1 - i) * RCA_RAYCASTER_SLICE_WIDTH);
+	}
+	
+	/* the last ray starts the next step */
+	window[0] = window[last - first];
   }
+  
+  RCA_RAYCASTER__DEPTH_BUFFER[i] = RCA_ResolveHitList(screen, &window[0], 0);
+  RCA_EnterPerfStage(stage);
+  
+  return rays;
 }
 
 #endif
\ No newline at end of file
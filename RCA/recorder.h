@@ -0,0 +1,198 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Input recorder.  Every tick the state of the keyboard and the mouse
+ * motion are written to a file, which can be played back later to run
+ * the exact same session again (without a window).
+ * 
+ * File format: "RCAR", a version byte, three reserved bytes, then four
+ * bytes per tick: keys (RCA_INPUT_* bits, 16-bit) and xrel (signed
+ * 16-bit), little endian.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "input.h"
+
+#ifndef RCA_RECORDER_H_
+#define RCA_RECORDER_H_
+
+#define RCA_RECORDER_TYPE (1<<6)		/* dynamic type checking */
+#define RCA_RECORDER_VERSION 3
+#define RCA_RECORDER_RECORD 0
+#define RCA_RECORDER_REPLAY 1
+
+/**
+ * Recorder class.
+ */
+typedef struct {
+  unsigned int type;
+  FILE *file;
+  int mode;
+  unsigned int tick;
+} Recorder;
+
+/**
+ * Constructor.
+ * 
+ * @param recorder Pointer to a Recorder object.
+ * @param file     File opened for the mode.
+ * @param mode     RCA_RECORDER_RECORD or RCA_RECORDER_REPLAY.
+ */
+void RCA_ConstructRecorder(Recorder *recorder, FILE *file, int mode)
+{
+  /* here OR the RCA_RECORDER_TYPE constant into the type */
+  recorder->type |= RCA_RECORDER_TYPE;
+
+  recorder->file = file;
+  recorder->mode = mode;
+  recorder->tick = 0;
+}
+
+/**
+ * New.
+ * 
+ * @param path Path of the recording.
+ * @param mode RCA_RECORDER_RECORD or RCA_RECORDER_REPLAY.
+ * @return     An object Recorder (NULL if the file can't be used).
+ */
+Recorder *RCA_NewRecorder(const char *path, int mode)
+{
+  unsigned char header[8] = {'R', 'C', 'A', 'R', RCA_RECORDER_VERSION, 0, 0, 0};
+  unsigned char check[8];
+  FILE *file;
+
+  if (mode == RCA_RECORDER_RECORD)
+  {
+	file = fopen(path, "wb");
+	if (file == NULL)
+	  return NULL;
+	fwrite(header, 1, sizeof(header), file);
+  }
+  else
+  {
+	file = fopen(path, "rb");
+	if (file == NULL)
+	  return NULL;
+	if (fread(check, 1, sizeof(check), file) != sizeof(check) || memcmp(check, header, 5) != 0)
+	{
+	  fclose(file);
+	  return NULL;
+	}
+  }
+
+  Recorder *recorder = malloc(sizeof(Recorder));
+  recorder->type = RCA_RECORDER_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructRecorder(recorder, file, mode);
+
+  return recorder;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param recorder Pointer to a Recorder object.
+ */
+void RCA_CheckRecorder(Recorder *recorder)
+{
+  /* check if we have a valid Recorder object */
+  if (recorder == NULL ||
+	  !(recorder->type & RCA_RECORDER_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param recorder Pointer to a Recorder object.
+ */
+void RCA_DestroyRecorder(Recorder *recorder)
+{
+  /* check if we have a valid Recorder object */
+  RCA_CheckRecorder(recorder);
+
+  /* set type to 0 indicate this is no longer a Recorder object */
+  recorder->type = 0;
+
+  /* free the memory allocated for the object */
+  fclose(recorder->file);
+  free(recorder);
+}
+
+/**
+ * Clamp a value to 16-bit.
+ * 
+ * @param value Value to clamp.
+ * @return      Clamped value.
+ */
+int RCA_ClampTo16Bit(int value)
+{
+  if (value < -32768)
+	return -32768;
+  if (value > 32767)
+	return 32767;
+
+  return value;
+}
+
+/**
+ * Record a tick.
+ * 
+ * @param recorder Pointer to a Recorder object.
+ * @param tick     Input of the tick.
+ */
+void RCA_RecordTick(Recorder *recorder, InputTick *tick)
+{
+  /* check if we have a valid Recorder object */
+  RCA_CheckRecorder(recorder);
+  assert(recorder->mode == RCA_RECORDER_RECORD);
+
+  unsigned char data[4];
+  int xrel = RCA_ClampTo16Bit(tick->xrel);
+
+  data[0] = tick->keys & 0xff; data[1] = (tick->keys >> 8) & 0xff;
+  data[2] = xrel & 0xff; data[3] = (xrel >> 8) & 0xff;
+
+  fwrite(data, 1, sizeof(data), recorder->file);
+  recorder->tick++;
+}
+
+/**
+ * Replay a tick.
+ * 
+ * @param recorder Pointer to a Recorder object.
+ * @param tick     Input of the tick (output).
+ * @return         True (1) or false (0) once the recording is over.
+ */
+int RCA_ReplayTick(Recorder *recorder, InputTick *tick)
+{
+  /* check if we have a valid Recorder object */
+  RCA_CheckRecorder(recorder);
+  assert(recorder->mode == RCA_RECORDER_REPLAY);
+
+  unsigned char data[4];
+
+  if (fread(data, 1, sizeof(data), recorder->file) != sizeof(data))
+	return 0;
+
+  tick->keys = data[0] | (data[1] << 8);
+  tick->xrel = (short)(data[2] | (data[3] << 8));
+  tick->time = 0;
+  recorder->tick++;
+
+  return 1;
+}
+
+#endif
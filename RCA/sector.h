@@ -5,9 +5,13 @@
  */
 
 #include <assert.h>
+#include <math.h>
 #include "SDL.h"
 #include "SDL_gfxPrimitives.h"
 
+#include "arena.h"
+#include "colormap.h"
+
 #ifndef RCA_SECTOR_H_
 #define RCA_SECTOR_H_
 
@@ -29,6 +33,13 @@ typedef struct wall {
   int bottom_color[4];
   int middle_color[4];
   int top_color[4];
+  int light;					/* light of the sector (only the master's is used) */
+  double length;				/* cached, see RCA_UpdateWallConstants */
+  double floor_gradient;		/* cached, floor height gained per unit of length */
+  double ceiling_gradient;		/* cached, ceiling height gained per unit of length */
+  int dirty;					/* cached constants must be computed again */
+  unsigned char *lightmap;		/* baked light of the wall then of the floor, or NULL (see lightmap.h) */
+  int luxels;					/* in each half of the light map */
   struct wall *first;
   struct wall *last;
   struct wall *current;
@@ -69,6 +80,10 @@ void RCA_ConstructSector(Sector *sector, double x1, double y1, double x2, double
   sector->bottom_color[0] = bottom_color[0]; sector->bottom_color[1] = bottom_color[1]; sector->bottom_color[2] = bottom_color[2]; sector->bottom_color[3] = bottom_color[3];
   sector->middle_color[0] = middle_color[0]; sector->middle_color[1] = middle_color[1]; sector->middle_color[2] = middle_color[2]; sector->middle_color[3] = middle_color[3];
   sector->top_color[0] = top_color[0]; sector->top_color[1] = top_color[1]; sector->top_color[2] = top_color[2]; sector->top_color[3] = top_color[3];
+  sector->light = RCA_COLORMAP_FULL_BRIGHT;
+  sector->dirty = 1;
+  sector->lightmap = NULL;
+  sector->luxels = 0;
 }
 
 /**
@@ -78,8 +93,8 @@ void RCA_ConstructSector(Sector *sector, double x1, double y1, double x2, double
  */
 Sector *RCA_NewSector(void) 
 {	
-  Sector *sector = malloc(sizeof(Sector));
-  sector->type = RCA_SECTOR_TYPE;
+  Sector *sector = RCA_AllocateLevel(sizeof(Sector));
+  sector->type = RCA_SECTOR_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   int tmp[4] = {0};
@@ -123,17 +138,21 @@ void RCA_DestroySector(Sector *sector)
   /* check if we have a valid Sector object */
   RCA_CheckSector(sector);
 
-  /* set type to 0 indicate this is no longer a Sector object */
-  sector->type = 0;
-
-  /* free the memory allocated for the object */
+  /* free the memory allocated for the object (walls from the level arena go away with it) */
   Sector *fst = sector->first;
   Sector *bkup = sector->first;
   Sector *cur = NULL;
+  unsigned int type;
   for (cur = fst; cur != NULL; cur = bkup)
   {
 	bkup = cur->next;
-	free(cur);
+	type = cur->type;
+	
+	/* set type to 0 indicate this is no longer a Sector object */
+	cur->type = 0;
+	if (cur->lightmap != NULL)
+	  RCA_FreeLevel(cur->lightmap, type);
+	RCA_FreeLevel(cur, type);
   }
 }
 
@@ -162,8 +181,8 @@ void RCA_AddWallToSector(Sector *sector, double x1, double y1, double x2, double
   /* check if we have a valid Sector object */
   RCA_CheckSector(sector);
 	
-  Sector *new_wall = malloc(sizeof(Sector));
-  new_wall->type = RCA_SECTOR_TYPE;
+  Sector *new_wall = RCA_AllocateLevel(sizeof(Sector));
+  new_wall->type = RCA_SECTOR_TYPE | RCA_LevelAllocationType();
   
   /* call the constructor */
   RCA_ConstructSector(new_wall, x1, y1, x2, y2, floor, ceiling, floor_slope, ceiling_slope, bottom_color, middle_color, top_color);
@@ -217,15 +236,127 @@ void RCA_RemoveWallFromSector(Sector *sector)
   }
   
   /* set type to 0 indicate this is no longer a Sector object */
+  unsigned int type = sector->current->type;
   sector->current->type = 0;
   
   /* remove element */
   Sector *tmp = sector->current;
   Sector *bkup = sector->current->previous;
-  free(tmp);
+  if (tmp->lightmap != NULL)
+	RCA_FreeLevel(tmp->lightmap, type);
+  RCA_FreeLevel(tmp, type);
   sector->current = bkup;
 }
 
+/**
+ * Swap the walls of two sectors.
+ * 
+ * The masters stay where they are (whatever points to them sees the
+ * other walls), the light goes with the walls.
+ * 
+ * @param sector Pointer to a Sector object (the master).
+ * @param other  Pointer to a Sector object (the master).
+ */
+void RCA_SwapSectorWalls(Sector *sector, Sector *other)
+{
+  /* check if we have a valid Sector object */
+  RCA_CheckSector(sector);
+  RCA_CheckSector(other);
+
+  Sector *next = sector->next;
+  Sector *last = sector->last;
+  int light = sector->light;
+
+  sector->next = other->next;
+  sector->last = (other->last == other) ? sector : other->last;
+  sector->light = other->light;
+  other->next = next;
+  other->last = (last == sector) ? other : last;
+  other->light = light;
+
+  if (sector->next != NULL)
+	sector->next->previous = sector;
+  if (other->next != NULL)
+	other->next->previous = other;
+
+  /* the last wall is the current one, like right after loading */
+  sector->current = sector->last;
+  other->current = other->last;
+}
+
+/**
+ * Set light of the sector.
+ * 
+ * @param sector Pointer to a Sector object (the master).
+ * @param light  Light of the sector (0 to 255).
+ */
+void RCA_SetSectorLight(Sector *sector, int light)
+{
+  /* check if we have a valid Sector object */
+  RCA_CheckSector(sector);
+
+  if (light < 0)
+	light = 0;
+  if (light > RCA_COLORMAP_FULL_BRIGHT)
+	light = RCA_COLORMAP_FULL_BRIGHT;
+
+  sector->light = light;
+}
+
+/**
+ * Update cached constants of a wall.
+ * 
+ * Only done when the wall changed since the last time.
+ * 
+ * @param wall Pointer to a Sector object (a wall).
+ */
+void RCA_UpdateWallConstants(Sector *wall)
+{
+  if (!wall->dirty)
+	return;
+  
+  wall->length = sqrt(pow((wall->x2 - wall->x1), 2) + pow((wall->y2 - wall->y1), 2));
+  wall->floor_gradient = (wall->length != 0) ? wall->floor / wall->length : 0;
+  wall->ceiling_gradient = (wall->length != 0) ? wall->ceiling / wall->length : 0;
+  wall->dirty = 0;
+}
+
+/**
+ * Set heights of a wall.
+ * 
+ * @param wall    Pointer to a Sector object (a wall).
+ * @param floor   Ground on which the wall rest.
+ * @param ceiling Ceiling on which the wall rest.
+ */
+void RCA_SetWallHeights(Sector *wall, double floor, double ceiling)
+{
+  /* check if we have a valid Sector object */
+  RCA_CheckSector(wall);
+  
+  wall->floor = floor;
+  wall->ceiling = ceiling;
+  wall->dirty = 1;
+}
+
+/**
+ * Move a wall.
+ * 
+ * @param wall Pointer to a Sector object (a wall).
+ * @param dx   Displacement along x.
+ * @param dy   Displacement along y.
+ */
+void RCA_MoveWall(Sector *wall, double dx, double dy)
+{
+  /* check if we have a valid Sector object */
+  RCA_CheckSector(wall);
+  
+  wall->x1 += dx;
+  wall->y1 += dy;
+  wall->x2 += dx;
+  wall->y2 += dy;
+  wall->dirty = 1;
+}
+
 /**
  * Return current wall of sector.
  * 
@@ -234,7 +365,7 @@ void RCA_RemoveWallFromSector(Sector *sector)
  */
 double *RCA_WallOfSector(Sector *sector)
 {
-  static double wall[4];
+  static __thread double wall[4];
   
   wall[0] = sector->x1;
   wall[1] = sector->y1;
@@ -0,0 +1,329 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Billboard sprites (items, NPCs) drawn after the walls and depth
+ * tested against the per-column depth buffer filled by RCA_WallCasting.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "colormap.h"
+#include "element.h"
+#include "palette.h"
+#include "raycaster.h"
+
+#ifndef RCA_SPRITE_H_
+#define RCA_SPRITE_H_
+
+#define RCA_SPRITELIST_TYPE (1<<3)		/* dynamic type checking */
+
+/**
+ * SpriteList class.
+ * 
+ * Sprites are kept as parallel arrays so the culling pass only touches
+ * the coordinates.
+ */
+typedef struct {
+  unsigned int type;
+  int count;
+  int capacity;
+  double *x;
+  double *y;
+  double *radius;				/* half width of the sprite */
+  double *height;				/* in percent of a wall, like floor and ceiling */
+  int (*color)[4];
+  unsigned int *key;			/* sort keys of the visible sprites */
+  unsigned int *key_swap;
+  int *visible;					/* index of the visible sprites */
+  int *visible_swap;
+} SpriteList;
+
+/**
+ * Constructor.
+ * 
+ * @param sprites  Pointer to a SpriteList object.
+ * @param capacity Maximum number of sprites in the list.
+ */
+void RCA_ConstructSpriteList(SpriteList *sprites, int capacity)
+{
+  /* here OR the RCA_SPRITELIST_TYPE constant into the type */
+  sprites->type |= RCA_SPRITELIST_TYPE;
+
+  sprites->count = 0;
+  sprites->capacity = capacity;
+  sprites->x = malloc(capacity * sizeof(double));
+  sprites->y = malloc(capacity * sizeof(double));
+  sprites->radius = malloc(capacity * sizeof(double));
+  sprites->height = malloc(capacity * sizeof(double));
+  sprites->color = malloc(capacity * sizeof(int[4]));
+  sprites->key = malloc(capacity * sizeof(unsigned int));
+  sprites->key_swap = malloc(capacity * sizeof(unsigned int));
+  sprites->visible = malloc(capacity * sizeof(int));
+  sprites->visible_swap = malloc(capacity * sizeof(int));
+}
+
+/**
+ * New.
+ * 
+ * @param capacity Maximum number of sprites in the list.
+ * @return         An object SpriteList.
+ */
+SpriteList *RCA_NewSpriteList(int capacity)
+{
+  SpriteList *sprites = malloc(sizeof(SpriteList));
+  sprites->type = RCA_SPRITELIST_TYPE;
+
+  /* call the constructor */
+  RCA_ConstructSpriteList(sprites, capacity);
+
+  return sprites;
+}
+
+/**
+ * Check object for validity.
+ * 
+ * Check to see if the object we are trying to interact with is of
+ * the good type.
+ * 
+ * @param sprites Pointer to a SpriteList object.
+ */
+void RCA_CheckSpriteList(SpriteList *sprites)
+{
+  /* check if we have a valid SpriteList object */
+  if (sprites == NULL ||
+	  !(sprites->type & RCA_SPRITELIST_TYPE))
+  {
+	assert(0);
+  }
+}
+
+/**
+ * Destructor.
+ * 
+ * @param sprites Pointer to a SpriteList object.
+ */
+void RCA_DestroySpriteList(SpriteList *sprites)
+{
+  /* check if we have a valid SpriteList object */
+  RCA_CheckSpriteList(sprites);
+
+  /* set type to 0 indicate this is no longer a SpriteList object */
+  sprites->type = 0;
+
+  /* free the memory allocated for the object */
+  free(sprites->x);
+  free(sprites->y);
+  free(sprites->radius);
+  free(sprites->height);
+  free(sprites->color);
+  free(sprites->key);
+  free(sprites->key_swap);
+  free(sprites->visible);
+  free(sprites->visible_swap);
+  free(sprites);
+}
+
+/**
+ * Remove every sprite from the list.
+ * 
+ * @param sprites Pointer to a SpriteList object.
+ */
+void RCA_ClearSpriteList(SpriteList *sprites)
+{
+  /* check if we have a valid SpriteList object */
+  RCA_CheckSpriteList(sprites);
+
+  sprites->count = 0;
+}
+
+/**
+ * Add a sprite to the list.
+ * 
+ * @param sprites Pointer to a SpriteList object.
+ * @param x       Coordinate of the sprite.
+ * @param y       Coordinate of the sprite.
+ * @param radius  Half width of the sprite.
+ * @param height  Height of the sprite (in percent of a wall).
+ * @param color   Color of the sprite.
+ * @return        Index of the sprite or -1 if the list is full.
+ */
+int RCA_AddSpriteToList(SpriteList *sprites, double x, double y, double radius, double height, int color[4])
+{
+  /* check if we have a valid SpriteList object */
+  RCA_CheckSpriteList(sprites);
+
+  if (sprites->count == sprites->capacity)
+	return -1;
+
+  int i = sprites->count++;
+
+  sprites->x[i] = x;
+  sprites->y[i] = y;
+  sprites->radius[i] = radius;
+  sprites->height[i] = height;
+  sprites->color[i][0] = color[0]; sprites->color[i][1] = color[1]; sprites->color[i][2] = color[2]; sprites->color[i][3] = color[3];
+
+  return i;
+}
+
+/**
+ * Sort the visible sprites.
+ * 
+ * LSD radix sort on the bits of the (positive) float distance, which
+ * orders the same way as the distance itself.  Sprites end up sorted
+ * from the nearest to the farthest.
+ * 
+ * @param sprites Pointer to a SpriteList object.
+ * @param count   Number of visible sprites.
+ */
+void RCA_SortSpriteList(SpriteList *sprites, int count)
+{
+  int i, pass;
+  int histogram[256];
+  unsigned int *key = sprites->key, *key_swap = sprites->key_swap, *key_tmp;
+  int *visible = sprites->visible, *visible_swap = sprites->visible_swap, *visible_tmp;
+
+  for (pass = 0; pass < 32; pass += 8)
+  {
+	memset(histogram, 0, sizeof(histogram));
+	for (i = 0; i < count; i++)
+	{
+	  histogram[(key[i] >> pass) & 0xff]++;
+	}
+
+	/* every key share the same byte, nothing to do for that pass */
+	if (histogram[(key[0] >> pass) & 0xff] == count)
+	  continue;
+
+	int offset = 0, tmp;
+	for (i = 0; i < 256; i++)
+	{
+	  tmp = histogram[i];
+	  histogram[i] = offset;
+	  offset += tmp;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+	  int j = histogram[(key[i] >> pass) & 0xff]++;
+	  key_swap[j] = key[i];
+	  visible_swap[j] = visible[i];
+	}
+
+	key_tmp = key; key = key_swap; key_swap = key_tmp;
+	visible_tmp = visible; visible = visible_swap; visible_swap = visible_tmp;
+  }
+
+  /* keep the sorted arrays as the main ones */
+  sprites->key = key; sprites->key_swap = key_swap;
+  sprites->visible = visible; sprites->visible_swap = visible_swap;
+}
+
+/**
+ * Draw sprites.
+ * 
+ * Sprites outside of the view cone are culled first, the survivors are
+ * sorted by distance and drawn from the farthest to the nearest.  Each
+ * column is tested against the depth buffer and consecutive visible
+ * columns are drawn as a single box.
+ * 
+ * @param screen  A copy of the current SDL surface.
+ * @param sprites Pointer to a SpriteList object.
+ * @param element Pointer to an Element object (the viewer).
+ */
+void RCA_DrawSprites(SDL_Surface *screen, SpriteList *sprites, Element *element)
+{
+  /* check if we have a valid SpriteList object */
+  RCA_CheckSpriteList(sprites);
+
+  int i, n, column, first, last, run;
+  int visible_count = 0;
+  double dx, dy, forward, lateral;
+  double cosine = RCA_FineCosine(element->direction);
+  double sine = RCA_FineSine(element->direction);
+  double half_fov = RCA_FineTangent(RCA_RAYCASTER_HALF_FOV);
+  double columns_per_degree = (double)RCA_RAYCASTER_COLUMNS / RCA_RAYCASTER_FOV;
+  double angle, half_width, height, distance;
+  int top, bottom, x1, x2;
+  int level;
+  float key;
+
+  /* view cone culling, no per-column work for these */
+  for (i = 0; i < sprites->count; i++)
+  {
+	dx = sprites->x[i] - element->x;
+	dy = sprites->y[i] - element->y;
+	forward = dx * cosine + dy * sine;
+	lateral = dy * cosine - dx * sine;
+
+	if (forward < 1)
+	  continue;
+	if (fabs(lateral) - sprites->radius[i] > forward * half_fov)
+	  continue;
+
+	key = (float)forward;
+	memcpy(&sprites->key[visible_count], &key, sizeof(unsigned int));
+	sprites->visible[visible_count] = i;
+	visible_count++;
+  }
+
+  if (visible_count == 0)
+	return;
+
+  RCA_SortSpriteList(sprites, visible_count);
+
+  /* from the farthest to the nearest */
+  for (n = visible_count - 1; n >= 0; n--)
+  {
+	i = sprites->visible[n];
+	memcpy(&key, &sprites->key[n], sizeof(float));
+	distance = key;
+
+	dx = sprites->x[i] - element->x;
+	dy = sprites->y[i] - element->y;
+	angle = atan2(dy * cosine - dx * sine, dx * cosine + dy * sine) * 180 / M_PI;
+	half_width = atan(sprites->radius[i] / distance) * 180 / M_PI;
+
+	/* the first column is the right side of the screen */
+	first = (int)floor(((RCA_RAYCASTER_FOV / 2) - angle - half_width) * columns_per_degree);
+	last = (int)floor(((RCA_RAYCASTER_FOV / 2) - angle + half_width) * columns_per_degree);
+	if (first < 0)
+	  first = 0;
+	if (last > RCA_RAYCASTER_COLUMNS - 1)
+	  last = RCA_RAYCASTER_COLUMNS - 1;
+
+	height = RCA_GettingHeightOfWall(distance);
+	bottom = (screen->h / 2) - (int)(height / 2) + (int)height;
+	top = bottom - (int)(sprites->height[i] * height / 100);
+
+	/* sprites are not in a sector, only the distance darkens them */
+	level = RCA_GetLightLevel(RCA_COLORMAP_FULL_BRIGHT, distance);
+
+	run = -1;
+	for (column = first; column <= last + 1; column++)
+	{
+	  if (column <= last && distance < RCA_RAYCASTER__DEPTH_BUFFER[column])
+	  {
+		if (run < 0)
+		  run = column;
+		continue;
+	  }
+
+	  if (run >= 0)
+	  {
+		x1 = (RCA_RAYCASTER_COLUMNS - column) * RCA_RAYCASTER_SLICE_WIDTH;
+		x2 = (RCA_RAYCASTER_COLUMNS - 1 - run) * RCA_RAYCASTER_SLICE_WIDTH + RCA_RAYCASTER_SLICE_WIDTH;
+		RCA_FillBox(screen, x1, top, x2, bottom, sprites->color[i], level);
+		run = -1;
+	  }
+	}
+  }
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * High resolution timer and timing statistics.  SDL_GetTicks only
+ * counts milliseconds, which is too coarse to time a frame.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef RCA_TIMER_H_
+#define RCA_TIMER_H_
+
+/**
+ * Get time.
+ * 
+ * @return Monotonic time (in second).
+ */
+double RCA_GetTime(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * Compare two times (for qsort).
+ * 
+ * @param a Pointer to a time.
+ * @param b Pointer to a time.
+ * @return  Negative, zero or positive like strcmp.
+ */
+int RCA_CompareTime(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+/**
+ * Get percentile.
+ * 
+ * @param sorted     Times sorted in increasing order.
+ * @param count      Number of times.
+ * @param percentile Percentile to get (0 to 100).
+ * @return           Time at that percentile.
+ */
+double RCA_GetPercentile(double *sorted, int count, double percentile)
+{
+  int i = (int)(percentile / 100 * (count - 1) + 0.5);
+
+  if (count == 0)
+	return 0;
+
+  return sorted[i];
+}
+
+/**
+ * Print timing summary.
+ * 
+ * The times are sorted in place.
+ * 
+ * @param stream Where to print the summary.
+ * @param name   Name of what was timed.
+ * @param times  Times (in second).
+ * @param count  Number of times.
+ */
+void RCA_PrintTimingSummary(FILE *stream, const char *name, double *times, int count)
+{
+  int i;
+  double total = 0;
+
+  if (count == 0)
+	return;
+
+  for (i = 0; i < count; i++)
+  {
+	total += times[i];
+  }
+  qsort(times, count, sizeof(double), RCA_CompareTime);
+
+  fprintf(stream, "%s: %d frames, mean %.3f ms, min %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+		  name, count, total / count * 1e3, times[0] * 1e3, RCA_GetPercentile(times, count, 50) * 1e3,
+		  RCA_GetPercentile(times, count, 95) * 1e3, RCA_GetPercentile(times, count, 99) * 1e3, times[count - 1] * 1e3);
+}
+
+#endif
@@ -0,0 +1,921 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Microbenchmarks of the geometry, traversal and rasterization kernels.
+ * Every kernel is timed in isolation over randomised (but seeded) inputs
+ * and reported in ns/op as the median of several samples, along with the
+ * median absolute deviation.
+ * 
+ * gcc -O2 benchmark.c `sdl-config --cflags --libs` -lSDL_gfx -o benchmark
+ * 
+ * ./benchmark                    (run everything)
+ * ./benchmark --filter Wall      (only the kernels with Wall in their name)
+ * ./benchmark --save base.txt    (save the results as a baseline)
+ * ./benchmark --compare base.txt (compare with a saved baseline)
+ * ./benchmark --map big.map      (traverse and cast in a level made by mapgen)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "RCA/arena.h"
+#include "RCA/bsparray.h"
+#include "RCA/bsptree.h"
+#include "RCA/colormap.h"
+#include "RCA/element.h"
+#include "RCA/hitlist.h"
+#include "RCA/lights.h"
+#include "RCA/map.h"
+#include "RCA/mover.h"
+#include "RCA/navgraph.h"
+#include "RCA/raycaster.h"
+#include "RCA/sector.h"
+#include "RCA/timer.h"
+
+#define RCA_BENCHMARK_INPUTS 4096		/* randomised inputs per kernel (power of two) */
+#define RCA_BENCHMARK_SAMPLES 15
+#define RCA_BENCHMARK_SAMPLE_TIME 0.01	/* in second */
+#define RCA_BENCHMARK_MOVERS 512
+#define RCA_BENCHMARK_HITLISTS 1024	/* columns to resolve (power of two) */
+#define RCA_BENCHMARK_LIGHTS 512
+#define RCA_BENCHMARK_AGENTS 256		/* path queries of a tick (power of two) */
+#define RCA_BENCHMARK_FRAMES 64			/* frames rendered by both renderers */
+
+typedef struct {
+  const char *name;
+  void (*run)(long iterations);
+  double median;				/* in ns/op */
+  double deviation;				/* median absolute deviation, in ns/op */
+} Benchmark;
+
+SDL_Surface *screen;
+Arena *level;
+BSPtree *bsptree;
+BSParray *bsparray;
+Map *map = NULL;
+Sector **leaves;
+int leaf_count;
+Element *elements[RCA_BENCHMARK_INPUTS];
+Element *viewers[RCA_BENCHMARK_INPUTS];	/* in the level (the elements, unless there is a map) */
+double walls[RCA_BENCHMARK_INPUTS][4];
+Angle angles[RCA_BENCHMARK_INPUTS];
+double points[RCA_BENCHMARK_INPUTS][2];
+BSPtree *nodes[RCA_BENCHMARK_INPUTS];
+BSPnode planes[RCA_BENCHMARK_INPUTS];
+Sector *slices[RCA_BENCHMARK_INPUTS];
+Sector *lifts[RCA_BENCHMARK_MOVERS];		/* copies of the first slices, only moved by the movers */
+MoverList *movers;
+LightList *lights;
+NavGraph *navgraph;
+NavSearch navsearch;
+NavPath queries[RCA_BENCHMARK_AGENTS];	/* from a viewer to the next one */
+NavPath flat_path;
+HitList hitlists[RCA_BENCHMARK_HITLISTS];
+int rows[RCA_BENCHMARK_INPUTS][2];
+volatile double sink;				/* keeps the compiler from removing the work */
+unsigned int seed = 2463534242u;
+
+/**
+ * Random number (xorshift, same sequence on every platform).
+ * 
+ * @return Number between 0 and 1.
+ */
+double RCA_BenchmarkRandom(void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  return seed / 4294967296.0;
+}
+
+/**
+ * Build a level for the traversal.
+ * 
+ * The 1280x720 area is split in half, alternating between x and y, and
+ * every cell at the bottom of the tree is a leaf with a box in it.
+ * 
+ * @param node  Node splitting the cell.
+ * @param x1    Cell of the node.
+ * @param y1    Cell of the node.
+ * @param x2    Cell of the node.
+ * @param y2    Cell of the node.
+ * @param depth Depth of the node.
+ */
+void RCA_BenchmarkSplit(BSPtree *node, double x1, double y1, double x2, double y2, int depth)
+{
+  int colors[3][4] = {{255, 255, 255, 0}, {100, 100, 100, 255}, {0, 255, 0, 255}};
+  double cell[2][4];
+  double w, h;
+  Sector *sector;
+  int side;
+
+  /* back is on the lower side of the separating line, front on the higher */
+  if (node->x1 == node->x2)
+  {
+	cell[0][0] = x1; cell[0][1] = y1; cell[0][2] = node->x1; cell[0][3] = y2;
+	cell[1][0] = node->x1; cell[1][1] = y1; cell[1][2] = x2; cell[1][3] = y2;
+  }
+  else
+  {
+	cell[0][0] = x1; cell[0][1] = y1; cell[0][2] = x2; cell[0][3] = node->y1;
+	cell[1][0] = x1; cell[1][1] = node->y1; cell[1][2] = x2; cell[1][3] = y2;
+  }
+
+  for (side = 0; side < 2; side++)
+  {
+	w = cell[side][2] - cell[side][0];
+	h = cell[side][3] - cell[side][1];
+
+	if (depth == 4)
+	{
+	  /* a box with a raised floor in the middle of the cell */
+	  x1 = cell[side][0] + w / 4; x2 = cell[side][2] - w / 4;
+	  y1 = cell[side][1] + h / 4; y2 = cell[side][3] - h / 4;
+
+	  sector = RCA_NewSector();
+	  RCA_AddWallToSector(sector, x1, y1, x2, y1, 20, 0, 0, 0, colors[2], colors[0], colors[2]);
+	  RCA_AddWallToSector(sector, x2, y1, x2, y2, 20, 0, 0, 0, colors[2], colors[1], colors[2]);
+	  RCA_AddWallToSector(sector, x2, y2, x1, y2, 20, 0, 0, 0, colors[2], colors[0], colors[2]);
+	  RCA_AddWallToSector(sector, x1, y2, x1, y1, 20, 0, 0, 0, colors[2], colors[1], colors[2]);
+
+	  if (side)
+		RCA_AddLeafToBSPtreeFront(node, sector);
+	  else
+		RCA_AddLeafToBSPtreeBack(node, sector);
+	}
+	else if (node->x1 == node->x2)
+	{
+	  /* a vertical line is followed by an horizontal one */
+	  if (side)
+	  {
+		RCA_AddNodeToBSPtreeFront(node, cell[side][0], cell[side][1] + h / 2, cell[side][2], cell[side][1] + h / 2);
+		RCA_BenchmarkSplit(node->front, cell[side][0], cell[side][1], cell[side][2], cell[side][3], depth + 1);
+	  }
+	  else
+	  {
+		RCA_AddNodeToBSPtreeBack(node, cell[side][0], cell[side][1] + h / 2, cell[side][2], cell[side][1] + h / 2);
+		RCA_BenchmarkSplit(node->back, cell[side][0], cell[side][1], cell[side][2], cell[side][3], depth + 1);
+	  }
+	}
+	else
+	{
+	  if (side)
+	  {
+		RCA_AddNodeToBSPtreeFront(node, cell[side][0] + w / 2, cell[side][1], cell[side][0] + w / 2, cell[side][3]);
+		RCA_BenchmarkSplit(node->front, cell[side][0], cell[side][1], cell[side][2], cell[side][3], depth + 1);
+	  }
+	  else
+	  {
+		RCA_AddNodeToBSPtreeBack(node, cell[side][0] + w / 2, cell[side][1], cell[side][0] + w / 2, cell[side][3]);
+		RCA_BenchmarkSplit(node->back, cell[side][0], cell[side][1], cell[side][2], cell[side][3], depth + 1);
+	  }
+	}
+  }
+}
+
+/**
+ * Generate the randomised inputs.
+ * 
+ * @param path Path of a map to traverse and cast in (NULL for the grid of boxes).
+ * @return     True (1) if everything was set up, false (0) if the map can't be loaded.
+ */
+int RCA_BenchmarkSetup(const char *path)
+{
+  int i;
+  int colors[2][4] = {{200, 0, 0, 255}, {255, 255, 255, 0}};
+
+  RCA_InitBAM();
+  RCA_InitColormap();
+  screen = SDL_CreateRGBSurface(SDL_SWSURFACE, 1280, 720, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+  level = RCA_NewArena(64 * 1024);
+  RCA_SetLevelArena(level);
+
+  if (path != NULL)
+  {
+	map = RCA_LoadMap(path);
+	if (map == NULL)
+	{
+	  RCA_SetLevelArena(NULL);
+	  return 0;
+	}
+	bsptree = map->bsptree;
+	leaves = malloc(map->count * sizeof(Sector *));
+	leaf_count = RCA_FindBSPtreeSectors(bsptree, leaves, 0, map->count);
+  }
+  else
+  {
+	bsptree = RCA_NewBSPtree(640, 0, 640, 720);
+	RCA_BenchmarkSplit(bsptree, 0, 0, 1280, 720, 1);
+	leaves = malloc(64 * sizeof(Sector *));
+	leaf_count = RCA_FindBSPtreeSectors(bsptree, leaves, 0, 64);
+  }
+  bsparray = RCA_CompileBSPtree(bsptree);
+
+  for (i = 0; i < RCA_BENCHMARK_INPUTS; i++)
+  {
+	elements[i] = RCA_NewElement(RCA_BenchmarkRandom() * 1280, RCA_BenchmarkRandom() * 720, RCA_DegreesToBAM(floor(RCA_BenchmarkRandom() * 1440) / 4));
+
+	walls[i][0] = RCA_BenchmarkRandom() * 1280; walls[i][1] = RCA_BenchmarkRandom() * 720;
+	walls[i][2] = RCA_BenchmarkRandom() * 1280; walls[i][3] = RCA_BenchmarkRandom() * 720;
+
+	/* some axis aligned walls, like in the maps */
+	if (i % 4 == 0) walls[i][2] = walls[i][0];
+	if (i % 4 == 1) walls[i][3] = walls[i][1];
+
+	angles[i] = RCA_DegreesToBAM(floor(RCA_BenchmarkRandom() * 1440) / 4);
+	points[i][0] = RCA_BenchmarkRandom() * 1280;
+	points[i][1] = RCA_BenchmarkRandom() * 720;
+
+	nodes[i] = RCA_NewBSPtree(walls[i][0], walls[i][1], walls[i][2], walls[i][3]);
+	planes[i] = RCA_CompileBSPtree(nodes[i])->nodes[0];
+
+	slices[i] = RCA_NewSector();
+	RCA_AddWallToSector(slices[i], walls[i][0], walls[i][1], walls[i][2], walls[i][3], floor(RCA_BenchmarkRandom() * 40) - 10,
+						floor(RCA_BenchmarkRandom() * 40) - 10, 0, 0, colors[0], colors[i % 2], colors[0]);
+
+	/* top and bottom of a wall slice */
+	rows[i][0] = (int)(RCA_BenchmarkRandom() * 360);
+	rows[i][1] = 719 - (int)(RCA_BenchmarkRandom() * 360);
+  }
+
+  /* columns with one to six hits, from sectors with raised and lowered floors */
+  for (i = 0; i < RCA_BENCHMARK_HITLISTS; i++)
+  {
+	int k, j, count = 1 + (int)(RCA_BenchmarkRandom() * 6);
+	double distance;
+
+	RCA_ClearHitList(&hitlists[i]);
+	for (k = 0; k < count; k++)
+	{
+	  j = (int)(RCA_BenchmarkRandom() * RCA_BENCHMARK_INPUTS);
+	  RCA_UpdateWallConstants(slices[j]->first->next);
+	  distance = 20 + RCA_BenchmarkRandom() * 600;
+	  RCA_AddHitToList(&hitlists[i], slices[j]->first->next, slices[j], distance, distance, walls[j][0], walls[j][1]);
+	}
+  }
+
+  /* lifts, doors and sliding walls, a third of each */
+  movers = RCA_NewMoverList(RCA_BENCHMARK_MOVERS);
+  for (i = 0; i < RCA_BENCHMARK_MOVERS; i++)
+  {
+	Sector *wall = slices[i]->first->next;
+
+	lifts[i] = RCA_NewSector();
+	RCA_AddWallToSector(lifts[i], wall->x1, wall->y1, wall->x2, wall->y2, wall->floor, wall->ceiling, 0, 0, wall->bottom_color,
+						wall->middle_color, wall->top_color);
+	RCA_ActivateMover(movers, RCA_AddMoverToList(movers, lifts[i], i % 3, 0, (i % 3 == RCA_MOVER_SLIDE) ? 100 : 40, 0.5, 10), 1);
+	RCA_SetMoverDirection(movers, i, RCA_BAMToDegrees(angles[i]), 360 - RCA_BAMToDegrees(angles[i]));
+  }
+
+  /* viewers anywhere in the map, drawn last so the other inputs stay the same */
+  for (i = 0; i < RCA_BENCHMARK_INPUTS; i++)
+  {
+	if (map == NULL)
+	  viewers[i] = elements[i];
+	else
+	  viewers[i] = RCA_NewElement(map->bounds[0] + RCA_BenchmarkRandom() * (map->bounds[2] - map->bounds[0]),
+								  map->bounds[1] + RCA_BenchmarkRandom() * (map->bounds[3] - map->bounds[1]),
+								  RCA_DegreesToBAM(floor(RCA_BenchmarkRandom() * 1440) / 4));
+  }
+
+  /* dynamic lights over the area of the points, only active in their kernels */
+  lights = RCA_NewLightList(RCA_BENCHMARK_LIGHTS);
+  RCA_SetLightGrid(lights, 0, 0, 1280, 720);
+  for (i = 0; i < RCA_BENCHMARK_LIGHTS; i++)
+  {
+	RCA_AddLightToList(lights, RCA_BenchmarkRandom() * 1280, RCA_BenchmarkRandom() * 720, 64 + (int)(RCA_BenchmarkRandom() * 128),
+					   40 + RCA_BenchmarkRandom() * 120, 0);
+  }
+  RCA_BinLights(lights);
+
+  /* agents going from the sector of a viewer to the sector of the next one */
+  navgraph = RCA_NewNavGraph((map != NULL) ? map->sectors : leaves, (map != NULL) ? map->count : leaf_count);
+  RCA_InitNavSearch(navgraph, &navsearch);
+  for (i = 0; i < RCA_BENCHMARK_AGENTS; i++)
+  {
+	queries[i].from = RCA_FindNavNode(navgraph, RCA_FindSectorInBSParray(bsparray, viewers[i]->x, viewers[i]->y));
+	queries[i].to = RCA_FindNavNode(navgraph, RCA_FindSectorInBSParray(bsparray, viewers[i + 1]->x, viewers[i + 1]->y));
+  }
+
+  RCA_SetLevelArena(NULL);
+
+  return 1;
+}
+
+void RCA_BenchmarkFindWallIntersection(long iterations)
+{
+  long n;
+  double *intersection;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	intersection = RCA_FindWallIntersection(elements[i], walls[i], angles[i]);
+	if (intersection != NULL)
+	  sink = intersection[0];
+  }
+}
+
+void RCA_BenchmarkCorrectIntersection(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	sink = RCA_CorrectIntersection(elements[i], points[i][0], points[i][1], angles[i]);
+  }
+}
+
+void RCA_BenchmarkCheckWallLimit(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	sink = RCA_CheckWallLimit(walls[i], points[i][0], points[i][1]);
+  }
+}
+
+void RCA_BenchmarkFindLocationInBSPtree(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	sink = RCA_FindLocationInBSPtree(nodes[i], elements[i]);
+  }
+}
+
+void RCA_BenchmarkFindLocationInBSPnode(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	sink = RCA_FindLocationInBSPnode(&planes[i], elements[i]);
+  }
+}
+
+void RCA_BenchmarkTraverseBSPtree(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_ClearDepthBuffer();
+	RCA_TraverseBSPtree(screen, bsptree, viewers[i]);
+  }
+}
+
+void RCA_BenchmarkTraverseBSParray(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_ClearDepthBuffer();
+	RCA_TraverseBSParray(screen, bsparray, viewers[i]);
+  }
+}
+
+void RCA_BenchmarkCastRayOnSector(long iterations)
+{
+  long n;
+  int column;
+  HitList hits;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	Angle ray_angle = viewers[i]->direction + RCA_RAYCASTER_HALF_FOV;
+
+	/* every column of a frame on one leaf */
+	for (column = 0; column < RCA_RAYCASTER_COLUMNS; column++)
+	{
+	  RCA_ClearHitList(&hits);
+	  RCA_CastRayOnSector(&hits, viewers[i], leaves[i % leaf_count], ray_angle, RCA_FindRaysGradient(ray_angle),
+						  fabs(RCA_FineCosine(ray_angle - viewers[i]->direction)));
+	  ray_angle -= RCA_RAYCASTER_COLUMN_ANGLE;
+	}
+	sink = hits.count;
+  }
+}
+
+void RCA_BenchmarkCastPacketOnSector(long iterations)
+{
+  long n;
+  int column, k;
+  HitList hits[RCA_RAYCASTER_PACKET];
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+
+	/* same work as RCA_CastRayOnSector, a packet at a time */
+	for (column = 0; column < RCA_RAYCASTER_COLUMNS; column += RCA_RAYCASTER_PACKET)
+	{
+	  for (k = 0; k < RCA_RAYCASTER_PACKET; k++)
+	  {
+		RCA_ClearHitList(&hits[k]);
+	  }
+	  RCA_CastPacketOnSector(hits, viewers[i], leaves[i % leaf_count], column, RCA_RAYCASTER_PACKET);
+	}
+	sink = hits[0].count;
+  }
+}
+
+/**
+ * Check the single pass frames against the traversal.
+ * 
+ * Adjacent slices share a column of pixels, drawn by the last of them,
+ * so that column is left out.
+ * 
+ * @return Number of frames differing from the one of the traversal.
+ */
+int RCA_BenchmarkCheckSinglePass(void)
+{
+  SDL_Surface *traversed = SDL_CreateRGBSurface(SDL_SWSURFACE, screen->w, screen->h, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+  Uint32 *single, *traversal;
+  int i, x, y, wrong = 0;
+
+  for (i = 0; i < RCA_BENCHMARK_FRAMES; i++)
+  {
+	SDL_FillRect(traversed, NULL, 0);
+	RCA_ClearDepthBuffer();
+	RCA_TraverseBSParray(traversed, bsparray, viewers[i]);
+	SDL_FillRect(screen, NULL, 0);
+	RCA_ClearDepthBuffer();
+	RCA_SinglePassCasting(screen, viewers[i], leaves, leaf_count);
+
+	for (y = 0; y < screen->h; y++)
+	{
+	  single = (Uint32 *)((Uint8 *)screen->pixels + y * screen->pitch);
+	  traversal = (Uint32 *)((Uint8 *)traversed->pixels + y * traversed->pitch);
+	  for (x = 0; x < screen->w && (x % RCA_RAYCASTER_SLICE_WIDTH == 0 || single[x] == traversal[x]); x++)
+		;
+	  if (x < screen->w)
+		break;
+	}
+	if (y < screen->h)
+	  wrong++;
+  }
+  SDL_FreeSurface(traversed);
+
+  return wrong;
+}
+
+void RCA_BenchmarkSinglePassCasting(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_ClearDepthBuffer();
+	RCA_SinglePassCasting(screen, viewers[i], leaves, leaf_count);
+  }
+}
+
+void RCA_BenchmarkAdaptiveCasting(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_ClearDepthBuffer();
+	RCA_AdaptiveCasting(screen, viewers[i], leaves, leaf_count);
+  }
+}
+
+void RCA_BenchmarkTraceBSPtree(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_TraceBSPtree(screen, bsptree, viewers[i]);
+  }
+}
+
+void RCA_BenchmarkTraceBSParray(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_TraceBSParray(screen, bsparray, viewers[i]);
+  }
+}
+
+void RCA_BenchmarkFloorCasting(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_FloorCasting(screen, (i & 255) * RCA_RAYCASTER_SLICE_WIDTH, rows[i][1], 719, i & (RCA_COLORMAP_LEVELS - 1));
+  }
+}
+
+void RCA_BenchmarkCeilingCasting(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_CeilingCasting(screen, (i & 255) * RCA_RAYCASTER_SLICE_WIDTH, rows[i][0], 0, i & (RCA_COLORMAP_LEVELS - 1));
+  }
+}
+
+void RCA_BenchmarkAddHitToList(long iterations)
+{
+  long n;
+  int k;
+  HitList list;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+
+	/* a column with eight hits in random order */
+	RCA_ClearHitList(&list);
+	for (k = 0; k < 8; k++)
+	{
+	  int j = (i + k) & (RCA_BENCHMARK_INPUTS - 1);
+	  RCA_AddHitToList(&list, slices[j]->first->next, slices[j], points[j][0], points[j][0], points[j][0], points[j][1]);
+	}
+	sink = list.hits[0].distance;
+  }
+}
+
+void RCA_BenchmarkResolveHitList(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_HITLISTS - 1);
+	sink = RCA_ResolveHitList(screen, &hitlists[i], (i & 255) * RCA_RAYCASTER_SLICE_WIDTH);
+  }
+}
+
+/**
+ * Put the movers back where they were set up, so that every sample starts
+ * from the same state.
+ */
+void RCA_BenchmarkResetMovers(void)
+{
+  int i;
+  double previous;
+
+  for (i = 0; i < movers->count; i++)
+  {
+	previous = movers->position[i];
+	movers->position[i] = movers->low[i];
+	movers->state[i] = RCA_MOVER_STOPPED;
+	movers->wait[i] = 0;
+	RCA_ApplyMover(movers, i, previous);
+	RCA_ActivateMover(movers, i, 1);
+  }
+}
+
+void RCA_BenchmarkUpdateMovers(long iterations)
+{
+  long n;
+
+  RCA_BenchmarkResetMovers();
+  for (n = 0; n < iterations; n++)
+  {
+	RCA_UpdateMovers(movers);
+  }
+}
+
+void RCA_BenchmarkDrawMovingWalls(long iterations)
+{
+  long n;
+
+  RCA_BenchmarkResetMovers();
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	RCA_ClearDepthBuffer();
+	RCA_DrawMovingWalls(screen, movers, elements[i]);
+  }
+}
+
+void RCA_BenchmarkBinLights(long iterations)
+{
+  long n;
+
+  for (n = 0; n < iterations; n++)
+  {
+	RCA_BinLights(lights);
+  }
+}
+
+void RCA_BenchmarkSampleDynamicLight(long iterations)
+{
+  long n;
+
+  RCA_SetActiveLights(lights);
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_INPUTS - 1);
+	sink = RCA_SampleDynamicLight(points[i][0], points[i][1]);
+  }
+  RCA_SetActiveLights(NULL);
+}
+
+/**
+ * Cost of a path.
+ * 
+ * @param path Pointer to a NavPath.
+ * @return     Sum of the cheapest edge between every two nodes of the path.
+ */
+double RCA_BenchmarkNavCost(NavPath *path)
+{
+  NavLevel *nodes = &navgraph->nodes;
+  double cost = 0, edge_cost;
+  int i, edge;
+
+  for (i = 0; i + 1 < path->length; i++)
+  {
+	edge_cost = HUGE_VAL;
+	for (edge = nodes->first[path->path[i]]; edge < nodes->first[path->path[i] + 1]; edge++)
+	{
+	  if (nodes->to[edge] == path->path[i + 1] && nodes->cost[edge] < edge_cost)
+		edge_cost = nodes->cost[edge];
+	}
+	cost += edge_cost;
+  }
+
+  return cost;
+}
+
+/**
+ * Check the paths of the agents against A* over every sector.
+ * 
+ * @return Number of paths costlier than the one of A* (or only found by one of them).
+ */
+int RCA_BenchmarkCheckNavPaths(void)
+{
+  int i, wrong = 0;
+
+  RCA_ClearNavCache(navgraph);
+  RCA_FindNavPaths(navgraph, queries, RCA_BENCHMARK_AGENTS, 1);
+
+  for (i = 0; i < RCA_BENCHMARK_AGENTS; i++)
+  {
+	if (queries[i].from < 0 || queries[i].to < 0)
+	  continue;
+
+	RCA_SearchNavLevel(&navgraph->nodes, &navsearch.nodes, NULL, NULL, 0, queries[i].from, queries[i].to, &flat_path);
+	if ((queries[i].length == 0) != (flat_path.length == 0) ||
+		RCA_BenchmarkNavCost(&queries[i]) > RCA_BenchmarkNavCost(&flat_path) * (1 + 1e-9))
+	  wrong++;
+  }
+
+  return wrong;
+}
+
+void RCA_BenchmarkFindNavPaths(long iterations)
+{
+  long n;
+  int count;
+
+  /* a tick of agents at a time, none of their paths cached */
+  for (n = 0; n < iterations; n += count)
+  {
+	count = (iterations - n < RCA_BENCHMARK_AGENTS) ? (int)(iterations - n) : RCA_BENCHMARK_AGENTS;
+	RCA_ClearNavCache(navgraph);
+	RCA_FindNavPaths(navgraph, queries, count, 1);
+	sink = queries[0].length;
+  }
+}
+
+void RCA_BenchmarkSearchNavLevel(long iterations)
+{
+  long n;
+
+  /* the same queries, A* over every sector */
+  for (n = 0; n < iterations; n++)
+  {
+	int i = n & (RCA_BENCHMARK_AGENTS - 1);
+	if (queries[i].from >= 0 && queries[i].to >= 0)
+	  sink = RCA_SearchNavLevel(&navgraph->nodes, &navsearch.nodes, NULL, NULL, 0, queries[i].from, queries[i].to, &flat_path);
+  }
+}
+
+Benchmark benchmarks[] = {
+  {"RCA_FindWallIntersection", RCA_BenchmarkFindWallIntersection, 0, 0},
+  {"RCA_CorrectIntersection", RCA_BenchmarkCorrectIntersection, 0, 0},
+  {"RCA_CheckWallLimit", RCA_BenchmarkCheckWallLimit, 0, 0},
+  {"RCA_FindLocationInBSPtree", RCA_BenchmarkFindLocationInBSPtree, 0, 0},
+  {"RCA_FindLocationInBSPnode", RCA_BenchmarkFindLocationInBSPnode, 0, 0},
+  {"RCA_TraverseBSPtree", RCA_BenchmarkTraverseBSPtree, 0, 0},
+  {"RCA_TraverseBSParray", RCA_BenchmarkTraverseBSParray, 0, 0},
+  {"RCA_CastRayOnSector", RCA_BenchmarkCastRayOnSector, 0, 0},
+  {"RCA_CastPacketOnSector", RCA_BenchmarkCastPacketOnSector, 0, 0},
+  {"RCA_SinglePassCasting", RCA_BenchmarkSinglePassCasting, 0, 0},
+  {"RCA_AdaptiveCasting", RCA_BenchmarkAdaptiveCasting, 0, 0},
+  {"RCA_TraceBSPtree", RCA_BenchmarkTraceBSPtree, 0, 0},
+  {"RCA_TraceBSParray", RCA_BenchmarkTraceBSParray, 0, 0},
+  {"RCA_FloorCasting", RCA_BenchmarkFloorCasting, 0, 0},
+  {"RCA_CeilingCasting", RCA_BenchmarkCeilingCasting, 0, 0},
+  {"RCA_AddHitToList", RCA_BenchmarkAddHitToList, 0, 0},
+  {"RCA_ResolveHitList", RCA_BenchmarkResolveHitList, 0, 0},
+  {"RCA_UpdateMovers", RCA_BenchmarkUpdateMovers, 0, 0},
+  {"RCA_DrawMovingWalls", RCA_BenchmarkDrawMovingWalls, 0, 0},
+  {"RCA_BinLights", RCA_BenchmarkBinLights, 0, 0},
+  {"RCA_SampleDynamicLight", RCA_BenchmarkSampleDynamicLight, 0, 0},
+  {"RCA_FindNavPaths", RCA_BenchmarkFindNavPaths, 0, 0},
+  {"RCA_SearchNavLevel", RCA_BenchmarkSearchNavLevel, 0, 0},
+  {NULL, NULL, 0, 0}
+};
+
+/**
+ * Time a benchmark.
+ * 
+ * The number of iterations is doubled until a sample takes long enough
+ * to be measured, then several samples are taken.
+ * 
+ * @param benchmark Benchmark to run.
+ */
+void RCA_RunBenchmark(Benchmark *benchmark)
+{
+  int i;
+  long iterations = 1;
+  double start, elapsed;
+  double samples[RCA_BENCHMARK_SAMPLES];
+
+  /* warm up and calibrate */
+  while (1)
+  {
+	start = RCA_GetTime();
+	benchmark->run(iterations);
+	elapsed = RCA_GetTime() - start;
+
+	if (elapsed >= RCA_BENCHMARK_SAMPLE_TIME)
+	  break;
+	iterations *= 2;
+  }
+
+  for (i = 0; i < RCA_BENCHMARK_SAMPLES; i++)
+  {
+	start = RCA_GetTime();
+	benchmark->run(iterations);
+	samples[i] = (RCA_GetTime() - start) * 1e9 / iterations;
+  }
+
+  qsort(samples, RCA_BENCHMARK_SAMPLES, sizeof(double), RCA_CompareTime);
+  benchmark->median = RCA_GetPercentile(samples, RCA_BENCHMARK_SAMPLES, 50);
+
+  for (i = 0; i < RCA_BENCHMARK_SAMPLES; i++)
+  {
+	samples[i] = fabs(samples[i] - benchmark->median);
+  }
+  qsort(samples, RCA_BENCHMARK_SAMPLES, sizeof(double), RCA_CompareTime);
+  benchmark->deviation = RCA_GetPercentile(samples, RCA_BENCHMARK_SAMPLES, 50);
+}
+
+/**
+ * Find the baseline of a benchmark.
+ * 
+ * @param path Baseline file ("name ns/op" on every line).
+ * @param name Name of the benchmark.
+ * @return     Baseline (in ns/op) or 0 if there is none.
+ */
+double RCA_FindBaseline(const char *path, const char *name)
+{
+  char line[256], baseline_name[128];
+  double baseline = 0, value;
+  FILE *file = fopen(path, "r");
+
+  if (file == NULL)
+	return 0;
+
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+	if (sscanf(line, "%127s %lf", baseline_name, &value) == 2 && strcmp(baseline_name, name) == 0)
+	{
+	  baseline = value;
+	  break;
+	}
+  }
+  fclose(file);
+
+  return baseline;
+}
+
+/**
+ * Main function of the benchmark.
+ * 
+ * @param argc Arguments passed on the command line (number).
+ * @param argv Arguments passed on the command line (values).
+ * @return     0 (meaning we're done)
+ */
+int main(int argc, char **argv)
+{
+  int i;
+  const char *filter = NULL, *save = NULL, *compare = NULL, *path = NULL;
+  FILE *file = NULL;
+  double baseline;
+
+  for (i = 1; i < argc - 1; i++)
+  {
+	if (strcmp(argv[i], "--filter") == 0)
+	  filter = argv[++i];
+	else if (strcmp(argv[i], "--save") == 0)
+	  save = argv[++i];
+	else if (strcmp(argv[i], "--compare") == 0)
+	  compare = argv[++i];
+	else if (strcmp(argv[i], "--map") == 0)
+	  path = argv[++i];
+  }
+
+  SDL_Init(0);
+  if (!RCA_BenchmarkSetup(path))
+  {
+	fprintf(stderr, "can't load map %s\n", path);
+	return 1;
+  }
+  if (map != NULL)
+	printf("map %s: %d walls, %d sectors\n", path, map->walls, map->count);
+  printf("navigation: %d regions, %d of %d paths costlier than A* over every sector\n", navgraph->region_count,
+		 RCA_BenchmarkCheckNavPaths(), RCA_BENCHMARK_AGENTS);
+  printf("single pass: %d of %d frames differ from the traversal\n", RCA_BenchmarkCheckSinglePass(), RCA_BENCHMARK_FRAMES);
+
+  if (save != NULL)
+  {
+	file = fopen(save, "w");
+	if (file == NULL)
+	{
+	  fprintf(stderr, "can't write baseline %s\n", save);
+	  return 1;
+	}
+  }
+
+  printf("%-28s %12s %10s", "kernel", "ns/op", "+/-");
+  if (compare != NULL)
+	printf(" %12s %8s", "baseline", "change");
+  printf("\n");
+
+  for (i = 0; benchmarks[i].name != NULL; i++)
+  {
+	if (filter != NULL && strstr(benchmarks[i].name, filter) == NULL)
+	  continue;
+
+	RCA_RunBenchmark(&benchmarks[i]);
+
+	printf("%-28s %12.2f %9.1f%%", benchmarks[i].name, benchmarks[i].median, benchmarks[i].deviation / benchmarks[i].median * 100);
+	if (compare != NULL)
+	{
+	  baseline = RCA_FindBaseline(compare, benchmarks[i].name);
+	  if (baseline > 0)
+		printf(" %12.2f %+7.1f%%", baseline, (benchmarks[i].median - baseline) / baseline * 100);
+	  else
+		printf(" %12s %8s", "-", "-");
+	}
+	printf("\n");
+	fflush(stdout);
+
+	if (file != NULL)
+	  fprintf(file, "%s %.3f\n", benchmarks[i].name, benchmarks[i].median);
+  }
+
+  if (file != NULL)
+	fclose(file);
+
+  for (i = 0; i < RCA_BENCHMARK_INPUTS; i++)
+  {
+	if (viewers[i] != elements[i])
+	  RCA_DestroyElement(viewers[i]);
+	RCA_DestroyElement(elements[i]);
+  }
+  if (map != NULL)
+	RCA_DestroyMap(map);
+  free(leaves);
+  RCA_DestroyMoverList(movers);
+  RCA_DestroyArena(level);
+  SDL_FreeSurface(screen);
+  SDL_Quit();
+
+  return 0;
+}
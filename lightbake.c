@@ -0,0 +1,426 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Light baker.  Computes the light map of every wall of a map (see
+ * RCA/lightmap.h) and writes the map back with them, ready to be drawn
+ * without any lighting work.  A luxel gets the light of its sector, plus
+ * the lamps reaching it unshadowed (shadow rays use the intersection of
+ * the ray caster), and the floor at the base of the walls is darkened
+ * where other walls are close (ambient occlusion).  The walls are baked
+ * in parallel.
+ * 
+ * gcc -O2 lightbake.c `sdl-config --cflags --libs` -lSDL_gfx -o lightbake
+ * 
+ * ./lightbake --map big.map --output lit.map --threads 8
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "RCA/bam.h"
+#include "RCA/element.h"
+#include "RCA/lightmap.h"
+#include "RCA/map.h"
+#include "RCA/parallel.h"
+#include "RCA/raycaster.h"
+#include "RCA/sector.h"
+#include "RCA/timer.h"
+
+#define RCA_LIGHTBAKE_CELL 128			/* size of a cell of the grid */
+#define RCA_LIGHTBAKE_AO_RAYS 16
+#define RCA_LIGHTBAKE_AO_RADIUS 48		/* walls farther than that don't occlude */
+#define RCA_LIGHTBAKE_AO_STRENGTH 0.4	/* ambient light taken away in a corner */
+
+/**
+ * Walls or lamps found in a cell of the grid.
+ */
+typedef struct {
+  int *items;
+  int count;
+  int capacity;
+} Bin;
+
+Map *map;
+Sector **walls;						/* every wall, in the order of the file */
+Sector **owners;					/* sector of every wall */
+int *offsets;						/* of the light map of every wall in baked */
+unsigned char *baked;
+int wall_count = 0;
+Bin *occluders;						/* walls with a visible middle, by cell */
+Bin *lamps;							/* lamps reaching the cell, by cell */
+int grid_columns, grid_rows;
+
+/**
+ * Add an item to a bin.
+ * 
+ * @param bin  Pointer to a Bin.
+ * @param item Index of the item.
+ */
+void RCA_AddToBin(Bin *bin, int item)
+{
+  if (bin->count == bin->capacity)
+  {
+	bin->capacity = (bin->capacity > 0) ? bin->capacity * 2 : 8;
+	bin->items = realloc(bin->items, bin->capacity * sizeof(int));
+  }
+
+  bin->items[bin->count++] = item;
+}
+
+/**
+ * Find cell of a point (clamped to the grid).
+ * 
+ * @param x    Coordinate of the point.
+ * @param y    Coordinate of the point.
+ * @param cell Column and row of the cell (output).
+ */
+void RCA_FindCell(double x, double y, int cell[2])
+{
+  cell[0] = (int)floor((x - map->bounds[0]) / RCA_LIGHTBAKE_CELL);
+  cell[1] = (int)floor((y - map->bounds[1]) / RCA_LIGHTBAKE_CELL);
+
+  if (cell[0] < 0) cell[0] = 0;
+  if (cell[1] < 0) cell[1] = 0;
+  if (cell[0] > grid_columns - 1) cell[0] = grid_columns - 1;
+  if (cell[1] > grid_rows - 1) cell[1] = grid_rows - 1;
+}
+
+/**
+ * Add an item to every cell of a box.
+ * 
+ * @param bins Bins of the grid.
+ * @param item Index of the item.
+ * @param x1   One corner of the box.
+ * @param y1   One corner of the box.
+ * @param x2   Other corner of the box.
+ * @param y2   Other corner of the box.
+ */
+void RCA_AddToCells(Bin *bins, int item, double x1, double y1, double x2, double y2)
+{
+  int first[2], last[2], i, j;
+
+  RCA_FindCell(fmin(x1, x2), fmin(y1, y2), first);
+  RCA_FindCell(fmax(x1, x2), fmax(y1, y2), last);
+
+  for (j = first[1]; j <= last[1]; j++)
+  {
+	for (i = first[0]; i <= last[0]; i++)
+	{
+	  RCA_AddToBin(&bins[j * grid_columns + i], item);
+	}
+  }
+}
+
+/**
+ * Build the grid of the occluders and the lamps.
+ */
+void RCA_BuildGrid(void)
+{
+  Lamp *lamp;
+  int i;
+
+  grid_columns = (int)ceil((map->bounds[2] - map->bounds[0]) / RCA_LIGHTBAKE_CELL) + 1;
+  grid_rows = (int)ceil((map->bounds[3] - map->bounds[1]) / RCA_LIGHTBAKE_CELL) + 1;
+  occluders = calloc(grid_columns * grid_rows, sizeof(Bin));
+  lamps = calloc(grid_columns * grid_rows, sizeof(Bin));
+
+  for (i = 0; i < wall_count; i++)
+  {
+	if (walls[i]->middle_color[3] != 0)
+	  RCA_AddToCells(occluders, i, walls[i]->x1, walls[i]->y1, walls[i]->x2, walls[i]->y2);
+  }
+
+  for (i = 0; i < map->lamp_count; i++)
+  {
+	lamp = &map->lamps[i];
+	RCA_AddToCells(lamps, i, lamp->x - lamp->radius, lamp->y - lamp->radius, lamp->x + lamp->radius, lamp->y + lamp->radius);
+  }
+}
+
+/**
+ * Find the nearest occluder along a ray.
+ * 
+ * @param origin   Pointer to an Element object (start of the ray).
+ * @param angle    Angle of the ray.
+ * @param x        End of the ray (the cells up to there are searched).
+ * @param y        End of the ray.
+ * @param ignored  Wall never occluding (the one lit).
+ * @return         Distance to the nearest occluder (HUGE_VAL if none).
+ */
+double RCA_FindOccluder(Element *origin, Angle angle, double x, double y, Sector *ignored)
+{
+  int first[2], last[2], i, j, k;
+  double gradient = RCA_FindRaysGradient(angle);
+  double nearest = HUGE_VAL, distance;
+  double *intersection;
+  Sector *wall;
+  Bin *bin;
+
+  RCA_FindCell(fmin(origin->x, x), fmin(origin->y, y), first);
+  RCA_FindCell(fmax(origin->x, x), fmax(origin->y, y), last);
+
+  for (j = first[1]; j <= last[1]; j++)
+  {
+	for (i = first[0]; i <= last[0]; i++)
+	{
+	  bin = &occluders[j * grid_columns + i];
+	  for (k = 0; k < bin->count; k++)
+	  {
+		wall = walls[bin->items[k]];
+		if (wall == ignored)
+		  continue;
+
+		intersection = RCA_FindWallIntersectionWithRay(origin, RCA_WallOfSector(wall), gradient);
+		if (intersection != NULL &&
+			RCA_CorrectIntersection(origin, intersection[0], intersection[1], angle) &&
+			RCA_CheckWallLimit(RCA_WallOfSector(wall), intersection[0], intersection[1]))
+		{
+		  distance = RCA_GettingDistanceToWall(origin, intersection, angle);
+		  if (distance < nearest)
+			nearest = distance;
+		}
+	  }
+	}
+  }
+
+  return nearest;
+}
+
+/**
+ * Find ambient occlusion at a point.
+ * 
+ * Short rays are casted all around the point, half of them going
+ * through the wall of the point.  The rays are not aligned on the axes
+ * so they are never along the wall.
+ * 
+ * @param x    Coordinate of the point.
+ * @param y    Coordinate of the point.
+ * @param wall Pointer to a Sector object (the wall of the point).
+ * @return     Occlusion, from 0 (open) to 1 (the other half is closed).
+ */
+double RCA_FindOcclusion(double x, double y, Sector *wall)
+{
+  Element origin = {RCA_ELEMENT_TYPE, x, y, 0};
+  double degrees, distance;
+  int k, occluded = 0;
+
+  for (k = 0; k < RCA_LIGHTBAKE_AO_RAYS; k++)
+  {
+	degrees = (k + 0.5) * 360 / RCA_LIGHTBAKE_AO_RAYS;
+	distance = RCA_FindOccluder(&origin, RCA_DegreesToBAM(degrees),
+								x + RCA_LIGHTBAKE_AO_RADIUS * cos(degrees * M_PI / 180),
+								y + RCA_LIGHTBAKE_AO_RADIUS * sin(degrees * M_PI / 180), wall);
+
+	/* a wall right at the point is the one of the point (or its twin in the next sector) */
+	if (distance > 0.5 && distance < RCA_LIGHTBAKE_AO_RADIUS)
+	  occluded++;
+  }
+
+  return fmin(1, 2.0 * occluded / RCA_LIGHTBAKE_AO_RAYS);
+}
+
+/**
+ * Bake light map of a wall.
+ * 
+ * A wall of no length has its one luxel lit as if it faced every lamp.
+ * 
+ * @param index Index of the wall.
+ * @param data  Light maps being baked (one after the other).
+ */
+void RCA_BakeWall(int index, void *data)
+{
+  Sector *wall = walls[index];
+  int luxels = RCA_CountLuxels(wall);
+  unsigned char *light = (unsigned char *)data + offsets[index];
+  double length = sqrt((wall->x2 - wall->x1) * (wall->x2 - wall->x1) + (wall->y2 - wall->y1) * (wall->y2 - wall->y1));
+  double along[2] = {0, 0};
+  double point[2], dx, dy, distance, added, incidence;
+  double ambient = owners[index]->light, lit_wall, lit_floor;
+  int k, l, cell[2];
+  Lamp *lamp;
+  Bin *bin;
+
+  if (length > 0)
+  {
+	along[0] = (wall->x2 - wall->x1) / length;
+	along[1] = (wall->y2 - wall->y1) / length;
+  }
+
+  for (k = 0; k < luxels; k++)
+  {
+	RCA_FindLuxelCenter(wall, k, point);
+	lit_wall = ambient;
+	lit_floor = ambient * (1 - RCA_LIGHTBAKE_AO_STRENGTH * RCA_FindOcclusion(point[0], point[1], wall));
+
+	RCA_FindCell(point[0], point[1], cell);
+	bin = &lamps[cell[1] * grid_columns + cell[0]];
+	for (l = 0; l < bin->count; l++)
+	{
+	  lamp = &map->lamps[bin->items[l]];
+	  dx = point[0] - lamp->x;
+	  dy = point[1] - lamp->y;
+	  distance = sqrt(dx * dx + dy * dy);
+	  if (distance >= lamp->radius)
+		continue;
+
+	  /* shadow ray, from the lamp to the luxel */
+	  if (distance > 1)
+	  {
+		Element origin = {RCA_ELEMENT_TYPE, lamp->x, lamp->y, 0};
+		if (RCA_FindOccluder(&origin, RCA_DegreesToBAM(atan2(dy, dx) * 180 / M_PI), point[0], point[1], wall) < distance - 1)
+		  continue;
+	  }
+
+	  /* the wall gets less of a lamp seen at a grazing angle, the floor doesn't */
+	  added = lamp->light * (1 - distance / lamp->radius);
+	  incidence = (distance > 1 && length > 0) ? fabs(along[0] * dy - along[1] * dx) / distance : 1;
+	  lit_wall += added * incidence;
+	  lit_floor += added;
+	}
+
+	light[k] = (unsigned char)fmin(255, lit_wall);
+	light[luxels + k] = (unsigned char)fmin(255, lit_floor);
+  }
+}
+
+/**
+ * Write the map again, with the light maps.
+ * 
+ * Every record is copied as is (old light maps left out), each wall
+ * followed by its light map.
+ * 
+ * @param input  Path of the map.
+ * @param output Output file.
+ * @return       True (1) if the map was written, false (0) otherwise.
+ */
+int RCA_WriteBakedMap(const char *input, FILE *output)
+{
+  char line[RCA_MAP_LINE];
+  const char *record;
+  int i, k, luxels;
+  FILE *file = fopen(input, "r");
+
+  if (file == NULL)
+	return 0;
+
+  for (i = 0; fgets(line, RCA_MAP_LINE, file) != NULL; )
+  {
+	record = line + strspn(line, " \t");
+	if (strncmp(record, "lightmap", 8) == 0)
+	  continue;
+
+	fputs(line, output);
+	if (strncmp(record, "wall", 4) == 0 && i < wall_count)
+	{
+	  luxels = RCA_CountLuxels(walls[i]);
+	  fprintf(output, "lightmap ");
+	  for (k = 0; k < 2 * luxels; k++)
+	  {
+		fprintf(output, "%02x", baked[offsets[i] + k]);
+	  }
+	  fprintf(output, "\n");
+	  i++;
+	}
+  }
+  fclose(file);
+
+  return !ferror(output);
+}
+
+/**
+ * Main function of the baker.
+ * 
+ * Usage: lightbake --map file [--output file] [--threads n]
+ * 
+ * @param argc Arguments passed on the command line (number).
+ * @param argv Arguments passed on the command line (values).
+ * @return     0 (meaning we're done) or 1 (the map can't be read or written)
+ */
+int main(int argc, char **argv)
+{
+  int i, s, threads = 4, size = 0;
+  const char *path = NULL, *output = NULL;
+  FILE *file = stdout;
+  double start;
+  Sector *wall;
+
+  for (i = 1; i < argc - 1; i++)
+  {
+	if (strcmp(argv[i], "--map") == 0)
+	  path = argv[++i];
+	else if (strcmp(argv[i], "--output") == 0)
+	  output = argv[++i];
+	else if (strcmp(argv[i], "--threads") == 0)
+	  threads = atoi(argv[++i]);
+  }
+
+  SDL_Init(0);
+  RCA_InitBAM();
+
+  map = (path != NULL) ? RCA_LoadMap(path) : NULL;
+  if (map == NULL)
+  {
+	fprintf(stderr, "can't load map %s\n", (path != NULL) ? path : "(none)");
+	return 1;
+  }
+
+  for (s = 0; s < map->count; s++)
+  {
+	for (wall = map->sectors[s]->first->next; wall != NULL; wall = wall->next)
+	{
+	  wall_count++;
+	}
+  }
+  walls = malloc(wall_count * sizeof(Sector *));
+  owners = malloc(wall_count * sizeof(Sector *));
+  offsets = malloc(wall_count * sizeof(int));
+  for (s = 0, i = 0; s < map->count; s++)
+  {
+	for (wall = map->sectors[s]->first->next; wall != NULL; wall = wall->next, i++)
+	{
+	  walls[i] = wall;
+	  owners[i] = map->sectors[s];
+	  offsets[i] = size;
+	  size += 2 * RCA_CountLuxels(wall);
+	}
+  }
+  baked = malloc(size > 0 ? size : 1);
+
+  start = RCA_GetTime();
+  RCA_BuildGrid();
+  RCA_ParallelFor(wall_count, threads, RCA_BakeWall, baked);
+  fprintf(stderr, "lightbake: %d walls, %d lamps, %d luxels in %.3f s (%d threads)\n", wall_count, map->lamp_count,
+		  size / 2, RCA_GetTime() - start, threads);
+
+  if (output != NULL)
+	file = fopen(output, "w");
+  if (file == NULL || !RCA_WriteBakedMap(path, file))
+  {
+	fprintf(stderr, "can't write map %s\n", (output != NULL) ? output : "(stdout)");
+	return 1;
+  }
+  if (output != NULL)
+	fclose(file);
+
+  for (i = 0; i < grid_columns * grid_rows; i++)
+  {
+	free(occluders[i].items);
+	free(lamps[i].items);
+  }
+  free(occluders);
+  free(lamps);
+  free(walls);
+  free(owners);
+  free(offsets);
+  free(baked);
+  RCA_DestroyMap(map);
+  SDL_Quit();
+
+  return 0;
+}
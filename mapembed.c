@@ -0,0 +1,282 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Level embedder.  Writes a map as a C header of constant tables, to be
+ * built into the ray caster where the level never changes (a kiosk):
+ * every sector and wall is a Sector already linked to the others with
+ * its constants cached, the BSP tree is already compiled into the nodes
+ * of a BSParray and the light maps are a single array.  Nothing is read,
+ * allocated or computed to load such a level and its tables are read
+ * only.  They point to each other, so a position independent executable
+ * keeps them in .data.rel.ro (read only once relocated) rather than
+ * .rodata; build with -fno-pie -no-pie to have them shared as they are.
+ * 
+ * gcc -O2 mapembed.c `sdl-config --cflags --libs` -lSDL_gfx -o mapembed
+ * 
+ * ./mapembed --map lit.map --output level.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SDL.h"
+#include "SDL_gfxPrimitives.h"
+
+#include "RCA/bam.h"
+#include "RCA/bsparray.h"
+#include "RCA/bsptree.h"
+#include "RCA/map.h"
+#include "RCA/sector.h"
+
+Sector **objects;					/* every sector followed by its walls, as in the table */
+int *by_address;					/* indices of objects, sorted by address */
+int object_count = 0;
+
+/**
+ * Compare two objects by address (qsort).
+ * 
+ * @param a Pointer to an index of objects.
+ * @param b Pointer to an index of objects.
+ * @return  Order of their addresses.
+ */
+int RCA_CompareEmbeddedObjects(const void *a, const void *b)
+{
+  Sector *sa = objects[*(const int *)a];
+  Sector *sb = objects[*(const int *)b];
+
+  return (sa > sb) - (sa < sb);
+}
+
+/**
+ * Find an object in the table.
+ * 
+ * @param sector Pointer to a Sector object.
+ * @return       Its index, or -1 if it's not in the map.
+ */
+int RCA_FindEmbeddedObject(Sector *sector)
+{
+  int low = 0, high = object_count - 1, middle;
+
+  while (low <= high)
+  {
+	middle = (low + high) / 2;
+	if (objects[by_address[middle]] == sector)
+	  return by_address[middle];
+	if (objects[by_address[middle]] < sector)
+	  low = middle + 1;
+	else
+	  high = middle - 1;
+  }
+
+  return -1;
+}
+
+/**
+ * Write a pointer into the table.
+ * 
+ * @param file   Header written.
+ * @param sector Pointer to a Sector object, or NULL.
+ */
+void RCA_WriteEmbeddedPointer(FILE *file, Sector *sector)
+{
+  if (sector == NULL)
+	fprintf(file, "NULL");
+  else
+	fprintf(file, "RCA_EMBEDDED_OBJECT(%d)", RCA_FindEmbeddedObject(sector));
+}
+
+/**
+ * Write a list of pointers into the table.
+ * 
+ * @param file    Header written.
+ * @param name    Name of the list.
+ * @param count   Name of its length.
+ * @param sectors Pointers to Sector objects.
+ * @param n       Number of them.
+ */
+void RCA_WriteEmbeddedList(FILE *file, const char *name, const char *count, Sector **sectors, int n)
+{
+  int i;
+
+  fprintf(file, "static Sector *const %s[%s] = {", name, count);
+  for (i = 0; i < n; i++)
+  {
+	fprintf(file, "%s", (i % 6 == 0) ? "\n  " : " ");
+	RCA_WriteEmbeddedPointer(file, sectors[i]);
+	fprintf(file, ",");
+  }
+  fprintf(file, "\n};\n\n");
+}
+
+/**
+ * Write a level.
+ * 
+ * The walls get their cached constants first, so that the renderer never
+ * writes to them.
+ * 
+ * @param file     Header written.
+ * @param path     Map of the level.
+ * @param map      Pointer to a Map object.
+ * @param bsparray Pointer to a BSParray object (the tree of the map).
+ * @param leaves   Sectors of the tree, in order.
+ * @param n        Number of leaves.
+ */
+void RCA_WriteEmbeddedLevel(FILE *file, const char *path, Map *map, BSParray *bsparray, Sector **leaves, int n)
+{
+  Sector *wall;
+  int i, j, size = 0;
+  unsigned int k;
+
+  fprintf(file, "/*\n * Level embedded from %s by mapembed, don't edit.\n */\n\n", path);
+  fprintf(file, "#include \"RCA/arena.h\"\n#include \"RCA/bam.h\"\n#include \"RCA/bsparray.h\"\n#include \"RCA/sector.h\"\n\n");
+  fprintf(file, "#ifndef RCA_EMBEDDED_LEVEL_H_\n#define RCA_EMBEDDED_LEVEL_H_\n\n");
+  fprintf(file, "#define RCA_EMBEDDED_OBJECTS %d\n", object_count);
+  fprintf(file, "#define RCA_EMBEDDED_SECTORS %d\n", map->count);
+  fprintf(file, "#define RCA_EMBEDDED_LEAVES %d\n", n);
+  fprintf(file, "#define RCA_EMBEDDED_X %.17g\n", map->x);
+  fprintf(file, "#define RCA_EMBEDDED_Y %.17g\n", map->y);
+  fprintf(file, "#define RCA_EMBEDDED_DIRECTION ((Angle)%u)\n", (unsigned int)map->direction);
+  fprintf(file, "#define RCA_EMBEDDED_TYPE (RCA_SECTOR_TYPE | RCA_ARENA_ALLOCATED)\t/* never freed */\n");
+  fprintf(file, "#define RCA_EMBEDDED_OBJECT(i) ((Sector *)&RCA_EMBEDDED__OBJECTS[i])\n\n");
+  fprintf(file, "static const double RCA_EMBEDDED__BOUNDS[4] = {%.17g, %.17g, %.17g, %.17g};\n\n", map->bounds[0],
+		  map->bounds[1], map->bounds[2], map->bounds[3]);
+
+  /* light maps, one after the other */
+  fprintf(file, "static const unsigned char RCA_EMBEDDED__LIGHTMAPS[] = {");
+  for (i = 0; i < object_count; i++)
+  {
+	for (j = 0; j < 2 * objects[i]->luxels; j++, size++)
+	  fprintf(file, "%s%d,", (size % 24 == 0) ? "\n  " : "", objects[i]->lightmap[j]);
+  }
+  fprintf(file, "%s};\n\n", (size == 0) ? "0" : "\n");
+
+  /* sectors, each followed by its walls */
+  fprintf(file, "static const Sector RCA_EMBEDDED__OBJECTS[RCA_EMBEDDED_OBJECTS] = {\n");
+  for (i = 0, size = 0; i < object_count; i++)
+  {
+	wall = objects[i];
+	RCA_UpdateWallConstants(wall);
+
+	fprintf(file, "  {.type = RCA_EMBEDDED_TYPE, .x1 = %.17g, .y1 = %.17g, .x2 = %.17g, .y2 = %.17g,\n",
+			wall->x1, wall->y1, wall->x2, wall->y2);
+	fprintf(file, "   .floor = %.17g, .ceiling = %.17g, .floor_slope = %.17g, .ceiling_slope = %.17g,\n",
+			wall->floor, wall->ceiling, wall->floor_slope, wall->ceiling_slope);
+	fprintf(file, "   .bottom_color = {%d, %d, %d, %d}, .middle_color = {%d, %d, %d, %d}, .top_color = {%d, %d, %d, %d},\n",
+			wall->bottom_color[0], wall->bottom_color[1], wall->bottom_color[2], wall->bottom_color[3],
+			wall->middle_color[0], wall->middle_color[1], wall->middle_color[2], wall->middle_color[3],
+			wall->top_color[0], wall->top_color[1], wall->top_color[2], wall->top_color[3]);
+	fprintf(file, "   .light = %d, .length = %.17g, .floor_gradient = %.17g, .ceiling_gradient = %.17g, .dirty = 0,\n",
+			wall->light, wall->length, wall->floor_gradient, wall->ceiling_gradient);
+	if (wall->lightmap != NULL)
+	{
+	  fprintf(file, "   .lightmap = (unsigned char *)RCA_EMBEDDED__LIGHTMAPS + %d, .luxels = %d,\n", size, wall->luxels);
+	  size += 2 * wall->luxels;
+	}
+
+	fprintf(file, "   .first = ");
+	RCA_WriteEmbeddedPointer(file, wall->first);
+	fprintf(file, ", .last = ");
+	RCA_WriteEmbeddedPointer(file, wall->last);
+	fprintf(file, ", .current = ");
+	RCA_WriteEmbeddedPointer(file, wall->current);
+	fprintf(file, ", .previous = ");
+	RCA_WriteEmbeddedPointer(file, wall->previous);
+	fprintf(file, ", .next = ");
+	RCA_WriteEmbeddedPointer(file, wall->next);
+	fprintf(file, "},\n");
+  }
+  fprintf(file, "};\n\n");
+
+  RCA_WriteEmbeddedList(file, "RCA_EMBEDDED__SECTORS", "RCA_EMBEDDED_SECTORS", map->sectors, map->count);
+  RCA_WriteEmbeddedList(file, "RCA_EMBEDDED__LEAVES", "RCA_EMBEDDED_LEAVES", leaves, n);
+
+  /* the tree, already compiled */
+  fprintf(file, "static const BSPnode RCA_EMBEDDED__NODES[%u] = {\n", bsparray->count);
+  for (k = 0; k < bsparray->count; k++)
+  {
+	fprintf(file, "  {.nx = %.17g, .ny = %.17g, .d = %.17g, .front = %u, .back = %u, .sector = ", bsparray->nodes[k].nx,
+			bsparray->nodes[k].ny, bsparray->nodes[k].d, bsparray->nodes[k].front, bsparray->nodes[k].back);
+	RCA_WriteEmbeddedPointer(file, bsparray->nodes[k].sector);
+	fprintf(file, "},\n");
+  }
+  fprintf(file, "};\n\n");
+
+  fprintf(file, "static const BSParray RCA_EMBEDDED__BSPARRAY = {.type = RCA_BSPARRAY_TYPE | RCA_ARENA_ALLOCATED,\n"
+		  "  .nodes = (BSPnode *)RCA_EMBEDDED__NODES, .count = %u, .depth = %d};\n\n", bsparray->count, bsparray->depth);
+  fprintf(file, "#endif\n");
+}
+
+/**
+ * Main function of the embedder.
+ * 
+ * Usage: mapembed --map file [--output file]
+ * 
+ * @param argc Arguments passed on the command line (number).
+ * @param argv Arguments passed on the command line (values).
+ * @return     0 (meaning we're done) or 1 (the map can't be read or the level written)
+ */
+int main(int argc, char **argv)
+{
+  int i, n;
+  const char *path = NULL, *output = NULL;
+  FILE *file;
+  Map *map;
+  BSParray *bsparray;
+  Sector **leaves, *wall;
+
+  for (i = 1; i < argc - 1; i++)
+  {
+	if (strcmp(argv[i], "--map") == 0)
+	  path = argv[++i];
+	else if (strcmp(argv[i], "--output") == 0)
+	  output = argv[++i];
+  }
+
+  SDL_Init(0);
+  RCA_InitBAM();
+
+  map = (path != NULL) ? RCA_LoadMap(path) : NULL;
+  if (map == NULL)
+  {
+	fprintf(stderr, "can't load map %s\n", (path != NULL) ? path : "(none)");
+	return 1;
+  }
+
+  objects = malloc((map->count + map->walls) * sizeof(Sector *));
+  by_address = malloc((map->count + map->walls) * sizeof(int));
+  for (i = 0; i < map->count; i++)
+  {
+	for (wall = map->sectors[i]; wall != NULL; wall = wall->next)
+	{
+	  by_address[object_count] = object_count;
+	  objects[object_count++] = wall;
+	}
+  }
+  qsort(by_address, object_count, sizeof(int), RCA_CompareEmbeddedObjects);
+
+  leaves = malloc(map->count * sizeof(Sector *));
+  n = RCA_FindBSPtreeSectors(map->bsptree, leaves, 0, map->count);
+  bsparray = RCA_CompileBSPtree(map->bsptree);
+
+  file = (output != NULL) ? fopen(output, "w") : stdout;
+  if (file == NULL)
+  {
+	fprintf(stderr, "can't write level %s\n", output);
+	return 1;
+  }
+  RCA_WriteEmbeddedLevel(file, path, map, bsparray, leaves, n);
+  if (file != stdout)
+	fclose(file);
+
+  fprintf(stderr, "mapembed: %d sectors, %d walls, %u nodes\n", map->count, object_count - map->count, bsparray->count);
+
+  RCA_DestroyBSParray(bsparray);
+  RCA_DestroyMap(map);
+  free(leaves);
+  free(by_address);
+  free(objects);
+
+  return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * @author Sebastien Bolduc <sebastien.bolduc@gmail.com>
+ * @version 1.00
+ * @since 2026-10-19
+ * 
+ * Map generator, for levels of any size (see RCA/map.h for the format).
+ * The map is a grid of cells, each one a room and an alcove with a raised
+ * floor and a lowered ceiling (sometimes a ramp).  Doors between the
+ * cells make a maze (every cell can be reached) with a few loops, and
+ * some rooms are corridors with a lower ceiling.  Half of the rooms get
+ * a lamp, lighting the map once baked.  The same seed always gives the
+ * same map.
+ * 
+ * gcc -O2 mapgen.c -o mapgen
+ * 
+ * ./mapgen --walls 100000 --output big.map   (about 100k walls)
+ * ./mapgen --seed 7 > small.map              (about 1k walls, another maze)
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RCA_MAPGEN_CELL 256			/* size of a cell */
+#define RCA_MAPGEN_WALLS_PER_CELL 12	/* on average */
+#define RCA_MAPGEN_LOOPS 0.15			/* chance of a door outside of the maze */
+#define RCA_MAPGEN_CORRIDORS 0.25		/* chance of a room being a corridor */
+#define RCA_MAPGEN_RAMPS 0.3			/* chance of an alcove being a ramp */
+#define RCA_MAPGEN_LAMPS 0.5			/* chance of a room having a lamp (see lightbake.c) */
+
+/* colours (RRGGBBAA) */
+#define RCA_MAPGEN_INVISIBLE 0xffffff00u
+#define RCA_MAPGEN_WHITE 0xffffffffu
+#define RCA_MAPGEN_GREY 0x646464ffu
+#define RCA_MAPGEN_LIGHT_YELLOW 0xffff00ffu
+#define RCA_MAPGEN_DARK_YELLOW 0x646400ffu
+#define RCA_MAPGEN_LIGHT_RED 0xc80000ffu
+#define RCA_MAPGEN_DARK_RED 0x960000ffu
+#define RCA_MAPGEN_LIGHT_GREEN 0x00ff00ffu
+#define RCA_MAPGEN_DARK_GREEN 0x006400ffu
+
+typedef struct {
+  int door_east;				/* door to the next cell on x */
+  int door_south;				/* door to the next cell on y */
+  int corridor;
+  int ramp;
+  double floor;					/* of the alcove */
+  double ceiling;				/* of the alcove */
+} Cell;
+
+Cell *cells;
+int columns, rows;
+unsigned int seed = 2463534242u;
+int wall_count = 0;
+
+/**
+ * Random number (xorshift, same sequence on every platform).
+ * 
+ * @return Number between 0 and 1.
+ */
+double RCA_MapgenRandom(void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+
+  return seed / 4294967296.0;
+}
+
+/**
+ * Write a wall.
+ * 
+ * @param file    File of the map.
+ * @param x1      Start point of wall.
+ * @param y1      Start point of wall.
+ * @param x2      End point of wall.
+ * @param y2      End point of wall.
+ * @param floor   Ground on which the wall rest.
+ * @param ceiling Ceiling on which the wall rest.
+ * @param slope   Slope of the floor.
+ * @param bottom  Bottom wall's color.
+ * @param middle  Middle wall's color.
+ * @param top     Top wall's color.
+ */
+void RCA_WriteWall(FILE *file, double x1, double y1, double x2, double y2, double floor, double ceiling, double slope,
+				   unsigned int bottom, unsigned int middle, unsigned int top)
+{
+  fprintf(file, "wall %g %g %g %g %g %g %g 0 %08x %08x %08x\n", x1, y1, x2, y2, floor, ceiling, slope, bottom, middle, top);
+  wall_count++;
+}
+
+/**
+ * Write an edge of a sector, with a door in it or not.
+ * 
+ * The door is the middle of the edge going from (x1, y1) to (x2, y2),
+ * between the fractions a and b of its length.
+ * 
+ * @param file    File of the map.
+ * @param x1      Start point of edge.
+ * @param y1      Start point of edge.
+ * @param x2      End point of edge.
+ * @param y2      End point of edge.
+ * @param door    True (1) if there is a door.
+ * @param a       Start of the door (fraction of the edge).
+ * @param b       End of the door (fraction of the edge).
+ * @param floor   Ground on which the wall rest.
+ * @param ceiling Ceiling on which the wall rest.
+ * @param color   Colour of the wall.
+ * @param trim    Colour below and above the wall (and the door).
+ */
+void RCA_WriteEdge(FILE *file, double x1, double y1, double x2, double y2, int door, double a, double b, double floor,
+				   double ceiling, unsigned int color, unsigned int trim)
+{
+  double xa = x1 + (x2 - x1) * a, ya = y1 + (y2 - y1) * a;
+  double xb = x1 + (x2 - x1) * b, yb = y1 + (y2 - y1) * b;
+
+  if (!door)
+  {
+	RCA_WriteWall(file, x1, y1, x2, y2, floor, ceiling, 0, trim, color, trim);
+	return;
+  }
+
+  RCA_WriteWall(file, x1, y1, xa, ya, floor, ceiling, 0, trim, color, trim);
+  RCA_WriteWall(file, xa, ya, xb, yb, floor, ceiling, 0, trim, RCA_MAPGEN_INVISIBLE, trim);
+  RCA_WriteWall(file, xb, yb, x2, y2, floor, ceiling, 0, trim, color, trim);
+}
+
+/**
+ * Write the two sectors of a cell.
+ * 
+ * The room is the west three quarters of the cell, the alcove the rest.
+ * Doors on x go through the alcove, doors on y through the room.
+ * 
+ * @param file File of the map.
+ * @param i    Cell on x.
+ * @param j    Cell on y.
+ */
+void RCA_WriteCell(FILE *file, int i, int j)
+{
+  Cell *cell = &cells[j * columns + i];
+  double x0 = i * RCA_MAPGEN_CELL, y0 = j * RCA_MAPGEN_CELL;
+  double x1 = x0 + RCA_MAPGEN_CELL, y1 = y0 + RCA_MAPGEN_CELL;
+  double xa = x0 + RCA_MAPGEN_CELL * 3 / 4;
+  double ceiling = cell->corridor ? 25 : 0;
+  unsigned int light = cell->corridor ? RCA_MAPGEN_DARK_YELLOW : RCA_MAPGEN_WHITE;
+  unsigned int dark = cell->corridor ? RCA_MAPGEN_DARK_YELLOW : RCA_MAPGEN_GREY;
+  unsigned int side = cell->ramp ? RCA_MAPGEN_LIGHT_GREEN : RCA_MAPGEN_LIGHT_RED;
+  unsigned int end = cell->ramp ? RCA_MAPGEN_DARK_GREEN : RCA_MAPGEN_DARK_RED;
+  int north = j > 0 && cells[(j - 1) * columns + i].door_south;
+  int west = i > 0 && cells[j * columns + i - 1].door_east;
+
+  /* room, the doors on y are a third of its width */
+  fprintf(file, "sector\n");
+  fprintf(file, "light %d\n", cell->corridor ? 128 : 128 + (int)(RCA_MapgenRandom() * 64));
+  if (!cell->corridor && RCA_MapgenRandom() < RCA_MAPGEN_LAMPS)
+	fprintf(file, "lamp %g %g 128 320\n", (x0 + xa) / 2, (y0 + y1) / 2);
+  RCA_WriteEdge(file, x0, y0, xa, y0, north, 1.0 / 3, 2.0 / 3, 0, ceiling, light, dark);
+  RCA_WriteWall(file, xa, y0, xa, y1, 0, ceiling, 0, RCA_MAPGEN_INVISIBLE, RCA_MAPGEN_INVISIBLE, RCA_MAPGEN_INVISIBLE);
+  RCA_WriteEdge(file, xa, y1, x0, y1, cell->door_south, 1.0 / 3, 2.0 / 3, 0, ceiling, light, dark);
+  RCA_WriteEdge(file, x0, y1, x0, y0, west, 3.0 / 8, 5.0 / 8, 0, ceiling, dark, dark);
+
+  /* alcove, a step up (or a ramp going east from 5) under a lower ceiling */
+  fprintf(file, "sector\n");
+  fprintf(file, "light 176\n");
+  if (cell->ramp)
+  {
+	RCA_WriteWall(file, xa, y0, x1, y0, cell->floor, cell->ceiling, 5, side, side, side);
+	RCA_WriteWall(file, xa, y1, x1, y1, cell->floor, cell->ceiling, 5, side, side, side);
+	RCA_WriteWall(file, xa, y0, xa, y1, 5, cell->ceiling, 0, end, RCA_MAPGEN_INVISIBLE, end);
+	RCA_WriteEdge(file, x1, y0, x1, y1, cell->door_east, 3.0 / 8, 5.0 / 8, 5 + cell->floor, cell->ceiling, end, end);
+  }
+  else
+  {
+	RCA_WriteWall(file, xa, y0, x1, y0, cell->floor, cell->ceiling, 0, side, side, side);
+	RCA_WriteWall(file, xa, y1, x1, y1, cell->floor, cell->ceiling, 0, side, side, side);
+	RCA_WriteWall(file, xa, y0, xa, y1, cell->floor, cell->ceiling, 0, end, RCA_MAPGEN_INVISIBLE, end);
+	RCA_WriteEdge(file, x1, y0, x1, y1, cell->door_east, 3.0 / 8, 5.0 / 8, cell->floor, cell->ceiling, end, end);
+  }
+}
+
+/**
+ * Write the BSP tree of a block of cells.
+ * 
+ * The block is split in half across its longer side, the front being
+ * the higher half.  A single cell is split between its room (back) and
+ * its alcove (front).
+ * 
+ * @param file File of the map.
+ * @param i1   First cell on x.
+ * @param j1   First cell on y.
+ * @param i2   Last cell on x (excluded).
+ * @param j2   Last cell on y (excluded).
+ */
+void RCA_WriteTree(FILE *file, int i1, int j1, int i2, int j2)
+{
+  int middle;
+
+  if (i2 - i1 == 1 && j2 - j1 == 1)
+  {
+	fprintf(file, "node %d %d %d %d\n", i1 * RCA_MAPGEN_CELL + RCA_MAPGEN_CELL * 3 / 4, j1 * RCA_MAPGEN_CELL,
+			i1 * RCA_MAPGEN_CELL + RCA_MAPGEN_CELL * 3 / 4, j2 * RCA_MAPGEN_CELL);
+	fprintf(file, "leaf %d\n", (j1 * columns + i1) * 2 + 1);
+	fprintf(file, "leaf %d\n", (j1 * columns + i1) * 2);
+	return;
+  }
+
+  if (i2 - i1 >= j2 - j1)
+  {
+	middle = (i1 + i2) / 2;
+	fprintf(file, "node %d %d %d %d\n", middle * RCA_MAPGEN_CELL, j1 * RCA_MAPGEN_CELL, middle * RCA_MAPGEN_CELL, j2 * RCA_MAPGEN_CELL);
+	RCA_WriteTree(file, middle, j1, i2, j2);
+	RCA_WriteTree(file, i1, j1, middle, j2);
+  }
+  else
+  {
+	middle = (j1 + j2) / 2;
+	fprintf(file, "node %d %d %d %d\n", i1 * RCA_MAPGEN_CELL, middle * RCA_MAPGEN_CELL, i2 * RCA_MAPGEN_CELL, middle * RCA_MAPGEN_CELL);
+	RCA_WriteTree(file, i1, middle, i2, j2);
+	RCA_WriteTree(file, i1, j1, i2, middle);
+  }
+}
+
+/**
+ * Main function of the generator.
+ * 
+ * Usage: mapgen [--seed n] [--walls n] [--output file]
+ * 
+ * @param argc Arguments passed on the command line (number).
+ * @param argv Arguments passed on the command line (values).
+ * @return     0 (meaning we're done) or 1 (the map can't be written)
+ */
+int main(int argc, char **argv)
+{
+  int i, j, walls = 1000;
+  const char *output = NULL;
+  FILE *file = stdout;
+
+  for (i = 1; i < argc - 1; i++)
+  {
+	if (strcmp(argv[i], "--seed") == 0)
+	  seed = (unsigned int)strtoul(argv[++i], NULL, 10) * 2654435761u + 2463534242u;
+	else if (strcmp(argv[i], "--walls") == 0)
+	  walls = atoi(argv[++i]);
+	else if (strcmp(argv[i], "--output") == 0)
+	  output = argv[++i];
+  }
+
+  /* xorshift never leaves 0 */
+  if (seed == 0)
+	seed = 2463534242u;
+
+  columns = (int)ceil(sqrt((double)walls / RCA_MAPGEN_WALLS_PER_CELL));
+  if (columns < 1)
+	columns = 1;
+  rows = (walls / RCA_MAPGEN_WALLS_PER_CELL + columns - 1) / columns;
+  if (rows < 1)
+	rows = 1;
+
+  /* binary tree maze, every cell opens east or south, plus a few loops */
+  cells = malloc(columns * rows * sizeof(Cell));
+  for (j = 0; j < rows; j++)
+  {
+	for (i = 0; i < columns; i++)
+	{
+	  Cell *cell = &cells[j * columns + i];
+	  int east = (RCA_MapgenRandom() < 0.5);
+
+	  if (i == columns - 1)
+		east = 0;
+	  if (j == rows - 1)
+		east = 1;
+
+	  cell->door_east = (i < columns - 1) && (east || RCA_MapgenRandom() < RCA_MAPGEN_LOOPS);
+	  cell->door_south = (j < rows - 1) && (!east || RCA_MapgenRandom() < RCA_MAPGEN_LOOPS);
+	  cell->corridor = (RCA_MapgenRandom() < RCA_MAPGEN_CORRIDORS);
+	  cell->ramp = (RCA_MapgenRandom() < RCA_MAPGEN_RAMPS);
+	  cell->floor = 10 + floor(RCA_MapgenRandom() * 4) * 5;
+	  cell->ceiling = 10 + floor(RCA_MapgenRandom() * 3) * 5;
+	}
+  }
+
+  if (output != NULL)
+  {
+	file = fopen(output, "w");
+	if (file == NULL)
+	{
+	  fprintf(stderr, "can't write map %s\n", output);
+	  free(cells);
+	  return 1;
+	}
+  }
+
+  fprintf(file, "# mapgen, %dx%d cells\n", columns, rows);
+  fprintf(file, "player %d %d 0\n", RCA_MAPGEN_CELL * 3 / 8, RCA_MAPGEN_CELL / 2);
+  for (j = 0; j < rows; j++)
+  {
+	for (i = 0; i < columns; i++)
+	{
+	  RCA_WriteCell(file, i, j);
+	}
+  }
+  fprintf(file, "tree\n");
+  RCA_WriteTree(file, 0, 0, columns, rows);
+
+  if (output != NULL)
+	fclose(file);
+  fprintf(stderr, "mapgen: %d walls, %d sectors (%dx%d cells)\n", wall_count, columns * rows * 2, columns, rows);
+  free(cells);
+
+  return 0;
+}
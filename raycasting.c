@@ -4,22 +4,55 @@
  * @since 2012-02-20
  * 
  * gcc raycasting.c `sdl-config --cflags --libs` -lSDL_gfx -lSDL_ttf -o raycasting
+ * 
+ * ./raycasting --record session.rca              (play and record the input)
+ * ./raycasting --replay session.rca --timing t   (replay without a window)
+ * ./raycasting --replay session.rca --perf       (and count cycles, cache misses... of every stage)
+ * ./raycasting --batch poses.txt --threads 8      (render every pose to a bitmap)
+ * ./raycasting --shm /rca-frames                  (publish every frame in shared memory)
+ * ./raycasting --map big.map                      (a level made by mapgen instead of the demo)
+ * ./raycasting --map big.map --watch              (the level is reloaded whenever the file changes)
+ * 
+ * gcc -DRCA_EMBEDDED_LEVEL='"level.h"' raycasting.c ...
+ *                                                  (the level written by mapembed is built in, instead of the demo)
  */
  
 #include <math.h>
+#include <stdio.h>
+#include <string.h>
 #include "SDL.h"
 #include "SDL_gfxPrimitives.h"
 #include "SDL_ttf.h"
 
 #include "../MyOwnFramework/mof/mof_font.h"
 
+#include "RCA/arena.h"
+#include "RCA/bsparray.h"
 #include "RCA/bsptree.h"
+#include "RCA/colormap.h"
 #include "RCA/element.h"
-#include "RCA/keyboard.h"
+#include "RCA/framering.h"
+#include "RCA/hotreload.h"
+#include "RCA/input.h"
+#include "RCA/lights.h"
+#include "RCA/map.h"
+#include "RCA/minimap.h"
+#include "RCA/mover.h"
+#include "RCA/palette.h"
+#include "RCA/perfcounter.h"
+#include "RCA/queue.h"
 #include "RCA/raycaster.h"
+#include "RCA/recorder.h"
 #include "RCA/sector.h"
+#include "RCA/sprite.h"
+#include "RCA/timer.h"
+
+#ifdef RCA_EMBEDDED_LEVEL
+#include RCA_EMBEDDED_LEVEL
+#endif
 
 SDL_Surface *screen;
+SDL_Surface *indexed_frame = NULL;	/* drawn into with --indexed */
 SDL_Event event;
 
 const int WINDOW_WIDTH = 1280;
@@ -31,7 +64,27 @@ mof_Font *text = NULL;
 char test[100] = {"/0"};
 int mapflag = 0;
 int release_m = 1;
+int release_l = 1;
+int release_space = 1;
+int release_zoom = 1;
+int headless = 0;
+int single_pass = 0;
+int ray_walk = 0;
+int adaptive = 0;
+int indexed = 0;
+Recorder *recorder = NULL;
+const char *batch = NULL;
+const char *batch_output = ".";
+int batch_threads = 4;
+const char *ring_name = NULL;
+int ring_policy = RCA_FRAMERING_DROP_OLDEST;
+FrameRing *ring = NULL;
+PerfCounters *perf = NULL;
+const char *map_path = NULL;
+int watch = 0;
+MapWatch *map_watch = NULL;
 
+Arena *level;
 Element *player;
 Sector *sector_1;
 Sector *sector_2;
@@ -44,39 +97,55 @@ Sector *sector_8;
 Sector *sector_9;
 Sector *sector_10;
 Sector *sector_11;
+Sector *sector_12;
 BSPtree *bsptree;
+BSParray *bsparray;
+Map *map = NULL;
+Sector **leaves = NULL;
+int leaf_count = 0;
+Minimap *minimap;
+MoverList *movers;
+SpriteList *sprites;
+LightList *lights;
 
 /**
  * Initialization.
  */
 void RCA_Init()
 {
-  /* video */
-  SDL_Init(SDL_INIT_VIDEO);
+  if (headless)
+  {
+	/* no window, draw in memory */
+	SDL_Init(0);
+	screen = SDL_CreateRGBSurface(SDL_SWSURFACE, WINDOW_WIDTH, WINDOW_HEIGHT, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+  }
+  else
+  {
+	/* video */
+	SDL_Init(SDL_INIT_VIDEO);
   
-  /* window */
-  screen = SDL_SetVideoMode(WINDOW_WIDTH, WINDOW_HEIGHT, 0, SDL_HWSURFACE | SDL_DOUBLEBUF | SDL_RESIZABLE);
-  SDL_WM_SetCaption(WINDOW_TITLE, 0);
+	/* window */
+	screen = SDL_SetVideoMode(WINDOW_WIDTH, WINDOW_HEIGHT, 0, SDL_HWSURFACE | SDL_DOUBLEBUF | SDL_RESIZABLE);
+	SDL_WM_SetCaption(WINDOW_TITLE, 0);
 
-  /* keyboard */
-  //SDL_EnableKeyRepeat(SDL_DEFAULT_REPEAT_DELAY, SDL_DEFAULT_REPEAT_INTERVAL);
+	/* keyboard */
+	//SDL_EnableKeyRepeat(SDL_DEFAULT_REPEAT_DELAY, SDL_DEFAULT_REPEAT_INTERVAL);
   
-  /* TODO: add your code here */
-  text = mof_Font__new(screen, WINDOW_FONT);
+	/* TODO: add your code here */
+	text = mof_Font__new(screen, WINDOW_FONT);
+  }
   
-  bsptree = RCA_NewBSPtree(640, 0, 640, 719);
-  player = RCA_NewElement(640, 310, 270);
-  sector_1 = RCA_NewSector();
-  sector_2 = RCA_NewSector();
-  sector_3 = RCA_NewSector();
-  sector_4 = RCA_NewSector();
-  sector_5 = RCA_NewSector();
-  sector_6 = RCA_NewSector();
-  sector_7 = RCA_NewSector();
-  sector_8 = RCA_NewSector();
-  sector_9 = RCA_NewSector();
-  sector_10 = RCA_NewSector();
-  sector_11 = RCA_NewSector();
+  RCA_InitBAM();
+  RCA_InitColormap();
+  RCA_InitPalette();
+  RCA_InitInput();
+  level = RCA_NewArena(64 * 1024);
+  player = RCA_NewElement(640, 310, RCA_BAM_ANGLE_270);
+  minimap = RCA_NewMinimap(16);
+  movers = RCA_NewMoverList(256);
+  sprites = RCA_NewSpriteList(16384);
+  lights = RCA_NewLightList(1024);
+  RCA_SetActiveLights(lights);
 }
 
 /**
@@ -96,6 +165,23 @@ void RCA_Load()
   int light_red[4] = {200, 0, 0, 255};
   int dark_red[4] = {150, 0, 0, 255};
   
+  /* the whole map geometry lives in the level arena */
+  RCA_SetLevelArena(level);
+  
+  bsptree = RCA_NewBSPtree(640, 0, 640, 719);
+  sector_1 = RCA_NewSector();
+  sector_2 = RCA_NewSector();
+  sector_3 = RCA_NewSector();
+  sector_4 = RCA_NewSector();
+  sector_5 = RCA_NewSector();
+  sector_6 = RCA_NewSector();
+  sector_7 = RCA_NewSector();
+  sector_8 = RCA_NewSector();
+  sector_9 = RCA_NewSector();
+  sector_10 = RCA_NewSector();
+  sector_11 = RCA_NewSector();
+  sector_12 = RCA_NewSector();
+  
   RCA_AddWallToSector(sector_1, 600, 225, 600, 275, 0, 0, 0, 0, invisible, invisible, invisible);
   RCA_AddWallToSector(sector_1, 300, 200, 600, 200, 0, 0, 0, 0, invisible, white, invisible);
   RCA_AddWallToSector(sector_1, 300, 200, 300, 275, 0, 0, 0, 0, invisible, grey, invisible);
@@ -143,6 +229,12 @@ void RCA_Load()
   RCA_AddWallToSector(sector_11, 300, 300, 300, 400, 0, 0, 0, 0, invisible, grey, invisible);
   RCA_AddWallToSector(sector_11, 300, 400, 600, 400, 0, 0, 0, 0, invisible, white, invisible);
   
+  /* sliding block, not in the BSP tree */
+  RCA_AddWallToSector(sector_12, 400, 345, 440, 345, 0, 0, 0, 0, invisible, grey, invisible);
+  RCA_AddWallToSector(sector_12, 440, 345, 440, 355, 0, 0, 0, 0, invisible, light_grey, invisible);
+  RCA_AddWallToSector(sector_12, 440, 355, 400, 355, 0, 0, 0, 0, invisible, grey, invisible);
+  RCA_AddWallToSector(sector_12, 400, 355, 400, 345, 0, 0, 0, 0, invisible, light_grey, invisible);
+  
   /* BSP tree */
   RCA_AddNodeToBSPtreeFront(bsptree, 790, 0, 790, 719);
     RCA_AddLeafToBSPtreeBack(bsptree->front, sector_6);
@@ -163,7 +255,178 @@ void RCA_Load()
 	  RCA_AddLeafToBSPtreeFront(bsptree->back->front, sector_4);
 	  RCA_AddNodeToBSPtreeBack(bsptree->back->front, 0, 225, 1279, 225);
 	    RCA_AddLeafToBSPtreeFront(bsptree->back->front->back, sector_3);
-	    RCA_AddLeafToBSPtreeBack(bsptree->back->front->back, sector_2);
+		RCA_AddLeafToBSPtreeBack(bsptree->back->front->back, sector_2);
+  
+  /* every leaf, for the single pass casting */
+  leaves = malloc(64 * sizeof(Sector *));
+  leaf_count = RCA_FindBSPtreeSectors(bsptree, leaves, 0, 64);
+  
+  /* the tree walked when drawing */
+  bsparray = RCA_CompileBSPtree(bsptree);
+		
+  /* light */
+  RCA_SetSectorLight(sector_7, 224);
+  RCA_SetSectorLight(sector_9, 192);
+  RCA_SetSectorLight(sector_11, 160);
+  RCA_SetSectorLight(sector_12, 160);
+  
+  /* movers (a lift and a sliding block going back and forth) */
+  RCA_ActivateMover(movers, RCA_AddMoverToList(movers, sector_7, RCA_MOVER_FLOOR, 20, 60, 0.5, 60), 1);
+  RCA_ActivateMover(movers, RCA_AddMoverToList(movers, sector_12, RCA_MOVER_SLIDE, 0, 100, 0.5, 60), 1);
+  
+  /* minimap */
+  RCA_AddSectorToMinimap(minimap, sector_1);
+  RCA_AddSectorToMinimap(minimap, sector_2);
+  RCA_AddSectorToMinimap(minimap, sector_3);
+  RCA_AddSectorToMinimap(minimap, sector_4);
+  RCA_AddSectorToMinimap(minimap, sector_5);
+  RCA_AddSectorToMinimap(minimap, sector_6);
+  RCA_AddSectorToMinimap(minimap, sector_7);
+  RCA_AddSectorToMinimap(minimap, sector_8);
+  RCA_AddSectorToMinimap(minimap, sector_9);
+  RCA_AddSectorToMinimap(minimap, sector_10);
+  RCA_AddSectorToMinimap(minimap, sector_11);
+  RCA_AddSectorToMinimap(minimap, sector_12);
+  
+  /* sprites */
+  RCA_AddSpriteToList(sprites, 700, 250, 6, 40, light_yellow);
+  RCA_AddSpriteToList(sprites, 720, 370, 6, 40, light_yellow);
+  RCA_AddSpriteToList(sprites, 400, 350, 10, 80, dark_green);
+  
+  /* dynamic lights (none until the player lights the torch or fires) */
+  RCA_SetLightGrid(lights, 300, 200, 800, 400);
+  
+  RCA_SetLevelArena(NULL);
+}
+
+/**
+ * Making a loaded map the level.
+ * 
+ * @param loaded Pointer to a Map object.
+ */
+void RCA_UseMap(Map *loaded)
+{
+  int i;
+  
+  map = loaded;
+  bsptree = map->bsptree;
+  leaves = malloc(map->count * sizeof(Sector *));
+  leaf_count = RCA_FindBSPtreeSectors(bsptree, leaves, 0, map->count);
+  bsparray = RCA_CompileBSPtree(bsptree);
+  
+  for (i = 0; i < map->count; i++)
+  {
+	RCA_AddSectorToMinimap(minimap, map->sectors[i]);
+  }
+  
+  player->x = map->x;
+  player->y = map->y;
+  player->direction = map->direction;
+  RCA_SetLightGrid(lights, map->bounds[0], map->bounds[1], map->bounds[2], map->bounds[3]);
+}
+
+/**
+ * Loading a map made by mapgen, instead of the demo.
+ * 
+ * @param path Path of the map.
+ * @return     True (1) if the map was loaded, false (0) otherwise.
+ */
+int RCA_LoadFromMap(const char *path)
+{
+  Map *loaded;
+  
+  RCA_SetLevelArena(level);
+  loaded = RCA_LoadMap(path);
+  if (loaded == NULL)
+  {
+	RCA_SetLevelArena(NULL);
+	RCA_ResetArena(level);
+	return 0;
+  }
+  
+  RCA_UseMap(loaded);
+  RCA_SetLevelArena(NULL);
+  
+  return 1;
+}
+
+#ifdef RCA_EMBEDDED_LEVEL
+/**
+ * Making the level built in by mapembed the level.
+ * 
+ * Its tables are used as they are: nothing is allocated and the walls,
+ * already linked and with their constants cached, are only read.
+ */
+void RCA_LoadEmbedded()
+{
+  int i;
+  
+  bsptree = NULL;
+  bsparray = (BSParray *)&RCA_EMBEDDED__BSPARRAY;
+  leaves = (Sector **)RCA_EMBEDDED__LEAVES;
+  leaf_count = RCA_EMBEDDED_LEAVES;
+  
+  for (i = 0; i < RCA_EMBEDDED_SECTORS; i++)
+  {
+	RCA_AddSectorToMinimap(minimap, RCA_EMBEDDED__SECTORS[i]);
+  }
+  
+  player->x = RCA_EMBEDDED_X;
+  player->y = RCA_EMBEDDED_Y;
+  player->direction = RCA_EMBEDDED_DIRECTION;
+  RCA_SetLightGrid(lights, RCA_EMBEDDED__BOUNDS[0], RCA_EMBEDDED__BOUNDS[1], RCA_EMBEDDED__BOUNDS[2],
+				   RCA_EMBEDDED__BOUNDS[3]);
+}
+#endif
+
+/**
+ * Reloading the map when its file changed, between two frames.
+ * 
+ * Only what changed is rebuilt, unless sectors were added or removed:
+ * the map is then loaded again next to the old one, which is drawn
+ * until the new one is ready.  The player stays where it is.
+ */
+void RCA_HotReload()
+{
+  double start = RCA_GetTime(), x = player->x, y = player->y;
+  Angle direction = player->direction;
+  Map *loaded;
+  
+  switch (RCA_ReloadMap(map_watch, map, &bsparray, minimap))
+  {
+	case RCA_HOTRELOAD_DONE:
+	  bsptree = map->bsptree;
+	  if (map_watch->nodes_rebuilt > 0)
+		leaf_count = RCA_FindBSPtreeSectors(bsptree, leaves, 0, map->count);
+	  RCA_SetLightGrid(lights, map->bounds[0], map->bounds[1], map->bounds[2], map->bounds[3]);
+	  printf("reloaded %s: %d sectors and %d tree nodes in %.2f ms\n", map_path, map_watch->sectors_rebuilt,
+			 map_watch->nodes_rebuilt, (RCA_GetTime() - start) * 1000);
+	  break;
+	  
+	case RCA_HOTRELOAD_FULL:
+	  /* out of the level arena, the old map is still in it */
+	  loaded = RCA_LoadMap(map_path);
+	  if (loaded == NULL)
+	  {
+		fprintf(stderr, "can't reload map %s\n", map_path);
+		break;
+	  }
+	  RCA_DestroyMap(map);
+	  RCA_DestroyBSParray(bsparray);
+	  RCA_ClearMinimap(minimap);
+	  RCA_ResetArena(level);
+	  free(leaves);
+	  RCA_UseMap(loaded);
+	  player->x = x;
+	  player->y = y;
+	  player->direction = direction;
+	  printf("loaded %s again: %d sectors in %.2f ms\n", map_path, map->count, (RCA_GetTime() - start) * 1000);
+	  break;
+	  
+	case RCA_HOTRELOAD_FAILED:
+	  fprintf(stderr, "can't reload map %s\n", map_path);
+	  break;
+  }
 }
 
 /**
@@ -172,65 +435,69 @@ void RCA_Load()
 void RCA_Unload()
 {
   /* TODO: add your code here */
+  
+  /* map geometry (sectors and BSP tree) is released all at once */
+  if (map != NULL)
+	RCA_DestroyMap(map);
+  map = NULL;
+  RCA_ClearMinimap(minimap);
+  RCA_ClearMoverList(movers);
+  RCA_ClearSpriteList(sprites);
+  RCA_ClearLightList(lights);
+  /* recompiled out of the level arena by a hot reload */
+  if (bsparray != NULL && !(bsparray->type & RCA_ARENA_ALLOCATED))
+	RCA_DestroyBSParray(bsparray);
+  RCA_ResetArena(level);
+  bsptree = NULL;
+  bsparray = NULL;
+#ifdef RCA_EMBEDDED_LEVEL
+  /* the built in level isn't ours to free */
+  if (leaves == (Sector **)RCA_EMBEDDED__LEAVES)
+	leaves = NULL;
+#endif
+  free(leaves);
+  leaves = NULL;
+  leaf_count = 0;
 }
 
 /**
- * Updating.
+ * Applying the input of a tick.
  * 
- * @param running_loop Determine if the loop still have to be executed.
+ * Everything that changes the game goes through here, so a recorded
+ * session is played back exactly the same way.
+ * 
+ * @param tick Input of the tick.
  */
-void RCA_Update(int *running_loop)
+void RCA_ApplyInput(InputTick *tick)
 {
-  /* TODO: add your code here */	
-  while (SDL_PollEvent(&event))			/* every event must be poll from the queue... */
+  int torch;
+  
+  /* the mouse, however many motion events it took */
+  if (tick->xrel != 0)
   {
-	/* handling the SDL window */
-	if (event.type == SDL_QUIT)
-	{
-	  *running_loop = 0;
-	}
-	if (event.type == SDL_VIDEORESIZE)
-	{
-	  screen = SDL_SetVideoMode(event.resize.w, event.resize.h, 0, SDL_HWSURFACE | SDL_DOUBLEBUF | SDL_RESIZABLE);
-	}
-	
-	/* handling the mouse */
-	if (event.type == SDL_MOUSEMOTION)
-	{
-	  if (event.motion.xrel > 0)
-	  {
-		RCA_RotateElement(player, 0.5);
-	  }
-	  if (event.motion.xrel < 0)
-	  {
-		RCA_RotateElement(player, -0.5);
-	  }
-	}
-	
-	/* handling the keyboard (game-type input) */
-	RCA_PollKeyboardEvent(&event);
+	RCA_RotateElement(player, RCA_DegreesToBAM(RCA_INPUT_SENSITIVITY * tick->xrel));
   }
   
   /* taking care of the keyboard (game-type input) */
-  if (RCA_CheckKeyboardKey(SDLK_LEFT))
+  if (tick->keys & RCA_INPUT_LEFT)
   {
 	RCA_MoveElementLeft(player, 1);
   }
-  if (RCA_CheckKeyboardKey(SDLK_RIGHT))
+  if (tick->keys & RCA_INPUT_RIGHT)
   {
 	RCA_MoveElementRight(player, 1);
   }
-  if (RCA_CheckKeyboardKey(SDLK_UP))
+  if (tick->keys & RCA_INPUT_UP)
   {
 	RCA_MoveElementForward(player, 1);
   }
-  if (RCA_CheckKeyboardKey(SDLK_DOWN))
+  if (tick->keys & RCA_INPUT_DOWN)
   {
 	RCA_MoveElementBackward(player, 1);
   }
   
   /* toggling map */
-  if (RCA_CheckKeyboardKey(SDLK_m))
+  if (tick->keys & RCA_INPUT_M)
   {
 	if (release_m)
 	{
@@ -242,6 +509,104 @@ void RCA_Update(int *running_loop)
   {
 	release_m = 1;
   }
+  
+  /* panning and zooming the map, around the middle of the window */
+  if (mapflag)
+  {
+	if (tick->keys & RCA_INPUT_PAN_UP)
+	  RCA_PanMinimap(minimap, 0, -RCA_MINIMAP_PAN_STEP);
+	if (tick->keys & RCA_INPUT_PAN_DOWN)
+	  RCA_PanMinimap(minimap, 0, RCA_MINIMAP_PAN_STEP);
+	if (tick->keys & RCA_INPUT_PAN_RIGHT)
+	  RCA_PanMinimap(minimap, RCA_MINIMAP_PAN_STEP, 0);
+	if (tick->keys & RCA_INPUT_PAN_LEFT)
+	  RCA_PanMinimap(minimap, -RCA_MINIMAP_PAN_STEP, 0);
+  }
+  if (tick->keys & (RCA_INPUT_ZOOM_IN | RCA_INPUT_ZOOM_OUT))
+  {
+	if (release_zoom && mapflag)
+	{
+	  RCA_ZoomMinimap(minimap, (tick->keys & RCA_INPUT_ZOOM_IN) ? 1 : -1, screen->w / 2, screen->h / 2);
+	  release_zoom = 0;
+	}
+  }
+  else 
+  {
+	release_zoom = 1;
+  }
+  
+  /* torch carried by the player */
+  if (tick->keys & RCA_INPUT_L)
+  {
+	if (release_l)
+	{
+	  torch = RCA_FindCarriedLight(lights, player);
+	  if (torch >= 0)
+		RCA_RemoveLightFromList(lights, torch);
+	  else if ((torch = RCA_AddLightToList(lights, player->x, player->y, 96, 160, 0)) >= 0)
+		RCA_AttachLight(lights, torch, player);
+	  release_l = 0;
+	}
+  }
+  else 
+  {
+	release_l = 1;
+  }
+  
+  /* muzzle flash, a few ticks in front of the player */
+  if (tick->keys & RCA_INPUT_SPACE)
+  {
+	if (release_space)
+	{
+	  RCA_AddLightToList(lights, player->x + RCA_FineCosine(player->direction) * 8, player->y + RCA_FineSine(player->direction) * 8,
+						 160, 120, 6);
+	  release_space = 0;
+	}
+  }
+  else 
+  {
+	release_space = 1;
+  }
+  
+  /* doors, lifts and sliding walls */
+  RCA_UpdateMovers(movers);
+  
+  /* flashes fading */
+  RCA_UpdateLights(lights);
+}
+
+/**
+ * Updating.
+ * 
+ * @param running_loop Determine if the loop still have to be executed.
+ * @param tick         Input of the tick (output).
+ */
+void RCA_Update(int *running_loop, InputTick *tick)
+{
+  /* TODO: add your code here */	
+  while (SDL_PollEvent(&event))			/* every event must be poll from the queue... */
+  {
+	/* handling the SDL window */
+	if (event.type == SDL_QUIT)
+	{
+	  *running_loop = 0;
+	}
+	if (event.type == SDL_VIDEORESIZE)
+	{
+	  screen = SDL_SetVideoMode(event.resize.w, event.resize.h, 0, SDL_HWSURFACE | SDL_DOUBLEBUF | SDL_RESIZABLE);
+	}
+	
+	/* handling the keyboard and the mouse (game-type input) */
+	RCA_PollInputEvent(&event);
+  }
+  RCA_SnapshotInput(tick);
+  
+  if (recorder != NULL)
+  {
+	RCA_RecordTick(recorder, tick);
+  }
+  
+  RCA_ApplyInput(tick);
 }
 
 /**
@@ -249,73 +614,543 @@ void RCA_Update(int *running_loop)
  */
 void RCA_Draw()
 {	
-  /* clear the screen */
-  SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 0));
+  SDL_Surface *target = screen;
+  
+  /* the 3D view is drawn one byte per pixel, then converted */
+  if (indexed && !mapflag)
+  {
+	if (indexed_frame == NULL || indexed_frame->w != screen->w || indexed_frame->h != screen->h)
+	{
+	  SDL_FreeSurface(indexed_frame);
+	  indexed_frame = SDL_CreateRGBSurface(SDL_SWSURFACE, screen->w, screen->h, 8, 0, 0, 0, 0);
+	}
+	target = indexed_frame;
+  }
+  
+  /* clear the screen (index 0 is black) */
+  SDL_FillRect(target, NULL, (target == indexed_frame) ? 0 : SDL_MapRGB(target->format, 0, 0, 0));
   
   /* TODO: add your code here */
   if (mapflag)
   {
-    RCA_DrawSector(screen, sector_1);
-	RCA_DrawSector(screen, sector_2);
-	RCA_DrawSector(screen, sector_3);
-	RCA_DrawSector(screen, sector_4);
-	RCA_DrawSector(screen, sector_5);
-	RCA_DrawSector(screen, sector_6);
-	RCA_DrawSector(screen, sector_7);
-	RCA_DrawSector(screen, sector_8);
-	RCA_DrawSector(screen, sector_9);
-	RCA_DrawSector(screen, sector_10);
-	RCA_DrawSector(screen, sector_11);
-    RCA_DrawElement(screen, player);
+    /* static walls come from the cache, only the player is drawn */
+    RCA_DrawMinimap(target, minimap);
+    RCA_DrawMinimapElement(target, minimap, player);
   }
   else 
   {
-	RCA_TraverseBSPtree(screen, bsptree, player);
+	RCA_BinLights(lights);
+	RCA_ClearDepthBuffer();
+	if (ray_walk)
+	  RCA_TraceBSParray(target, bsparray, player);
+	else if (adaptive)
+	  RCA_AdaptiveCasting(target, player, leaves, leaf_count);
+	else if (single_pass)
+	  RCA_SinglePassCasting(target, player, leaves, leaf_count);
+	else
+	  RCA_TraverseBSParray(target, bsparray, player);
+	RCA_DrawMovingWalls(target, movers, player);
+	RCA_DrawSprites(target, sprites, player);
+  }
+  
+  if (target != screen)
+	RCA_PresentIndexedFrame(target, screen);
+}
+
+/**
+ * Drawing a frame.
+ * 
+ * With a frame ring, the frame is drawn straight into a slot of the ring
+ * (then shown in the window, if any).
+ */
+void RCA_DrawFrame()
+{
+  SDL_Surface *window = screen;
+  
+  if (ring == NULL)
+  {
+	RCA_Draw();
+	return;
+  }
+  
+  screen = RCA_BeginFrame(ring);
+  RCA_Draw();
+  RCA_EndFrame(ring, player->x, player->y, RCA_BAMToDegrees(player->direction), RCA_GetTime());
+  
+  if (!headless)
+	SDL_BlitSurface(screen, NULL, window, NULL);
+  screen = window;
+}
+
+/**
+ * Replaying a recorded session.
+ * 
+ * Runs as fast as possible without a window and reports the time taken
+ * by every frame, and what the performance counters counted in every
+ * stage of it when they are on (see RCA_PrintPerfFrame).
+ * 
+ * @param timing Where to write the time of every frame (or NULL).
+ */
+void RCA_Replay(FILE *timing)
+{
+  InputTick tick;
+  int count = 0, capacity = 1024;
+  double *times = malloc(capacity * sizeof(double));
+  double start, update;
+  
+  while (1)
+  {
+	start = RCA_GetTime();
+	if (!RCA_ReplayTick(recorder, &tick))
+	  break;
+	RCA_ApplyInput(&tick);
+	update = RCA_GetTime();
+	
+	if (perf != NULL)
+	  RCA_BeginPerfFrame(perf);
+	RCA_DrawFrame();
+	if (perf != NULL)
+	  RCA_EndPerfFrame(perf);
+	
+	if (count == capacity)
+	{
+	  capacity *= 2;
+	  times = realloc(times, capacity * sizeof(double));
+	}
+	times[count] = RCA_GetTime() - start;
+	
+	if (timing != NULL)
+	{
+	  fprintf(timing, "%d %.6f %.6f %.1f %.1f %.1f", count, (update - start) * 1e3, times[count] * 1e3,
+			  player->x, player->y, RCA_BAMToDegrees(player->direction));
+	  if (perf != NULL)
+		RCA_PrintPerfFrame(timing, perf);
+	  fprintf(timing, "\n");
+	}
+	count++;
+  }
+  
+  RCA_PrintTimingSummary(stdout, "replay", times, count);
+  if (perf != NULL)
+	RCA_PrintPerfSummary(stdout, perf);
+  free(times);
+}
+
+/**
+ * Frame of a batch (a surface to render into and where it goes).
+ */
+typedef struct {
+  SDL_Surface *surface;
+  int index;					/* pose rendered */
+} Frame;
+
+double (*poses)[3] = NULL;		/* x, y and direction */
+int pose_count = 0;
+Queue *free_frames;
+Queue *rendered_frames;
+
+/**
+ * Rendering poses of a batch (one thread).
+ * 
+ * Every worker has its own element and surface, the depth buffer and
+ * the scratch of the raycaster are per thread, the level is only read.
+ * 
+ * @param data Index of the worker.
+ * @return     0
+ */
+int RCA_RenderBatch(void *data)
+{
+  int i;
+  Frame *frame;
+  Element *element = RCA_NewElement(0, 0, 0);
+  
+  for (i = *(int *)data; i < pose_count; i += batch_threads)
+  {
+	frame = RCA_PopFromQueue(free_frames);
+	
+	element->x = poses[i][0];
+	element->y = poses[i][1];
+	element->direction = RCA_DegreesToBAM(poses[i][2]);
+	
+	SDL_FillRect(frame->surface, NULL, SDL_MapRGB(frame->surface->format, 0, 0, 0));
+	RCA_ClearDepthBuffer();
+	RCA_TraverseBSParray(frame->surface, bsparray, element);
+	
+	frame->index = i;
+	RCA_PushToQueue(rendered_frames, frame);
+  }
+  
+  RCA_DestroyElement(element);
+  return 0;
+}
+
+/**
+ * Writing frames of a batch (one thread).
+ * 
+ * @param data Directory the frames are written to.
+ * @return     Number of frames that could not be written.
+ */
+int RCA_WriteBatch(void *data)
+{
+  const char *output = data;
+  int failed = 0;
+  char name[1024];
+  Frame *frame;
+  
+  while ((frame = RCA_PopFromQueue(rendered_frames)) != NULL)
+  {
+	snprintf(name, sizeof(name), "%s/frame_%06d.bmp", output, frame->index);
+	if (SDL_SaveBMP(frame->surface, name) != 0)
+	  failed++;
+	
+	RCA_PushToQueue(free_frames, frame);
   }
+  
+  return failed;
+}
+
+/**
+ * Rendering a batch of poses.
+ * 
+ * The poses are spread over the workers, the frames go to the writers
+ * through a queue and come back once written (the number of frames in
+ * flight is fixed).  Only the walls are drawn, the movers and sprites
+ * keep their scratch in their lists.
+ * 
+ * @param file File of poses (one "x y direction" per line, # for comments).
+ * @return     0 or 1 (something went wrong).
+ */
+int RCA_Batch(const char *file)
+{
+  int i, failed = 0, status;
+  int capacity = 1024;
+  int writer_count = (batch_threads + 3) / 4;
+  int frame_count = 2 * batch_threads;
+  char line[256];
+  double start, elapsed;
+  FILE *stream = fopen(file, "r");
+  
+  if (stream == NULL)
+  {
+	fprintf(stderr, "can't read poses %s\n", file);
+	return 1;
+  }
+  
+  poses = malloc(capacity * sizeof(double[3]));
+  while (fgets(line, sizeof(line), stream) != NULL)
+  {
+	if (line[0] == '#')
+	  continue;
+	
+	if (pose_count == capacity)
+	{
+	  capacity *= 2;
+	  poses = realloc(poses, capacity * sizeof(double[3]));
+	}
+	if (sscanf(line, "%lf %lf %lf", &poses[pose_count][0], &poses[pose_count][1], &poses[pose_count][2]) == 3)
+	  pose_count++;
+  }
+  fclose(stream);
+  
+  /* the walls are only read from now on */
+  for (i = 0; i < leaf_count; i++)
+  {
+	Sector *wall;
+	for (wall = leaves[i]->first->next; wall != NULL; wall = wall->next)
+	{
+	  RCA_UpdateWallConstants(wall);
+	}
+  }
+  
+  int index[batch_threads];
+  Frame frames[frame_count];
+  SDL_Thread *workers[batch_threads];
+  SDL_Thread *writers[writer_count];
+  
+  free_frames = RCA_NewQueue(frame_count);
+  rendered_frames = RCA_NewQueue(frame_count);
+  for (i = 0; i < frame_count; i++)
+  {
+	frames[i].surface = SDL_CreateRGBSurface(SDL_SWSURFACE, WINDOW_WIDTH, WINDOW_HEIGHT, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+	RCA_PushToQueue(free_frames, &frames[i]);
+  }
+  
+  start = RCA_GetTime();
+  
+  for (i = 0; i < writer_count; i++)
+  {
+	writers[i] = SDL_CreateThread(RCA_WriteBatch, (void *)batch_output);
+  }
+  for (i = 0; i < batch_threads; i++)
+  {
+	index[i] = i;
+	workers[i] = SDL_CreateThread(RCA_RenderBatch, &index[i]);
+  }
+  
+  for (i = 0; i < batch_threads; i++)
+  {
+	SDL_WaitThread(workers[i], NULL);
+  }
+  RCA_CloseQueue(rendered_frames);
+  for (i = 0; i < writer_count; i++)
+  {
+	SDL_WaitThread(writers[i], &status);
+	failed += status;
+  }
+  
+  elapsed = RCA_GetTime() - start;
+  printf("batch: %d frames in %.3f s (%.1f frames/s, %d threads, %d writers)\n", pose_count, elapsed,
+		 (elapsed > 0) ? pose_count / elapsed : 0, batch_threads, writer_count);
+  if (failed)
+	fprintf(stderr, "can't write %d frames to %s\n", failed, batch_output);
+  
+  for (i = 0; i < frame_count; i++)
+  {
+	SDL_FreeSurface(frames[i].surface);
+  }
+  RCA_DestroyQueue(free_frames);
+  RCA_DestroyQueue(rendered_frames);
+  free(poses);
+  
+  return failed != 0;
 }
 
 /**
  * Main function of the application.
  * 
+ * Usage: raycasting [--record file] [--replay file [--timing file] [--perf]] [--single-pass | --ray-walk | --adaptive] [--indexed]
+ *                   [--batch file [--threads n] [--output directory]] [--shm name [--shm-block]] [--map file [--watch]]
+ * 
  * @param argc Arguments passed on the command line (number).
  * @param argv Arguments passed on the command line (values).
- * @return     0 (meaning we're done)
+ * @return     0 (meaning we're done) or 1 (a batch went wrong)
  */
 int main(int argc, char **argv)
 {
+  int i, status = 0;
+  FILE *timing = NULL;
+  
+  for (i = 1; i < argc; i++)
+  {
+	if (strcmp(argv[i], "--single-pass") == 0)
+	{
+	  single_pass = 1;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--ray-walk") == 0)
+	{
+	  ray_walk = 1;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--adaptive") == 0)
+	{
+	  adaptive = 1;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--indexed") == 0)
+	{
+	  indexed = 1;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--shm-block") == 0)
+	{
+	  ring_policy = RCA_FRAMERING_BLOCK;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--watch") == 0)
+	{
+	  watch = 1;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--perf") == 0)
+	{
+	  perf = RCA_NewPerfCounters();
+	  if (perf == NULL)
+	  {
+		fprintf(stderr, "can't open performance counters\n");
+		return 1;
+	  }
+	  continue;
+	}
+	
+	/* the other options take a value */
+	if (i == argc - 1)
+	  break;
+	
+	if (strcmp(argv[i], "--timing") == 0)
+	{
+	  timing = fopen(argv[++i], "w");
+	  if (timing == NULL)
+	  {
+		fprintf(stderr, "can't write timing %s\n", argv[i]);
+		return 1;
+	  }
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--batch") == 0)
+	{
+	  batch = argv[++i];
+	  headless = 1;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--threads") == 0)
+	{
+	  batch_threads = atoi(argv[++i]);
+	  batch_threads = (batch_threads < 1) ? 1 : batch_threads;
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--output") == 0)
+	{
+	  batch_output = argv[++i];
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--shm") == 0)
+	{
+	  ring_name = argv[++i];
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--map") == 0)
+	{
+	  map_path = argv[++i];
+	  continue;
+	}
+	
+	if (strcmp(argv[i], "--record") == 0)
+	{
+	  recorder = RCA_NewRecorder(argv[++i], RCA_RECORDER_RECORD);
+	}
+	else if (strcmp(argv[i], "--replay") == 0)
+	{
+	  recorder = RCA_NewRecorder(argv[++i], RCA_RECORDER_REPLAY);
+	  headless = 1;
+	}
+	else
+	{
+	  continue;
+	}
+	
+	if (recorder == NULL)
+	{
+	  fprintf(stderr, "can't use recording %s\n", argv[i]);
+	  return 1;
+	}
+  }
+
   RCA_Init();
-  RCA_Load();
+  if (map_path == NULL)
+  {
+#ifdef RCA_EMBEDDED_LEVEL
+	RCA_LoadEmbedded();
+#else
+	RCA_Load();
+#endif
+  }
+  else if (!RCA_LoadFromMap(map_path))
+  {
+	fprintf(stderr, "can't load map %s\n", map_path);
+	return 1;
+  }
+  
+  if (watch && map_path != NULL)
+  {
+	map_watch = RCA_NewMapWatch(map_path);
+	if (map_watch == NULL)
+	{
+	  fprintf(stderr, "can't watch map %s\n", map_path);
+	  return 1;
+	}
+  }
+  
+  if (ring_name != NULL)
+  {
+	ring = RCA_NewFrameRing(ring_name, 8, WINDOW_WIDTH, WINDOW_HEIGHT, ring_policy);
+	if (ring == NULL)
+	{
+	  fprintf(stderr, "can't create frame ring %s\n", ring_name);
+	  return 1;
+	}
+  }
 	
-  int running_loop = 1;
-  while(running_loop)
+  if (batch != NULL)
+  {
+	status = RCA_Batch(batch);
+  }
+  else if (headless)
   {
-    RCA_Update(&running_loop);
+	RCA_Replay(timing);
+  }
+  else
+  {
+	int running_loop = 1;
+	int count = 0, capacity = 1024;
+	double *latencies = malloc(capacity * sizeof(double));
+	InputTick tick;
+	
+	while(running_loop)
+	{
+	  if (map_watch != NULL && RCA_PollMapWatch(map_watch))
+		RCA_HotReload();
+	  
+	  RCA_Update(&running_loop, &tick);
 	   
-	RCA_Draw();
+	  RCA_DrawFrame();
 	 
-	SDL_Delay(1);
+	  SDL_Delay(1);
 
-	SDL_Flip(screen);
+	  SDL_Flip(screen);
+	  
+	  /* from the first event of the tick to the frame shown */
+	  if (tick.time != 0)
+	  {
+		if (count == capacity)
+		{
+		  capacity *= 2;
+		  latencies = realloc(latencies, capacity * sizeof(double));
+		}
+		latencies[count++] = RCA_GetInputLatency(&tick);
+	  }
+	}
+	
+	RCA_PrintTimingSummary(stdout, "input latency", latencies, count);
+	free(latencies);
   }
 
   /* Destroy our objects */
-  mof_Font__destroy(text);
+  if (text != NULL)
+	mof_Font__destroy(text);
+  if (recorder != NULL)
+	RCA_DestroyRecorder(recorder);
+  if (timing != NULL)
+	fclose(timing);
+  if (ring != NULL)
+	RCA_DestroyFrameRing(ring);
+  if (map_watch != NULL)
+	RCA_DestroyMapWatch(map_watch);
+  if (perf != NULL)
+	RCA_DestroyPerfCounters(perf);
+  if (indexed_frame != NULL)
+	SDL_FreeSurface(indexed_frame);
   
-  RCA_DestroyBSPtree(bsptree);
+  RCA_Unload();
+  RCA_DestroyArena(level);
+  RCA_DestroyMinimap(minimap);
+  RCA_DestroyMoverList(movers);
+  RCA_DestroySpriteList(sprites);
+  RCA_DestroyLightList(lights);
   RCA_DestroyElement(player);
-  RCA_DestroySector(sector_1);
-  RCA_DestroySector(sector_2);
-  RCA_DestroySector(sector_3);
-  RCA_DestroySector(sector_4);
-  RCA_DestroySector(sector_5);
-  RCA_DestroySector(sector_6);
-  RCA_DestroySector(sector_7);
-  RCA_DestroySector(sector_8);
-  RCA_DestroySector(sector_9);
-  RCA_DestroySector(sector_10);
-  RCA_DestroySector(sector_11);
 
   SDL_Quit();
 
-  return 0;
-}
\ No newline at end of file
+  return status;
+}